@@ -124,6 +124,18 @@ def nullCheckedFields(spec, m):
             fieldsToNullCheck.add(jfName)
     return fieldsToNullCheck
 
+# Methods making up most of the traffic: they are decoded and encoded by
+# specialized code, instead of MethodArgumentReader and MethodArgumentWriter
+fastPathMethods = [('basic', 'deliver'), ('basic', 'publish'), ('basic', 'ack'), ('basic', 'nack')]
+# Classes whose properties are decoded by specialized code, instead of ContentHeaderPropertyReader
+fastPathProperties = ['basic']
+
+# Size of the fixed-size argument types, bits aside
+fixedArgumentSizes = {'octet': 1, 'short': 2, 'long': 4, 'longlong': 8, 'timestamp': 8}
+
+def isFastPathMethod(c, m):
+    return (c.name, m.name) in fastPathMethods
+
 #---------------------------------------------------------------------------
 
 def printFileHeader():
@@ -162,6 +174,7 @@ def genJavaApi(spec):
         print("import com.rabbitmq.client.impl.ContentHeaderPropertyWriter;")
         print("import com.rabbitmq.client.impl.ContentHeaderPropertyReader;")
         print("import com.rabbitmq.client.impl.LongStringHelper;")
+        print("import com.rabbitmq.client.impl.ValueReader;")
 
     def printProtocolClass():
         print()
@@ -247,6 +260,17 @@ def genJavaApi(spec):
                 (jfName, jfClass) = (java_field_name(f.name), java_class_name(f.domain))
                 print("            this.%s = %s_present ? reader.read%s() : null;" % (jfName, jfName, jfClass))
 
+    def printFastPathReadProperties(c):
+        # all the presence bits fit in a single flag word
+        print("            int flags = in.readShort();")
+        print("            if ((flags & 1) != 0)")
+        print("                throw new IOException(\"Unexpected continuation flag word\");")
+        print()
+        for (i, f) in enumerate(c.fields):
+            domain = spec.resolveDomain(f.domain)
+            readMethod = 'LazyTable' if domain == 'table' else java_class_name(domain)
+            print("            this.%s = (flags & 0x%04x) != 0 ? in.read%s() : null;" % (java_field_name(f.name), 0x8000 >> i, readMethod))
+
     def printWritePropertiesTo(c):
         print()
         print("        public void writePropertiesTo(ContentHeaderPropertyWriter writer)")
@@ -354,10 +378,18 @@ def genJavaApi(spec):
         #datainputstream constructor
         print()
         print("        public %sProperties(DataInputStream in) throws IOException {" % (jClassName))
-        print("            super(in);")
-        print("            ContentHeaderPropertyReader reader = new ContentHeaderPropertyReader(in);")
+        print("            this(new ValueReader(in));")
+        print("        }")
 
-        printReadProperties(c)
+        #valuereader constructor
+        print()
+        print("        public %sProperties(ValueReader in) throws IOException {" % (jClassName))
+        print("            super(in);")
+        if c.name in fastPathProperties and len(c.fields) < 16:
+            printFastPathReadProperties(c)
+        else:
+            print("            ContentHeaderPropertyReader reader = new ContentHeaderPropertyReader(in);")
+            printReadProperties(c)
 
         print("        }")
 
@@ -453,6 +485,7 @@ def genJavaImpl(spec):
         print()
         print("import java.io.IOException;")
         print("import java.io.DataInputStream;")
+        print("import java.nio.ByteBuffer;")
         print("import java.util.Collections;")
         print("import java.util.HashMap;")
         print("import java.util.Map;")
@@ -500,6 +533,83 @@ def genJavaImpl(spec):
                 print("                this(%s);" % (", ".join(consArgs)))
                 print("            }")
 
+            def fast_path_constructor():
+                print()
+                print("            public %s(ValueReader in) throws IOException {" % (java_class_name(m.name)))
+                if [a for a in m.arguments if spec.resolveDomain(a.domain) == 'bit']:
+                    print("                int bits = 0;")
+                bitMask = 0x100
+                for a in m.arguments:
+                    domain = spec.resolveDomain(a.domain)
+                    jfName = java_field_name(a.name)
+                    if domain == 'bit':
+                        if bitMask > 0x80:
+                            print("                bits = in.readOctet();")
+                            bitMask = 0x01
+                        print("                this.%s = (bits & 0x%02x) != 0;" % (jfName, bitMask))
+                        bitMask = bitMask << 1
+                    elif domain == 'table':
+                        raise Exception("No fast path for table argument %s of %s.%s" % (a.name, c.name, m.name))
+                    else:
+                        print("                this.%s = in.read%s();" % (jfName, java_class_name(domain)))
+                        bitMask = 0x100
+                print("            }")
+
+            def fast_path_to_frame():
+                print()
+                print("            @Override")
+                print("            public Frame toFrame(int channelNumber) throws IOException {")
+                size = 4
+                variableSizes = []
+                bitMask = 0x100
+                for a in m.arguments:
+                    domain = spec.resolveDomain(a.domain)
+                    jfName = java_field_name(a.name)
+                    if domain == 'bit':
+                        if bitMask > 0x80:
+                            size += 1
+                            bitMask = 0x01
+                        bitMask = bitMask << 1
+                    else:
+                        bitMask = 0x100
+                        if domain == 'shortstr':
+                            print("                byte[] %sBytes = MethodCodec.shortstr(this.%s);" % (jfName, jfName))
+                            size += 1
+                            variableSizes.append("%sBytes.length" % (jfName))
+                        elif domain in fixedArgumentSizes:
+                            size += fixedArgumentSizes[domain]
+                        else:
+                            raise Exception("No fast path for %s argument %s of %s.%s" % (domain, a.name, c.name, m.name))
+                print("                byte[] payload = new byte[%s];" % (" + ".join([str(size)] + variableSizes)))
+                print("                int offset = MethodCodec.putShort(payload, 0, %s);" % (c.index))
+                print("                offset = MethodCodec.putShort(payload, offset, %s);" % (m.index))
+                bitMask = 0x100
+                for a in m.arguments:
+                    domain = spec.resolveDomain(a.domain)
+                    jfName = java_field_name(a.name)
+                    if domain == 'bit':
+                        if bitMask == 0x100:
+                            bitMask = 0x01
+                        elif bitMask > 0x80:
+                            print("                offset++;")
+                            bitMask = 0x01
+                        print("                if (this.%s) payload[offset] |= 0x%02x;" % (jfName, bitMask))
+                        bitMask = bitMask << 1
+                        continue
+                    if bitMask != 0x100:
+                        print("                offset++;")
+                        bitMask = 0x100
+                    if domain == 'shortstr':
+                        print("                offset = MethodCodec.putShortstr(payload, offset, %sBytes);" % (jfName))
+                    elif domain == 'octet':
+                        print("                payload[offset++] = (byte) this.%s;" % (jfName))
+                    elif domain == 'timestamp':
+                        print("                offset = MethodCodec.putLonglong(payload, offset, this.%s.getTime() / 1000);" % (jfName))
+                    else:
+                        print("                offset = MethodCodec.put%s(payload, offset, this.%s);" % (java_class_name(domain), jfName))
+                print("                return new Frame(AMQP.FRAME_METHOD, channelNumber, payload);")
+                print("            }")
+
             def others():
                 print()
                 print("            public int protocolClassId() { return %s; }" % (c.index))
@@ -548,12 +658,16 @@ def genJavaImpl(spec):
 
             getters()
             constructors()
+            if isFastPathMethod(c, m):
+                fast_path_constructor()
             others()
             if m.arguments:
                 equalsHashCode(spec, m.arguments, java_class_name(m.name), '', True)
 
             argument_debug_string()
             write_arguments()
+            if isFastPathMethod(c, m):
+                fast_path_to_frame()
 
             print("        }")
         print("    }")
@@ -579,6 +693,20 @@ def genJavaImpl(spec):
         print("    public static Method readMethodFrom(DataInputStream in) throws IOException {")
         print("        int classId = in.readShort();")
         print("        int methodId = in.readShort();")
+        print("        return readMethodFrom(classId, methodId, new ValueReader(in));")
+        print("    }")
+        print()
+        print("    public static Method readMethodFrom(ByteBuffer in) throws IOException {")
+        print("        return readMethodFrom(new BufferValueReader(in));")
+        print("    }")
+        print()
+        print("    public static Method readMethodFrom(ValueReader in) throws IOException {")
+        print("        int classId = in.readShort();")
+        print("        int methodId = in.readShort();")
+        print("        return readMethodFrom(classId, methodId, in);")
+        print("    }")
+        print()
+        print("    private static Method readMethodFrom(int classId, int methodId, ValueReader in) throws IOException {")
         print("        switch (classId) {")
         for c in spec.allClasses():
             print("            case %s:" % (c.index))
@@ -586,7 +714,10 @@ def genJavaImpl(spec):
             for m in c.allMethods():
                 fq_name = java_class_name(c.name) + '.' + java_class_name(m.name)
                 print("                    case %s: {" % (m.index))
-                print("                        return new %s(new MethodArgumentReader(new ValueReader(in)));" % (fq_name))
+                if isFastPathMethod(c, m):
+                    print("                        return new %s(in);" % (fq_name))
+                else:
+                    print("                        return new %s(new MethodArgumentReader(in));" % (fq_name))
                 print("                    }")
             print("                    default: break;")
             print("                } break;")
@@ -599,6 +730,19 @@ def genJavaImpl(spec):
         print()
         print("    public static AMQContentHeader readContentHeaderFrom(DataInputStream in) throws IOException {")
         print("        int classId = in.readShort();")
+        print("        return readContentHeaderFrom(classId, new ValueReader(in));")
+        print("    }")
+        print()
+        print("    public static AMQContentHeader readContentHeaderFrom(ByteBuffer in) throws IOException {")
+        print("        return readContentHeaderFrom(new BufferValueReader(in));")
+        print("    }")
+        print()
+        print("    public static AMQContentHeader readContentHeaderFrom(ValueReader in) throws IOException {")
+        print("        int classId = in.readShort();")
+        print("        return readContentHeaderFrom(classId, in);")
+        print("    }")
+        print()
+        print("    private static AMQContentHeader readContentHeaderFrom(int classId, ValueReader in) throws IOException {")
         print("        switch (classId) {")
         for c in spec.allClasses():
             if c.fields:
@@ -0,0 +1,79 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client;
+
+import java.io.IOException;
+
+/**
+ * Codec applied to message bodies, e.g. to compress them.
+ * <p>
+ * When a codec is set on the {@link ConnectionFactory}, bodies published with
+ * <code>basicPublish</code> are encoded if they are big enough and the message
+ * has no <code>content-encoding</code> yet, and the <code>content-encoding</code>
+ * property is set to {@link #getContentEncoding()}. Delivered messages with this
+ * <code>content-encoding</code> are decoded before they reach the consumer.
+ * <p>
+ * Implementations must be thread-safe.
+ *
+ * @see ConnectionFactory#setBodyCodec(BodyCodec)
+ * @see DeflateBodyCodec
+ * @since 6.0.0
+ */
+public interface BodyCodec {
+
+    /**
+     * The value of the <code>content-encoding</code> property of encoded messages.
+     * @return the content encoding, e.g. <code>deflate</code>
+     */
+    String getContentEncoding();
+
+    /**
+     * Encode a message body.
+     * @param body the body to encode
+     * @return the encoded body
+     * @throws IOException if the body cannot be encoded
+     */
+    byte[] encode(byte[] body) throws IOException;
+
+    /**
+     * Decode a message body.
+     * @param body the encoded body
+     * @return the decoded body
+     * @throws IOException if the body cannot be decoded
+     */
+    byte[] decode(byte[] body) throws IOException;
+
+    /**
+     * Decode a message body, failing if it is too big once decoded.
+     * Codecs that expand bodies, e.g. by decompressing them, should check
+     * the size as they decode, so a small body cannot exhaust the memory.
+     * The default implementation checks the size of the decoded body.
+     * @param body the encoded body
+     * @param maxDecodedSize the maximum size of the decoded body, in bytes
+     * @return the decoded body
+     * @throws IOException if the body cannot be decoded or is too big once decoded
+     * @see ConnectionFactory#setBodyCodecMaxDecodedSize(int)
+     */
+    default byte[] decode(byte[] body, int maxDecodedSize) throws IOException {
+        byte[] decoded = decode(body);
+        if (decoded.length > maxDecodedSize) {
+            throw new IOException("Decoded body is bigger than " + maxDecodedSize + " bytes");
+        }
+        return decoded;
+    }
+
+}
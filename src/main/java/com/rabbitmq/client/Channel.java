@@ -16,6 +16,8 @@
 package com.rabbitmq.client;
 
 import java.io.IOException;
+import java.io.InputStream;
+import java.nio.channels.FileChannel;
 import java.util.Map;
 import java.util.concurrent.CompletableFuture;
 import java.util.concurrent.TimeoutException;
@@ -236,6 +238,44 @@ public interface Channel extends ShutdownNotifier, AutoCloseable {
      */
     void basicQos(int prefetchCount) throws IOException;
 
+    /**
+     * Let the client set the channel prefetch count, within the given bounds.
+     *
+     * The client measures how long consumers of this channel take to process
+     * and acknowledge deliveries, and periodically applies (with a global
+     * <code>basic.qos</code>) the prefetch count that keeps enough messages
+     * in flight to cover the network round trip without letting a slow
+     * consumer hoard messages. This only has an effect for consumers
+     * that acknowledge messages manually.
+     * A later call to any of the <code>basicQos</code> methods turns the
+     * automatic adjustment off, the prefetch count it sets then stays.
+     *
+     * @see #basicQos(int, int, boolean)
+     * @param minPrefetchCount minimum prefetch count, also the initial one, must be strictly positive
+     * @param maxPrefetchCount maximum prefetch count, at least <code>minPrefetchCount</code> and at most 65535
+     * @throws java.io.IOException if an error is encountered
+     * @throws IllegalArgumentException if the bounds are not a valid prefetch count range
+     * @since 6.0.0
+     */
+    void setAutomaticPrefetch(int minPrefetchCount, int maxPrefetchCount) throws IOException;
+
+    /**
+     * Set the share of the connection's consumer dispatch threads
+     * this channel gets when consumers of several channels have work pending.
+     *
+     * A channel with weight <i>n</i> gets its deliveries and other consumer
+     * callbacks dispatched <i>n</i> times as often as a channel with weight 1,
+     * so critical consumers keep a low latency when the dispatch threads are saturated.
+     * Deliveries for a given channel are still dispatched in order.
+     * The default weight is 1. A weight of 0 or less is rejected,
+     * the weight of the channel is then left unchanged.
+     *
+     * @param weight strictly positive weight
+     * @throws IllegalArgumentException if the weight is 0 or negative
+     * @since 6.0.0
+     */
+    void setConsumerDispatchWeight(int weight);
+
     /**
      * Publish a message.
      *
@@ -296,6 +336,142 @@ public interface Channel extends ShutdownNotifier, AutoCloseable {
     void basicPublish(String exchange, String routingKey, boolean mandatory, boolean immediate, BasicProperties props, byte[] body)
             throws IOException;
 
+    /**
+     * Publish a message whose body is read from a stream while it is sent,
+     * one frame at a time, instead of being held in memory.
+     * <p>
+     * Exactly <code>bodySize</code> bytes are read from the stream, which is not closed.
+     * The channel cannot send anything else until the whole body is sent.
+     * The broker expects the whole body once the first frames are sent: if the stream
+     * fails or ends before <code>bodySize</code> bytes after that, the connection is closed.
+     *
+     * @see #basicPublish(String, String, boolean, BasicProperties, byte[])
+     * @param exchange the exchange to publish the message to
+     * @param routingKey the routing key
+     * @param mandatory true if the 'mandatory' flag is to be set
+     * @param props other properties for the message - routing headers etc
+     * @param body the stream to read the message body from
+     * @param bodySize the size of the message body
+     * @throws java.io.IOException if an error is encountered, including reading the body
+     * @since 6.0.0
+     */
+    void basicPublish(String exchange, String routingKey, boolean mandatory, BasicProperties props, InputStream body, long bodySize)
+            throws IOException;
+
+    /**
+     * Publish a message whose body is a region of a file, read while it is sent,
+     * one frame at a time, instead of being held in memory.
+     * <p>
+     * The position of the file channel is not changed.
+     * The channel cannot send anything else until the whole body is sent.
+     * The broker expects the whole body once the first frames are sent: if the file
+     * cannot be read or is shorter than expected after that, the connection is closed.
+     *
+     * @see #basicPublish(String, String, boolean, BasicProperties, byte[])
+     * @param exchange the exchange to publish the message to
+     * @param routingKey the routing key
+     * @param mandatory true if the 'mandatory' flag is to be set
+     * @param props other properties for the message - routing headers etc
+     * @param body the file to read the message body from
+     * @param position the position of the message body in the file
+     * @param bodySize the size of the message body
+     * @throws java.io.IOException if an error is encountered, including reading the body
+     * @since 6.0.0
+     */
+    void basicPublish(String exchange, String routingKey, boolean mandatory, BasicProperties props, FileChannel body, long position, long bodySize)
+            throws IOException;
+
+    /**
+     * Publish a message encoded with a {@link MessageCodec}.
+     * <p>
+     * The message is encoded straight into the payload of the body frames.
+     * The <code>content-type</code> of the message is set to the one of
+     * the codec, unless it is already set.
+     *
+     * @see #basicPublish(String, String, boolean, BasicProperties, byte[])
+     * @param exchange the exchange to publish the message to
+     * @param routingKey the routing key
+     * @param mandatory true if the 'mandatory' flag is to be set
+     * @param props other properties for the message - routing headers etc
+     * @param codec the codec to encode the message with
+     * @param message the message to encode
+     * @param <T> the type of the message
+     * @throws java.io.IOException if an error is encountered, including encoding the message
+     * @since 6.0.0
+     */
+    <T> void basicPublish(String exchange, String routingKey, boolean mandatory, BasicProperties props, MessageCodec<T> codec, T message)
+            throws IOException;
+
+    /**
+     * Publish a message and get notified when the broker confirms it.
+     * The channel must be in confirm mode.
+     *
+     * @see #basicPublishAsync(String, String, boolean, BasicProperties, byte[])
+     * @param exchange the exchange to publish the message to
+     * @param routingKey the routing key
+     * @param props other properties for the message - routing headers etc
+     * @param body the message body
+     * @return a future completed when the message is confirmed
+     * @throws java.io.IOException if an error is encountered
+     * @throws IllegalStateException if the channel is not in confirm mode
+     * @since 6.0.0
+     */
+    CompletableFuture<Void> basicPublishAsync(String exchange, String routingKey, BasicProperties props, byte[] body)
+            throws IOException;
+
+    /**
+     * Publish a message and get notified when the broker confirms it.
+     * The channel must be in confirm mode.
+     * <p>
+     * The returned future completes normally when the broker acks the message.
+     * It completes exceptionally with a {@link PublishRejectedException} when the
+     * broker nacks the message or returns it (<code>mandatory</code> set and the message
+     * cannot be routed), and with a {@link ShutdownSignalException} when the channel
+     * closes before the message is confirmed.
+     * Confirms are correlated with the messages inside the channel, from the
+     * same bookkeeping as {@link #waitForConfirms()}, so a <code>multiple</code>
+     * ack completes all the corresponding futures at once.
+     * <p>
+     * Returns are correlated with the messages inside the channel as well,
+     * nothing is added to the message: the broker sends the return of a message
+     * before confirming it, so the future failed by a return is the one of the message
+     * the following ack is for (see {@link #setReturnCorrelation(boolean)}).
+     * <p>
+     * Futures are completed on the connection thread: dependent actions must not block,
+     * or should use the <code>*Async</code> methods of {@link CompletableFuture}.
+     *
+     * @see com.rabbitmq.client.AMQP.Basic.Publish
+     * @see #confirmSelect()
+     * @param exchange the exchange to publish the message to
+     * @param routingKey the routing key
+     * @param mandatory true if the 'mandatory' flag is to be set
+     * @param props other properties for the message - routing headers etc
+     * @param body the message body
+     * @return a future completed when the message is confirmed
+     * @throws java.io.IOException if an error is encountered
+     * @throws IllegalStateException if the channel is not in confirm mode
+     * @since 6.0.0
+     */
+    CompletableFuture<Void> basicPublishAsync(String exchange, String routingKey, boolean mandatory, BasicProperties props, byte[] body)
+            throws IOException;
+
+    /**
+     * Prepare publishing messages to a fixed exchange with a fixed routing key.
+     * The <code>basic.publish</code> method frame is encoded once by this call,
+     * instead of once per message.
+     * <p>
+     * Handles created on a recoverable channel keep working after recovery.
+     *
+     * @see PreparedPublish
+     * @param exchange the exchange to publish the messages to
+     * @param routingKey the routing key
+     * @param mandatory true if the 'mandatory' flag is to be set
+     * @return the handle to publish messages with
+     * @throws java.io.IOException if an error is encountered
+     * @since 6.0.0
+     */
+    PreparedPublish preparePublish(String exchange, String routingKey, boolean mandatory) throws IOException;
+
     /**
      * Actively declare a non-autodelete, non-durable exchange with no extra arguments
      * @see com.rabbitmq.client.AMQP.Exchange.Declare
@@ -742,6 +918,32 @@ public interface Channel extends ShutdownNotifier, AutoCloseable {
      */
     GetResponse basicGet(String queue, boolean autoAck) throws IOException;
 
+    /**
+     * Coalesce positive acknowledgements.
+     *
+     * Acknowledgements sent with {@link #basicAck(long, boolean)} are accumulated
+     * and sent as a single <code>basic.ack</code> with <code>multiple</code> set
+     * once <code>maxBatchSize</code> consecutive delivery tags are acknowledged,
+     * or once the oldest accumulated acknowledgement has waited for <code>maxDelayInMs</code>.
+     * A multiple acknowledgement never covers a message that has not been
+     * acknowledged by the application, so messages can be acknowledged in any order.
+     * Accumulated acknowledgements are sent before any negative acknowledgement,
+     * recover or close on this channel.
+     * If a message stays unacknowledged while tens of thousands of later
+     * messages are received, coalescing stops on this channel and
+     * acknowledgements are sent right away.
+     *
+     * This must be called before any consumer is registered on the channel
+     * and before any message is received on it.
+     *
+     * @param maxBatchSize maximum number of accumulated consecutive acknowledgements, 1 or less to disable coalescing
+     * @param maxDelayInMs maximum time to accumulate acknowledgements, in milliseconds
+     * @throws java.io.IOException if an error is encountered while sending accumulated acknowledgements
+     * @throws IllegalStateException if consumers are registered on the channel or messages were received on it
+     * @since 6.0.0
+     */
+    void setAckCoalescing(int maxBatchSize, long maxDelayInMs) throws IOException;
+
     /**
      * Acknowledge one or several received
      * messages. Supply the deliveryTag from the {@link com.rabbitmq.client.AMQP.Basic.GetOk}
@@ -898,6 +1100,29 @@ public interface Channel extends ShutdownNotifier, AutoCloseable {
      */
     String basicConsume(String queue, boolean autoAck, DeliverCallback deliverCallback, CancelCallback cancelCallback) throws IOException;
 
+    /**
+     * Start a non-nolocal, non-exclusive consumer, with
+     * a server-generated consumerTag, receiving messages
+     * decoded with a {@link MessageCodec}.
+     * Messages are decoded on the consumer dispatch thread, right before
+     * the callback is called. A message that cannot be decoded is handled
+     * like an exception thrown by the callback, by the
+     * {@link ExceptionHandler} of the connection.
+     * @param queue the name of the queue
+     * @param autoAck true if the server should consider messages
+     * acknowledged once delivered; false if the server should expect
+     * explicit acknowledgements
+     * @param codec the codec to decode messages with
+     * @param deliverCallback callback when a message is delivered
+     * @param cancelCallback callback when the consumer is cancelled
+     * @param <T> the type of the decoded messages
+     * @return the consumerTag generated by the server
+     * @throws IOException if an error is encountered
+     * @see #basicConsume(String, boolean, DeliverCallback, CancelCallback)
+     * @since 6.0.0
+     */
+    <T> String basicConsume(String queue, boolean autoAck, MessageCodec<T> codec, TypedDeliverCallback<T> deliverCallback, CancelCallback cancelCallback) throws IOException;
+
     /**
      * Start a non-nolocal, non-exclusive consumer, with
      * a server-generated consumerTag.
@@ -1290,6 +1515,44 @@ public interface Channel extends ShutdownNotifier, AutoCloseable {
      */
     long getNextPublishSeqNo();
 
+    /**
+     * Correlate returned messages with their publish sequence number, when in confirm mode.
+     * <p>
+     * When enabled, {@link Return#getPublishSeqNo()} tells which message a return is about,
+     * for {@link ReturnCallback}s.
+     * <p>
+     * Nothing is added to the messages: the broker sends the return of a message before
+     * confirming it, so a return is matched with the confirm that follows it.
+     * {@link ReturnCallback}s are then called when this confirm arrives, right before
+     * the {@link ConfirmListener}s. The sequence number is 0 if a confirm with the
+     * <code>multiple</code> flag covers more <code>mandatory</code> messages than
+     * there are returns to correlate.
+     *
+     * @param enabled whether to correlate returns
+     * @see #addReturnListener(ReturnCallback)
+     * @since 6.0.0
+     */
+    void setReturnCorrelation(boolean enabled);
+
+    /**
+     * Limit the number of unconfirmed messages on this channel, when in confirm mode.
+     * <p>
+     * When the limit is reached, <code>basicPublish</code> and <code>basicPublishAsync</code>
+     * wait for confirms to make room, like a sliding window. This keeps publishing
+     * pipelined while bounding the amount of unconfirmed messages, instead of stopping
+     * with {@link #waitForConfirms()}.
+     * <p>
+     * Publishing must not wait on the connection thread, e.g. from a {@link ConfirmListener}:
+     * use a timeout of 0 there.
+     *
+     * @param maxOutstandingConfirms maximum number of unconfirmed messages, 0 for no limit
+     * @param timeoutInMs how long to wait for room before throwing a {@link ConfirmWindowFullException},
+     *                    0 to throw immediately, a negative value to wait indefinitely
+     * @see #confirmSelect()
+     * @since 6.0.0
+     */
+    void setConfirmWindow(int maxOutstandingConfirms, long timeoutInMs);
+
     /**
      * Wait until all messages published since the last call have been
      * either ack'd or nack'd by the broker.  Note, when called on a
@@ -0,0 +1,49 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client;
+
+import java.io.IOException;
+
+/**
+ * Thrown when a message cannot be published because the channel
+ * has too many unconfirmed messages.
+ *
+ * @see Channel#setConfirmWindow(int, long)
+ * @since 6.0.0
+ */
+public class ConfirmWindowFullException extends IOException {
+
+    /** Default for non-checking. */
+    private static final long serialVersionUID = 1L;
+
+    /**
+     * The maximum number of unconfirmed messages of the channel.
+     */
+    private final int maxOutstandingConfirms;
+
+    public ConfirmWindowFullException(int maxOutstandingConfirms) {
+        super("Too many unconfirmed messages (" + maxOutstandingConfirms + ")");
+        this.maxOutstandingConfirms = maxOutstandingConfirms;
+    }
+
+    /**
+     *
+     * @return the maximum number of unconfirmed messages of the channel
+     */
+    public int getMaxOutstandingConfirms() {
+        return maxOutstandingConfirms;
+    }
+}
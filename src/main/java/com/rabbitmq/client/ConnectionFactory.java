@@ -109,6 +109,12 @@ public class ConnectionFactory implements Cloneable {
     /** The default timeout for work pool enqueueing: no timeout */
     public static final int    DEFAULT_WORK_POOL_TIMEOUT = -1;
 
+    /** The default minimum size of the message bodies to encode with the body codec: 1 KiB */
+    public static final int    DEFAULT_BODY_CODEC_THRESHOLD = 1024;
+
+    /** The default maximum size of decoded message bodies, in bytes (64 MiB) */
+    public static final int    DEFAULT_BODY_CODEC_MAX_DECODED_SIZE = 64 * 1024 * 1024;
+
     private static final String PREFERRED_TLS_PROTOCOL = "TLSv1.2";
 
     private static final String FALLBACK_TLS_PROTOCOL = "TLSv1";
@@ -181,6 +187,36 @@ public class ConnectionFactory implements Cloneable {
      */
     private int workPoolTimeout = DEFAULT_WORK_POOL_TIMEOUT;
 
+    /**
+     * Whether to dispatch to consumers on virtual threads.
+     * @since 6.0.0
+     */
+    private boolean virtualThreadDispatch = false;
+
+    /**
+     * Codec to encode and decode message bodies with, none by default.
+     * @since 6.0.0
+     */
+    private BodyCodec bodyCodec;
+
+    /**
+     * Minimum size of the message bodies to encode with the body codec.
+     * @since 6.0.0
+     */
+    private int bodyCodecThreshold = DEFAULT_BODY_CODEC_THRESHOLD;
+
+    /**
+     * Maximum size of the message bodies decoded with the body codec.
+     * @since 6.0.0
+     */
+    private int bodyCodecMaxDecodedSize = DEFAULT_BODY_CODEC_MAX_DECODED_SIZE;
+
+    /**
+     * Whether to decode message bodies on the consumer dispatch thread.
+     * @since 6.0.0
+     */
+    private boolean bodyDecodingOnDispatchThread = false;
+
     /**
      * Filter to include/exclude entities from topology recovery.
      * @since 4.8.0
@@ -1106,6 +1142,11 @@ public class ConnectionFactory implements Cloneable {
         result.setChannelRpcTimeout(channelRpcTimeout);
         result.setChannelShouldCheckRpcResponseType(channelShouldCheckRpcResponseType);
         result.setWorkPoolTimeout(workPoolTimeout);
+        result.setVirtualThreadDispatch(virtualThreadDispatch);
+        result.setBodyCodec(bodyCodec);
+        result.setBodyCodecThreshold(bodyCodecThreshold);
+        result.setBodyCodecMaxDecodedSize(bodyCodecMaxDecodedSize);
+        result.setBodyDecodingOnDispatchThread(bodyDecodingOnDispatchThread);
         result.setErrorOnWriteListener(errorOnWriteListener);
         result.setTopologyRecoveryFilter(topologyRecoveryFilter);
         result.setConnectionRecoveryTriggeringCondition(connectionRecoveryTriggeringCondition);
@@ -1447,6 +1488,125 @@ public class ConnectionFactory implements Cloneable {
         return workPoolTimeout;
     }
 
+    /**
+     * Dispatch deliveries and other consumer callbacks on virtual threads.
+     * Each batch of work for a channel runs on a new virtual thread,
+     * work for a given channel is still processed in order.
+     * This lets consumers block (e.g. on I/O) in their callbacks without
+     * starving other consumers of the connection.
+     * Virtual threads require a JVM that supports them, the default
+     * consumer thread pool is used otherwise.
+     * This setting has no effect if an executor is provided with
+     * {@link #setSharedExecutor(ExecutorService)} or
+     * {@link #newConnection(ExecutorService)}.
+     * Default is false.
+     *
+     * @param virtualThreadDispatch whether to use virtual threads for consumer dispatch
+     * @since 6.0.0
+     */
+    public void setVirtualThreadDispatch(boolean virtualThreadDispatch) {
+        this.virtualThreadDispatch = virtualThreadDispatch;
+    }
+
+    /**
+     * Retrieve whether consumer callbacks are dispatched on virtual threads.
+     * @return true if consumer dispatch uses virtual threads when the JVM supports them
+     * @see #setVirtualThreadDispatch(boolean)
+     * @since 6.0.0
+     */
+    public boolean isVirtualThreadDispatch() {
+        return virtualThreadDispatch;
+    }
+
+    /**
+     * Set a codec to apply to message bodies, e.g. to compress them.
+     * Bodies published with <code>basicPublish</code> and <code>basicPublishAsync</code>,
+     * or a {@link PreparedPublish}, are encoded if they are at least
+     * {@link #setBodyCodecThreshold(int) the threshold} big, if the message has
+     * no <code>content-encoding</code> yet, and if the encoded body is smaller.
+     * Their <code>content-encoding</code> is then set to the one of the codec.
+     * Delivered messages, and messages got with <code>basicGet</code>, with this
+     * <code>content-encoding</code> are decoded, and their <code>content-encoding</code>
+     * is removed. A message that cannot be decoded is handed over as is, and
+     * a warning is logged.
+     * <p>
+     * Bodies published from a stream and bodies received by a {@link StreamingConsumer}
+     * are not encoded nor decoded.
+     * Default is no codec.
+     *
+     * @param bodyCodec the codec, null for none
+     * @see DeflateBodyCodec
+     * @since 6.0.0
+     */
+    public void setBodyCodec(BodyCodec bodyCodec) {
+        this.bodyCodec = bodyCodec;
+    }
+
+    public BodyCodec getBodyCodec() {
+        return bodyCodec;
+    }
+
+    /**
+     * Set the minimum size of the message bodies to encode with the body codec.
+     * Encoding small bodies costs more than it saves.
+     * Default is {@link #DEFAULT_BODY_CODEC_THRESHOLD}.
+     *
+     * @param bodyCodecThreshold the minimum size, in bytes
+     * @see #setBodyCodec(BodyCodec)
+     * @since 6.0.0
+     */
+    public void setBodyCodecThreshold(int bodyCodecThreshold) {
+        if (bodyCodecThreshold < 0) {
+            throw new IllegalArgumentException("Body codec threshold cannot be negative");
+        }
+        this.bodyCodecThreshold = bodyCodecThreshold;
+    }
+
+    public int getBodyCodecThreshold() {
+        return bodyCodecThreshold;
+    }
+
+    /**
+     * Set the maximum size of the message bodies decoded with the body codec.
+     * A delivered message whose body would be bigger once decoded is handed
+     * over as is, like a message that cannot be decoded. This protects from
+     * small bodies that decompress to huge ones.
+     * Default is {@link #DEFAULT_BODY_CODEC_MAX_DECODED_SIZE}.
+     *
+     * @param bodyCodecMaxDecodedSize the maximum size, in bytes
+     * @see #setBodyCodec(BodyCodec)
+     * @since 6.0.0
+     */
+    public void setBodyCodecMaxDecodedSize(int bodyCodecMaxDecodedSize) {
+        if (bodyCodecMaxDecodedSize <= 0) {
+            throw new IllegalArgumentException("Body codec maximum decoded size must be positive");
+        }
+        this.bodyCodecMaxDecodedSize = bodyCodecMaxDecodedSize;
+    }
+
+    public int getBodyCodecMaxDecodedSize() {
+        return bodyCodecMaxDecodedSize;
+    }
+
+    /**
+     * Decode delivered message bodies on the consumer dispatch thread, right
+     * before <code>handleDelivery</code>, instead of on the connection thread.
+     * This keeps decoding off the thread that reads from the socket, which
+     * matters when it reads for several connections with NIO.
+     * Default is false.
+     *
+     * @param bodyDecodingOnDispatchThread whether to decode on the dispatch thread
+     * @see #setBodyCodec(BodyCodec)
+     * @since 6.0.0
+     */
+    public void setBodyDecodingOnDispatchThread(boolean bodyDecodingOnDispatchThread) {
+        this.bodyDecodingOnDispatchThread = bodyDecodingOnDispatchThread;
+    }
+
+    public boolean isBodyDecodingOnDispatchThread() {
+        return bodyDecodingOnDispatchThread;
+    }
+
     /**
      * Set a listener to be called when connection gets an IO error trying to write on the socket.
      * Default listener triggers connection recovery asynchronously and propagates
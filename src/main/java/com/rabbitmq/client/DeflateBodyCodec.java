@@ -0,0 +1,110 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client;
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.util.zip.DataFormatException;
+import java.util.zip.Deflater;
+import java.util.zip.Inflater;
+
+/**
+ * {@link BodyCodec} compressing bodies with the JDK {@link Deflater},
+ * in the zlib format of the <code>deflate</code> content encoding.
+ *
+ * @see ConnectionFactory#setBodyCodec(BodyCodec)
+ * @since 6.0.0
+ */
+public class DeflateBodyCodec implements BodyCodec {
+
+    public static final String CONTENT_ENCODING = "deflate";
+
+    private final int level;
+
+    /**
+     * Create a codec with the fastest compression level.
+     */
+    public DeflateBodyCodec() {
+        this(Deflater.BEST_SPEED);
+    }
+
+    /**
+     * Create a codec with a given compression level.
+     * @param level the compression level, from 0 to 9, or -1 for the default level
+     * @see Deflater#setLevel(int)
+     */
+    public DeflateBodyCodec(int level) {
+        if ((level < 0 || level > 9) && level != Deflater.DEFAULT_COMPRESSION) {
+            throw new IllegalArgumentException("Invalid compression level: " + level);
+        }
+        this.level = level;
+    }
+
+    @Override
+    public String getContentEncoding() {
+        return CONTENT_ENCODING;
+    }
+
+    @Override
+    public byte[] encode(byte[] body) {
+        Deflater deflater = new Deflater(level);
+        try {
+            deflater.setInput(body);
+            deflater.finish();
+            // compressible bodies fit in the first buffer
+            ByteArrayOutputStream out = new ByteArrayOutputStream(body.length / 2 + 64);
+            byte[] buffer = new byte[Math.min(Math.max(body.length / 2, 64), 65536)];
+            while (!deflater.finished()) {
+                int length = deflater.deflate(buffer);
+                out.write(buffer, 0, length);
+            }
+            return out.toByteArray();
+        } finally {
+            deflater.end();
+        }
+    }
+
+    @Override
+    public byte[] decode(byte[] body) throws IOException {
+        return decode(body, Integer.MAX_VALUE);
+    }
+
+    @Override
+    public byte[] decode(byte[] body, int maxDecodedSize) throws IOException {
+        Inflater inflater = new Inflater();
+        try {
+            inflater.setInput(body);
+            ByteArrayOutputStream out = new ByteArrayOutputStream(Math.min(Math.max(body.length * 2, 64), maxDecodedSize));
+            byte[] buffer = new byte[Math.min(Math.max(body.length, 64), 65536)];
+            while (!inflater.finished()) {
+                int length = inflater.inflate(buffer);
+                if (length == 0 && (inflater.needsInput() || inflater.needsDictionary())) {
+                    throw new IOException("Truncated deflate body");
+                }
+                if (length > maxDecodedSize - out.size()) {
+                    throw new IOException("Decoded body is bigger than " + maxDecodedSize + " bytes");
+                }
+                out.write(buffer, 0, length);
+            }
+            return out.toByteArray();
+        } catch (DataFormatException e) {
+            throw new IOException("Invalid deflate body", e);
+        } finally {
+            inflater.end();
+        }
+    }
+}
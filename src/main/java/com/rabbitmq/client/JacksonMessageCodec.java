@@ -0,0 +1,71 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client;
+
+import com.fasterxml.jackson.core.JsonGenerator;
+import com.fasterxml.jackson.databind.JavaType;
+import com.fasterxml.jackson.databind.ObjectMapper;
+import com.fasterxml.jackson.databind.ObjectReader;
+import com.fasterxml.jackson.databind.ObjectWriter;
+
+import java.io.IOException;
+import java.io.OutputStream;
+
+/**
+ * {@link MessageCodec} of JSON messages, based on Jackson.
+ * Uses the databind module, which must be on the classpath.
+ *
+ * @param <T> the type of the messages
+ * @see MessageCodec
+ * @since 6.0.0
+ */
+public class JacksonMessageCodec<T> implements MessageCodec<T> {
+
+    public static final String CONTENT_TYPE = "application/json";
+
+    private final ObjectReader reader;
+    private final ObjectWriter writer;
+
+    public JacksonMessageCodec(ObjectMapper mapper, Class<T> type) {
+        this(mapper, mapper.constructType(type));
+    }
+
+    public JacksonMessageCodec(ObjectMapper mapper, JavaType type) {
+        this.reader = mapper.readerFor(type);
+        // the stream is the body of a single message
+        this.writer = mapper.writerFor(type).without(JsonGenerator.Feature.AUTO_CLOSE_TARGET);
+    }
+
+    public JacksonMessageCodec(Class<T> type) {
+        this(new ObjectMapper(), type);
+    }
+
+    @Override
+    public String getContentType() {
+        return CONTENT_TYPE;
+    }
+
+    @Override
+    public void encode(T message, OutputStream body) throws IOException {
+        writer.writeValue(body, message);
+    }
+
+    @Override
+    public T decode(AMQP.BasicProperties properties, byte[] body) throws IOException {
+        return reader.readValue(body);
+    }
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client;
+
+import java.io.IOException;
+import java.io.OutputStream;
+
+/**
+ * Converts messages between application objects and message bodies,
+ * e.g. with a JSON library.
+ * <p>
+ * The library calls the codec where the bodies are: objects are encoded
+ * straight into the payload of the outbound body frames, and decoded from the
+ * received body, on the consumer dispatch thread. No intermediate byte array
+ * is needed on the application side.
+ * <p>
+ * Implementations must be thread-safe.
+ *
+ * @param <T> the type of the application objects
+ * @see Channel#basicPublish(String, String, boolean, AMQP.BasicProperties, MessageCodec, Object)
+ * @see Channel#basicConsume(String, boolean, MessageCodec, TypedDeliverCallback, CancelCallback)
+ * @see JacksonMessageCodec
+ * @since 6.0.0
+ */
+public interface MessageCodec<T> {
+
+    /**
+     * The content type of encoded messages, set on published messages without one.
+     * @return the content type, e.g. <code>application/json</code>, or null for none
+     */
+    String getContentType();
+
+    /**
+     * Encode a message.
+     * @param message the message to encode
+     * @param body the stream to write the body to, it does not need to be closed
+     * @throws IOException if the message cannot be encoded
+     */
+    void encode(T message, OutputStream body) throws IOException;
+
+    /**
+     * Decode a message.
+     * @param properties the properties of the message
+     * @param body the body of the message
+     * @return the decoded message
+     * @throws IOException if the message cannot be decoded
+     */
+    T decode(AMQP.BasicProperties properties, byte[] body) throws IOException;
+
+}
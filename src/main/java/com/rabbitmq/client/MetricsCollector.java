@@ -15,6 +15,8 @@
 
 package com.rabbitmq.client;
 
+import java.util.concurrent.TimeUnit;
+
 /**
  * Interface to gather execution data of the client.
  * Note transactions are not supported: they deal with
@@ -44,6 +46,21 @@ public interface MetricsCollector {
 
     void basicPublishUnrouted(Channel channel);
 
+    /**
+     * Record the time between the publishing of a message and its confirm
+     * (ack or nack) by the broker, for each confirmed message.
+     * Called only on channels in confirm mode.
+     * The default implementation does nothing.
+     *
+     * @param channel the channel the message was published on
+     * @param latency the time between publish and confirm
+     * @param unit the unit of the latency
+     * @since 6.0.0
+     */
+    default void basicPublishConfirmLatency(Channel channel, long latency, TimeUnit unit) {
+
+    }
+
     void consumedMessage(Channel channel, long deliveryTag, boolean autoAck);
 
     void consumedMessage(Channel channel, long deliveryTag, String consumerTag);
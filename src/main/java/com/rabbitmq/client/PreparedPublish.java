@@ -0,0 +1,51 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client;
+
+import java.io.IOException;
+
+/**
+ * Handle to publish messages with a fixed exchange, routing key and mandatory flag.
+ * <p>
+ * The <code>basic.publish</code> method frame is encoded once, when the handle
+ * is created, and re-used for each message. The content header of messages without
+ * properties is encoded once as well, only the body size is written for each message.
+ * <p>
+ * Publishing with a handle is equivalent to
+ * {@link Channel#basicPublish(String, String, boolean, AMQP.BasicProperties, byte[])}
+ * with the same arguments: it is subject to publisher confirms, confirm windows
+ * and return correlation the same way. Like its channel, a handle should not
+ * be used concurrently by several threads.
+ *
+ * @see Channel#preparePublish(String, String, boolean)
+ * @since 6.0.0
+ */
+public interface PreparedPublish {
+
+    /**
+     * Publish a message.
+     * @param props other properties for the message - routing headers etc, can be null
+     * @param body the message body
+     * @throws java.io.IOException if an error is encountered
+     */
+    void publish(AMQP.BasicProperties props, byte[] body) throws IOException;
+
+    String getExchange();
+
+    String getRoutingKey();
+
+    boolean isMandatory();
+}
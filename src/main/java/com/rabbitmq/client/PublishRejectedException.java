@@ -0,0 +1,63 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client;
+
+import java.io.IOException;
+
+/**
+ * Thrown (or used to complete a future exceptionally) when a message
+ * published with publisher confirms is nack'd by the broker, or returned
+ * because it could not be routed.
+ *
+ * @see Channel#basicPublishAsync(String, String, boolean, AMQP.BasicProperties, byte[])
+ * @since 6.0.0
+ */
+public class PublishRejectedException extends IOException {
+
+    /** Default for non-checking. */
+    private static final long serialVersionUID = 1L;
+
+    /**
+     * The returned message, null if the message was nack'd.
+     */
+    private final Return returned;
+
+    public PublishRejectedException() {
+        super("Message nack'd by the broker");
+        this.returned = null;
+    }
+
+    public PublishRejectedException(Return returned) {
+        super("Message returned by the broker: " + returned.getReplyCode() + " " + returned.getReplyText());
+        this.returned = returned;
+    }
+
+    /**
+     *
+     * @return whether the message was returned, rather than nack'd
+     */
+    public boolean isReturned() {
+        return returned != null;
+    }
+
+    /**
+     *
+     * @return the returned message, or null if the message was nack'd
+     */
+    public Return getReturn() {
+        return returned;
+    }
+}
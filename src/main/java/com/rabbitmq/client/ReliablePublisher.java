@@ -0,0 +1,304 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.io.IOException;
+import java.util.HashMap;
+import java.util.Map;
+import java.util.UUID;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.ConcurrentNavigableMap;
+import java.util.concurrent.ConcurrentSkipListMap;
+
+/**
+ * Publisher that keeps messages until the broker confirms them and
+ * publishes them again when the connection recovers.
+ * <p>
+ * Messages are published with {@link Channel#basicPublishAsync(String, String, boolean, AMQP.BasicProperties, byte[])}
+ * on a channel in confirm mode. Unconfirmed messages are kept in a buffer
+ * bounded by their body size: {@link #publish(String, String, boolean, AMQP.BasicProperties, byte[])}
+ * blocks when the buffer is full. When the connection fails, the unconfirmed messages
+ * of a {@link Recoverable} channel, as well as messages published during the outage,
+ * are published again on the recovered channel, in their original order,
+ * in a single pipelined batch. Messages published until this batch is sent are
+ * held back and sent after it.
+ * <p>
+ * A message can therefore reach the broker more than once. Each message carries a
+ * {@link #PUBLISH_ID_HEADER} header, unique and identical for all its attempts, and a
+ * {@link #PUBLISH_ATTEMPT_HEADER} header, greater than 1 for messages published again, for consumers
+ * to detect duplicates.
+ * <p>
+ * Nacks, returns and channel errors are not retried: the future of the message
+ * completes exceptionally. Futures are completed on the connection thread.
+ * <p>
+ * Messages are kept in memory only.
+ *
+ * @since 6.0.0
+ */
+public class ReliablePublisher {
+
+    private static final Logger LOGGER = LoggerFactory.getLogger(ReliablePublisher.class);
+
+    /** Header carrying the unique identifier of a message, for de-duplication */
+    public static final String PUBLISH_ID_HEADER = "x-publish-id";
+    /** Header carrying the number of times a message has been published */
+    public static final String PUBLISH_ATTEMPT_HEADER = "x-publish-attempt";
+
+    private final Channel channel;
+    private final long maxBufferedBytes;
+    private final String publisherId = UUID.randomUUID().toString();
+
+    /** Unconfirmed messages, by publishing order */
+    private final ConcurrentNavigableMap<Long, Message> buffer = new ConcurrentSkipListMap<Long, Message>();
+    /** Identifier of the last published message, guarded by the publish monitor */
+    private long sequence = 0;
+    /** Whether new messages are held back until the buffer is published again, guarded by the publish monitor */
+    private boolean recovering = false;
+    /** Number of messages being published outside recovery, guarded by the publish monitor */
+    private int publishing = 0;
+    /** Body size of the buffered messages, guarded by the buffer monitor */
+    private long bufferedBytes = 0;
+    private final Object bufferMonitor = new Object();
+    /** Orders new messages with the ones published again */
+    private final Object publishMonitor = new Object();
+
+    /**
+     * Create a publisher on a channel.
+     * Confirms are selected on the channel if needed.
+     *
+     * @param channel the channel to publish on, should be {@link Recoverable} to publish messages again
+     * @param maxBufferedBytes maximum total body size of unconfirmed messages
+     * @throws IOException if selecting confirms fails
+     */
+    public ReliablePublisher(Channel channel, long maxBufferedBytes) throws IOException {
+        if (maxBufferedBytes <= 0) {
+            throw new IllegalArgumentException("Buffer size must be greater than 0: " + maxBufferedBytes);
+        }
+        this.channel = channel;
+        this.maxBufferedBytes = maxBufferedBytes;
+        if (channel.getNextPublishSeqNo() == 0) {
+            channel.confirmSelect();
+        }
+        if (channel instanceof Recoverable) {
+            channel.addShutdownListener(cause -> {
+                if (resendable(cause)) {
+                    holdBack();
+                }
+            });
+            ((Recoverable) channel).addRecoveryListener(new RecoveryListener() {
+
+                @Override
+                public void handleRecovery(Recoverable recoverable) {
+                    republish();
+                }
+
+                @Override
+                public void handleRecoveryStarted(Recoverable recoverable) {
+                }
+            });
+        }
+    }
+
+    /**
+     * Publish a message, once there is room for it in the buffer.
+     *
+     * @param exchange the exchange to publish the message to
+     * @param routingKey the routing key
+     * @param mandatory true if the 'mandatory' flag is to be set
+     * @param props other properties for the message - routing headers etc
+     * @param body the message body
+     * @return a future completed when the message is confirmed
+     * @throws IOException if the message cannot be published and will not be published again
+     * @throws InterruptedException if interrupted while waiting for room in the buffer
+     */
+    public CompletableFuture<Void> publish(String exchange, String routingKey, boolean mandatory,
+                                           AMQP.BasicProperties props, byte[] body)
+        throws IOException, InterruptedException {
+        reserve(body.length);
+        Message message;
+        synchronized (publishMonitor) {
+            long id = ++sequence;
+            message = new Message(id, exchange, routingKey, mandatory, props, body);
+            buffer.put(id, message);
+            if (recovering) {
+                // published after the older messages once the channel recovers
+                return message.confirm;
+            }
+            publishing++;
+        }
+        // outside of the monitor, publishing can wait for the confirm window
+        try {
+            send(message);
+        } catch (IOException | RuntimeException e) {
+            if (!resendable(e)) {
+                release(message);
+                throw e;
+            }
+            // published again once the channel recovers
+            holdBack();
+        } finally {
+            synchronized (publishMonitor) {
+                publishing--;
+                publishMonitor.notifyAll();
+            }
+        }
+        return message.confirm;
+    }
+
+    /**
+     * @return the number of messages not confirmed yet
+     */
+    public int getBufferedMessageCount() {
+        return buffer.size();
+    }
+
+    /**
+     * @return the total body size of the messages not confirmed yet
+     */
+    public long getBufferedBytes() {
+        synchronized (bufferMonitor) {
+            return bufferedBytes;
+        }
+    }
+
+    private void holdBack() {
+        synchronized (publishMonitor) {
+            recovering = true;
+        }
+    }
+
+    private void republish() {
+        synchronized (publishMonitor) {
+            recovering = true;
+            // messages published when the connection failed must not overtake the buffer
+            while (publishing > 0) {
+                try {
+                    publishMonitor.wait();
+                } catch (InterruptedException e) {
+                    Thread.currentThread().interrupt();
+                    LOGGER.warn("Interrupted before publishing messages again");
+                    return;
+                }
+            }
+        }
+        // every buffered message, in order, including the ones published meanwhile
+        long last = 0;
+        while (true) {
+            Message message;
+            synchronized (publishMonitor) {
+                Map.Entry<Long, Message> next = buffer.higherEntry(last);
+                if (next == null) {
+                    recovering = false;
+                    return;
+                }
+                message = next.getValue();
+            }
+            last = message.id;
+            try {
+                send(message);
+            } catch (Exception e) {
+                LOGGER.warn("Could not publish message {} again: {}", message.id, e.getMessage());
+                if (!resendable(e)) {
+                    release(message);
+                    message.confirm.completeExceptionally(e);
+                } else {
+                    // the connection failed again, the next recovery will take over
+                    return;
+                }
+            }
+        }
+    }
+
+    private void send(final Message message) throws IOException {
+        final int attempt = ++message.attempts;
+        Map<String, Object> headers = message.props == null || message.props.getHeaders() == null ?
+            new HashMap<String, Object>() : new HashMap<String, Object>(message.props.getHeaders());
+        headers.put(PUBLISH_ID_HEADER, publisherId + "-" + message.id);
+        headers.put(PUBLISH_ATTEMPT_HEADER, attempt);
+        AMQP.BasicProperties props = (message.props == null ? MessageProperties.MINIMAL_BASIC : message.props)
+            .builder().headers(headers).build();
+        channel.basicPublishAsync(message.exchange, message.routingKey, message.mandatory, props, message.body)
+            .whenComplete((result, error) -> confirmed(message, attempt, error));
+    }
+
+    private void confirmed(Message message, int attempt, Throwable error) {
+        if (attempt != message.attempts) {
+            return;
+        }
+        if (error == null) {
+            release(message);
+            message.confirm.complete(null);
+        } else if (!resendable(error)) {
+            release(message);
+            message.confirm.completeExceptionally(error);
+        }
+    }
+
+    /**
+     * Only connection failures are recovered, channel errors are not.
+     */
+    private boolean resendable(Throwable error) {
+        if (!(channel instanceof Recoverable) || !(error instanceof ShutdownSignalException)) {
+            return false;
+        }
+        ShutdownSignalException cause = (ShutdownSignalException) error;
+        return cause.isHardError() && !cause.isInitiatedByApplication();
+    }
+
+    private void reserve(int size) throws InterruptedException {
+        synchronized (bufferMonitor) {
+            // a message bigger than the buffer goes through alone
+            while (bufferedBytes > 0 && bufferedBytes + size > maxBufferedBytes) {
+                bufferMonitor.wait();
+            }
+            bufferedBytes += size;
+        }
+    }
+
+    private void release(Message message) {
+        if (buffer.remove(message.id) != null) {
+            synchronized (bufferMonitor) {
+                bufferedBytes -= message.body.length;
+                bufferMonitor.notifyAll();
+            }
+        }
+    }
+
+    private static final class Message {
+
+        private final long id;
+        private final String exchange;
+        private final String routingKey;
+        private final boolean mandatory;
+        private final AMQP.BasicProperties props;
+        private final byte[] body;
+        private final CompletableFuture<Void> confirm = new CompletableFuture<Void>();
+        private volatile int attempts = 0;
+
+        private Message(long id, String exchange, String routingKey, boolean mandatory,
+                        AMQP.BasicProperties props, byte[] body) {
+            this.id = id;
+            this.exchange = exchange;
+            this.routingKey = routingKey;
+            this.mandatory = mandatory;
+            this.props = props;
+            this.body = body;
+        }
+    }
+}
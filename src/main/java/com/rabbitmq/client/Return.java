@@ -26,14 +26,21 @@ public class Return {
     private final String routingKey;
     private final AMQP.BasicProperties properties;
     private final byte[] body;
+    private final long publishSeqNo;
 
     public Return(int replyCode, String replyText, String exchange, String routingKey, AMQP.BasicProperties properties, byte[] body) {
+        this(replyCode, replyText, exchange, routingKey, properties, body, 0L);
+    }
+
+    public Return(int replyCode, String replyText, String exchange, String routingKey, AMQP.BasicProperties properties, byte[] body,
+                  long publishSeqNo) {
         this.replyCode = replyCode;
         this.replyText = replyText;
         this.exchange = exchange;
         this.routingKey = routingKey;
         this.properties = properties;
         this.body = body;
+        this.publishSeqNo = publishSeqNo;
     }
 
     public int getReplyCode() {
@@ -59,4 +66,15 @@ public class Return {
     public byte[] getBody() {
         return body;
     }
+
+    /**
+     * The publish sequence number of the returned message, when the channel correlates
+     * returns with confirms.
+     * @return the publish sequence number, or 0 if unknown
+     * @see Channel#setReturnCorrelation(boolean)
+     * @since 6.0.0
+     */
+    public long getPublishSeqNo() {
+        return publishSeqNo;
+    }
 }
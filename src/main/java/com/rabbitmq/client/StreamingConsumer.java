@@ -0,0 +1,72 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client;
+
+import java.io.ByteArrayInputStream;
+import java.io.IOException;
+import java.io.InputStream;
+
+/**
+ * {@link Consumer} reading message bodies as streams, while they are received,
+ * instead of receiving them once they are complete. Large messages can then be
+ * processed with bounded memory.
+ * <p>
+ * {@link #handleDelivery(String, Envelope, AMQP.BasicProperties, InputStream)} is called
+ * as soon as the content header of a message is received. The connection thread
+ * feeds the stream with the body as it arrives, and waits for the consumer when
+ * a few frames are waiting to be read: a slow consumer slows down the reading of
+ * the whole connection (of all the connections of the thread with NIO).
+ * For the same reason, a streaming consumer must not wait for the connection,
+ * e.g. make a synchronous call like {@link Channel#queueDeclare()}, before it has
+ * read the body or closed the stream.
+ * <p>
+ * The stream is closed when the method returns, the rest of the body is then
+ * discarded. Reading a body that was cut short by the closing of the channel
+ * throws an {@link IOException}.
+ * @see Channel#basicConsume(String, boolean, Consumer)
+ * @since 6.0.0
+ */
+public interface StreamingConsumer extends Consumer {
+
+    /**
+     * Called when a <code><b>basic.deliver</b></code> is received for this consumer.
+     * @param consumerTag the <i>consumer tag</i> associated with the consumer
+     * @param envelope packaging data for the message
+     * @param properties content header data for the message
+     * @param body the message body, read while it is received
+     * @throws IOException if the consumer encounters an I/O error while processing the message
+     */
+    void handleDelivery(String consumerTag,
+                        Envelope envelope,
+                        AMQP.BasicProperties properties,
+                        InputStream body)
+        throws IOException;
+
+    /**
+     * Not called by the library for streaming consumers, delegates to
+     * {@link #handleDelivery(String, Envelope, AMQP.BasicProperties, InputStream)}.
+     */
+    @Override
+    default void handleDelivery(String consumerTag,
+                                Envelope envelope,
+                                AMQP.BasicProperties properties,
+                                byte[] body)
+        throws IOException
+    {
+        handleDelivery(consumerTag, envelope, properties, new ByteArrayInputStream(body));
+    }
+}
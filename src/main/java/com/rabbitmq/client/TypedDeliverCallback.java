@@ -0,0 +1,42 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client;
+
+import java.io.IOException;
+
+/**
+ * Callback interface to be notified when a message is delivered,
+ * once it is decoded with a {@link MessageCodec}.
+ * @param <T> the type of the decoded messages
+ * @see Channel#basicConsume(String, boolean, MessageCodec, TypedDeliverCallback, CancelCallback)
+ * @see DeliverCallback
+ * @since 6.0.0
+ */
+@FunctionalInterface
+public interface TypedDeliverCallback<T> {
+
+    /**
+     * Called when a <code><b>basic.deliver</b></code> is received for this consumer.
+     * @param consumerTag the <i>consumer tag</i> associated with the consumer
+     * @param envelope packaging data for the message
+     * @param properties content header data for the message
+     * @param message the decoded message
+     * @throws IOException if the consumer encounters an I/O error while processing the message
+     */
+    void handle(String consumerTag, Envelope envelope, AMQP.BasicProperties properties, T message) throws IOException;
+
+}
@@ -17,12 +17,21 @@ package com.rabbitmq.client.impl;
 
 import java.io.DataInputStream;
 import java.io.IOException;
+import java.math.BigDecimal;
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.Map;
 
 import com.rabbitmq.client.BasicProperties;
+import com.rabbitmq.client.LongString;
 
 public abstract class AMQBasicProperties
         extends AMQContentHeader implements BasicProperties {
 
+    /** Class of the read-only copy of the headers made by the properties constructor */
+    private static final Class<?> UNMODIFIABLE_MAP_CLASS =
+        Collections.unmodifiableMap(new HashMap<String, Object>()).getClass();
+
     protected AMQBasicProperties() {
         
     }
@@ -31,6 +40,50 @@ public abstract class AMQBasicProperties
         super(in);
     }
 
+    protected AMQBasicProperties(ValueReader in) throws IOException {
+        super(in);
+    }
+
+    /**
+     * The encoding is cached unless a property holds a mutable value:
+     * a timestamp, headers that can be modified, e.g. the ones of properties
+     * read from a frame, or a header value that is not a string or a number,
+     * e.g. a date, a byte array, a nested table or an array.
+     */
+    @Override
+    protected boolean isEncodingCacheable() {
+        if (getTimestamp() != null) {
+            return false;
+        }
+        Map<String, Object> headers = getHeaders();
+        if (headers != null) {
+            // only the read-only copy made by the constructor is known not to change
+            if (headers.getClass() != UNMODIFIABLE_MAP_CLASS) {
+                return false;
+            }
+            for (Object value : headers.values()) {
+                if (!isImmutable(value)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    private static boolean isImmutable(Object value) {
+        return value == null
+            || value instanceof String
+            || value instanceof LongString
+            || value instanceof Integer
+            || value instanceof Long
+            || value instanceof Short
+            || value instanceof Byte
+            || value instanceof Double
+            || value instanceof Float
+            || value instanceof Boolean
+            || value instanceof BigDecimal;
+    }
+
     @Override
     public Object clone() throws CloneNotSupportedException {
         return super.clone();
@@ -61,8 +61,17 @@ public abstract class AMQChannel extends ShutdownNotifierComponent {
     /** This channel's channel number. */
     private final int _channelNumber;
 
+    /** Decodes the short strings of inbound commands, only used by the thread reading frames */
+    private final ShortStringCache _shortStringCache = new ShortStringCache();
+
     /** Command being assembled */
-    private AMQCommand _command = new AMQCommand();
+    private AMQCommand _command = new AMQCommand(_shortStringCache);
+    /**
+     * Stream the content body of {@link #_command} goes to, if any. Read by
+     * other threads on shutdown, without the lock of the command, which the
+     * thread reading frames may hold.
+     */
+    private volatile ContentBodyInputStream _contentBodyStream;
 
     /** The current outstanding RPC request, if any. (Could become a queue in future.) */
     private RpcWrapper _activeRpc = null;
@@ -107,11 +116,32 @@ public abstract class AMQChannel extends ShutdownNotifierComponent {
     public void handleFrame(Frame frame) throws IOException {
         AMQCommand command = _command;
         if (command.handleFrame(frame)) { // a complete command has rolled off the assembly line
-            _command = new AMQCommand(); // prepare for the next one
+            _command = new AMQCommand(_shortStringCache); // prepare for the next one
+            _contentBodyStream = null;
             handleCompleteInboundCommand(command);
+        } else if (frame.type == AMQP.FRAME_HEADER) {
+            // the content body follows
+            handleContentHeader(command);
+            ContentBodyInputStream body = command.getContentBodyStream();
+            _contentBodyStream = body;
+            // the consumer may have closed the channel before the stream was published
+            ShutdownSignalException cause = getCloseReason();
+            if (body != null && cause != null) {
+                body.abort(wrap(cause, "Channel closed before the end of the content body"));
+            }
         }
     }
 
+    /**
+     * Protected API - called when the content header of a command is received,
+     * before its content body, e.g. to stream the body.
+     * Does nothing by default.
+     * @param command the incoming command, with its method and content header
+     * @throws IOException if an error is encountered
+     */
+    protected void handleContentHeader(AMQCommand command) throws IOException {
+    }
+
     /**
      * Placeholder until we address bug 15786 (implementing a proper exception hierarchy).
      * In the meantime, this at least won't throw away any information from the wrapped exception.
@@ -401,6 +431,10 @@ public abstract class AMQChannel extends ShutdownNotifierComponent {
         } finally {
             if (notifyRpc)
                 notifyOutstandingRpc(signal);
+            ContentBodyInputStream body = _contentBodyStream;
+            if (body != null) {
+                body.abort(wrap(signal, "Channel closed before the end of the content body"));
+            }
         }
     }
 
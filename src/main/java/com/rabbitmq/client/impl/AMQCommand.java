@@ -41,12 +41,32 @@ public class AMQCommand implements Command {
      */
     public static final int EMPTY_FRAME_SIZE = 8;
 
+    /** Size of the frames of a streamed body when the frame size is not limited */
+    private static final int STREAMED_FRAME_MAX = 131072;
+
     /** The assembler for this command - synchronised on - contains all the state */
     private final CommandAssembler assembler;
+    /** Pre-encoded method frame, null to encode the method on transmission */
+    private final Frame methodFrame;
+    /** Pre-encoded content header frame, null to encode the header on transmission */
+    private final Frame headerFrame;
+    /** Body read while the command is transmitted, null if the body is in the assembler */
+    private final ContentBodySource bodySource;
 
     /** Construct a command ready to fill in by reading frames */
     public AMQCommand() {
-        this(null, null, null);
+        this(null, null, null, null, null);
+    }
+
+    /**
+     * Construct a command ready to fill in by reading frames.
+     * @param shortStringCache cache to decode short strings with
+     */
+    AMQCommand(ShortStringCache shortStringCache) {
+        this.assembler = new CommandAssembler(null, null, null, shortStringCache);
+        this.methodFrame = null;
+        this.headerFrame = null;
+        this.bodySource = null;
     }
 
     /**
@@ -54,7 +74,7 @@ public class AMQCommand implements Command {
      * @param method the wrapped method
      */
     public AMQCommand(com.rabbitmq.client.Method method) {
-        this(method, null, null);
+        this(method, null, null, null, null);
     }
 
     /**
@@ -64,7 +84,38 @@ public class AMQCommand implements Command {
      * @param body the message body data
      */
     public AMQCommand(com.rabbitmq.client.Method method, AMQContentHeader contentHeader, byte[] body) {
+        this(method, contentHeader, body, null, null);
+    }
+
+    /**
+     * Construct a command with a specified method, header and body,
+     * and the frames they are already encoded to.
+     * @param method the wrapped method
+     * @param contentHeader the wrapped content header
+     * @param body the message body data
+     * @param methodFrame the encoded method, for the channel the command is transmitted on, or null
+     * @param headerFrame the encoded content header, for the channel the command is transmitted on, or null
+     */
+    AMQCommand(com.rabbitmq.client.Method method, AMQContentHeader contentHeader, byte[] body,
+               Frame methodFrame, Frame headerFrame) {
         this.assembler = new CommandAssembler((Method) method, contentHeader, body);
+        this.methodFrame = methodFrame;
+        this.headerFrame = headerFrame;
+        this.bodySource = null;
+    }
+
+    /**
+     * Construct a command with a specified method and header, and a body
+     * read fragment by fragment while the command is transmitted.
+     * @param method the wrapped method
+     * @param contentHeader the wrapped content header
+     * @param bodySource the source of the message body
+     */
+    AMQCommand(com.rabbitmq.client.Method method, AMQContentHeader contentHeader, ContentBodySource bodySource) {
+        this.assembler = new CommandAssembler((Method) method, contentHeader, null);
+        this.methodFrame = null;
+        this.headerFrame = null;
+        this.bodySource = bodySource;
     }
 
     /** Public API - {@inheritDoc} */
@@ -89,6 +140,19 @@ public class AMQCommand implements Command {
         return this.assembler.handleFrame(f);
     }
 
+    /**
+     * Streams the content body still to be received instead of accumulating it.
+     * @param stream the stream to append the fragments of the body to
+     */
+    void streamContentBody(ContentBodyInputStream stream) {
+        this.assembler.streamContentBody(stream);
+    }
+
+    /** @return the stream the content body goes to, null if it is accumulated */
+    ContentBodyInputStream getContentBodyStream() {
+        return this.assembler.getContentBodyStream();
+    }
+
     /**
      * Sends this command down the named channel on the channel's
      * connection, possibly in multiple frames.
@@ -101,10 +165,13 @@ public class AMQCommand implements Command {
 
         synchronized (assembler) {
             Method m = this.assembler.getMethod();
-            if (m.hasContent()) {
+            if (m.hasContent() && this.bodySource != null) {
+                transmitStreamed(connection, channelNumber, m);
+            } else if (m.hasContent()) {
                 byte[] body = this.assembler.getContentBody();
 
-                Frame headerFrame = this.assembler.getContentHeader().toFrame(channelNumber, body.length);
+                Frame headerFrame = this.headerFrame != null ? this.headerFrame :
+                    this.assembler.getContentHeader().toFrame(channelNumber, body.length);
 
                 int frameMax = connection.getFrameMax();
                 int bodyPayloadMax = (frameMax == 0) ? body.length : frameMax
@@ -114,7 +181,7 @@ public class AMQCommand implements Command {
                     throw new IllegalArgumentException("Content headers exceeded max frame size: " +
                             headerFrame.size() + " > " + frameMax);
                 }
-                connection.writeFrame(m.toFrame(channelNumber));
+                connection.writeFrame(this.methodFrame != null ? this.methodFrame : m.toFrame(channelNumber));
                 connection.writeFrame(headerFrame);
 
                 for (int offset = 0; offset < body.length; offset += bodyPayloadMax) {
@@ -134,6 +201,51 @@ public class AMQCommand implements Command {
         connection.flush();
     }
 
+    /**
+     * Sends the frames of a command whose body is read from {@link #bodySource},
+     * one body frame at a time.
+     * <p>
+     * The first fragment is read before anything is sent, so a source failing
+     * right away only fails the call. Once the content header is sent, the body
+     * cannot be cut short: if the source fails then, the connection is closed
+     * as if it had failed, because no other frame can follow on the channel.
+     */
+    private void transmitStreamed(AMQConnection connection, int channelNumber, Method m)
+        throws IOException
+    {
+        Frame headerFrame = this.assembler.getContentHeader().toFrame(channelNumber, this.bodySource.size());
+
+        int frameMax = connection.getFrameMax();
+        if (frameMax != 0 && headerFrame.size() > frameMax) {
+            throw new IllegalArgumentException("Content headers exceeded max frame size: " +
+                    headerFrame.size() + " > " + frameMax);
+        }
+        int bodyPayloadMax = streamedFragmentSize(frameMax);
+
+        this.bodySource.prefetch(bodyPayloadMax);
+        connection.writeFrame(m.toFrame(channelNumber));
+        connection.writeFrame(headerFrame);
+        byte[] fragment = this.bodySource.nextFragment(bodyPayloadMax);
+        while (fragment != null) {
+            // each frame gets its own array, frames may be queued before they are written
+            connection.writeFrame(new Frame(AMQP.FRAME_BODY, channelNumber, fragment));
+            try {
+                fragment = this.bodySource.nextFragment(bodyPayloadMax);
+            } catch (IOException | RuntimeException e) {
+                connection.handleIoError(e);
+                throw e;
+            }
+        }
+    }
+
+    /**
+     * @param frameMax the negotiated maximum frame size, 0 if it is not limited
+     * @return the size of the fragments of a body read while it is transmitted
+     */
+    static int streamedFragmentSize(int frameMax) {
+        return (frameMax == 0 ? STREAMED_FRAME_MAX : frameMax) - EMPTY_FRAME_SIZE;
+    }
+
     @Override public String toString() {
         return toString(false);
     }
@@ -65,6 +65,9 @@ public class AMQConnection extends ShutdownNotifierComponent implements Connecti
     private final ErrorOnWriteListener errorOnWriteListener;
 
     private final int workPoolTimeout;
+    private final boolean virtualThreadDispatch;
+    /** Codec of the message bodies, null if there is none */
+    private final BodyEncoding bodyEncoding;
 
     private final AtomicBoolean finalShutdownStarted = new AtomicBoolean(false);
 
@@ -105,6 +108,13 @@ public class AMQConnection extends ShutdownNotifierComponent implements Connecti
 
     protected ConsumerWorkService _workService = null;
 
+    /** Timer for deferred channel work (e.g. coalesced acknowledgements), created on demand */
+    private final Object channelTimerMonitor = new Object();
+    private ScheduledExecutorService channelTimer = null;
+    /** Runs the deferred channel work that may block, guarded by channelTimerMonitor */
+    private ExecutorService channelTaskExecutor = null;
+    private boolean channelTimerShutdown = false;
+
     /** Frame source/sink */
     private final FrameHandler _frameHandler;
 
@@ -254,10 +264,15 @@ public class AMQConnection extends ShutdownNotifierComponent implements Connecti
         this.errorOnWriteListener = params.getErrorOnWriteListener() != null ? params.getErrorOnWriteListener() :
             (connection, exception) -> { throw exception; }; // we just propagate the exception for non-recoverable connections
         this.workPoolTimeout = params.getWorkPoolTimeout();
+        this.virtualThreadDispatch = params.isVirtualThreadDispatch();
+        this.bodyEncoding = params.getBodyCodec() == null ? null :
+            new BodyEncoding(params.getBodyCodec(), params.getBodyCodecThreshold(), params.getBodyCodecMaxDecodedSize(),
+                params.isBodyDecodingOnDispatchThread());
     }
 
     private void initializeConsumerWorkService() {
-        this._workService  = new ConsumerWorkService(consumerWorkServiceExecutor, threadFactory, workPoolTimeout, shutdownTimeout);
+        this._workService  = new ConsumerWorkService(consumerWorkServiceExecutor, threadFactory, workPoolTimeout, shutdownTimeout,
+            virtualThreadDispatch);
     }
 
     private void initializeHeartbeatSender() {
@@ -505,6 +520,64 @@ public class AMQConnection extends ShutdownNotifierComponent implements Connecti
         return threadFactory;
     }
 
+    /**
+     * Private API - timer for deferred work of the channels of this connection.
+     * Tasks must be short and must not block: a single thread serves all the
+     * channels. Work that may block, e.g. writing to the socket, which waits for
+     * the channel and the socket, must be handed over to {@link #getChannelTaskExecutor()}.
+     * @return the timer, created on first use
+     * @throws RejectedExecutionException if the connection has been shut down
+     */
+    public ScheduledExecutorService getChannelTimer() {
+        synchronized (channelTimerMonitor) {
+            if (channelTimerShutdown) {
+                throw new RejectedExecutionException("Connection " + this + " is shut down");
+            }
+            if (channelTimer == null) {
+                channelTimer = Executors.newSingleThreadScheduledExecutor(threadFactory);
+            }
+            return channelTimer;
+        }
+    }
+
+    /**
+     * Private API - executor for deferred work of the channels of this connection
+     * that may block, e.g. sending coalesced acknowledgements. Its threads are
+     * created on demand and do not outlive the work, so a channel blocked on a
+     * write does not hold up the work of the other channels.
+     * @return the executor, created on first use
+     * @throws RejectedExecutionException if the connection has been shut down
+     */
+    public ExecutorService getChannelTaskExecutor() {
+        synchronized (channelTimerMonitor) {
+            if (channelTimerShutdown) {
+                throw new RejectedExecutionException("Connection " + this + " is shut down");
+            }
+            if (channelTaskExecutor == null) {
+                channelTaskExecutor = Executors.newCachedThreadPool(threadFactory);
+            }
+            return channelTaskExecutor;
+        }
+    }
+
+    private void shutdownChannelTimer() {
+        ScheduledExecutorService timer;
+        ExecutorService taskExecutor;
+        synchronized (channelTimerMonitor) {
+            channelTimerShutdown = true;
+            timer = channelTimer;
+            channelTimer = null;
+            taskExecutor = channelTaskExecutor;
+            channelTaskExecutor = null;
+        }
+        if (timer != null) {
+            timer.shutdown();
+        }
+        if (taskExecutor != null) {
+            taskExecutor.shutdown();
+        }
+    }
+
     @Override
     public Map<String, Object> getClientProperties() {
         return new HashMap<String, Object>(_clientProperties);
@@ -923,6 +996,7 @@ public class AMQConnection extends ShutdownNotifierComponent implements Connecti
 
         // stop any heartbeating
         _heartbeatSender.shutdown();
+        shutdownChannelTimer();
 
         _channel0.processShutdownSignal(sse, !initiatedByApplication, notifyRpc);
         return sse;
@@ -1125,4 +1199,9 @@ public class AMQConnection extends ShutdownNotifierComponent implements Connecti
     public boolean willCheckRpcResponseType() {
         return channelShouldCheckRpcResponseType;
     }
+
+    /** @return the codec of the message bodies, null if there is none */
+    BodyEncoding getBodyEncoding() {
+        return bodyEncoding;
+    }
 }
@@ -16,7 +16,6 @@
 package com.rabbitmq.client.impl;
 
 import java.io.DataInputStream;
-import java.io.DataOutputStream;
 import java.io.IOException;
 
 import com.rabbitmq.client.AMQP;
@@ -31,6 +30,16 @@ public abstract class AMQContentHeader implements ContentHeader {
      * Private API - Called by {@link AMQChannel#handleFrame}. Parses the header frame.
      */
     private long bodySize; 
+
+    /** Marks the encoding of properties that cannot be cached */
+    private static final byte[] NOT_CACHEABLE = new byte[0];
+
+    /**
+     * Encoded properties, once {@link #toFrame(int, long)} has been called,
+     * or {@link #NOT_CACHEABLE}. Properties do not change after construction,
+     * so the encoding is computed once and shared by all the frames.
+     */
+    private volatile byte[] encodedProperties;
     
     protected AMQContentHeader() {
         this.bodySize = 0;
@@ -40,16 +49,15 @@ public abstract class AMQContentHeader implements ContentHeader {
         in.readShort(); // weight not currently used
         this.bodySize = in.readLong();
     }
+
+    protected AMQContentHeader(ValueReader in) throws IOException {
+        in.readShort(); // weight not currently used
+        this.bodySize = in.readLonglong();
+    }
     
     public long getBodySize() { return bodySize; }
     
 
-    private void writeTo(DataOutputStream out, long bodySize) throws IOException {
-        out.writeShort(0); // weight - not currently used
-        out.writeLong(bodySize);
-        writePropertiesTo(new ContentHeaderPropertyWriter(out));
-    }
-
     /**
      * Private API - Autogenerated writer for this header
      */
@@ -68,15 +76,65 @@ public abstract class AMQContentHeader implements ContentHeader {
         return sb.toString();
     }
 
+    /**
+     * Whether the encoding of the properties can be computed once and re-used.
+     * This is the case when no property value can be changed once the header
+     * is created. Subclasses override to allow caching, e.g. when
+     * all values are immutable.
+     * @return <code><b>true</b></code> if the encoding can be cached, <code><b>false</b></code> by default
+     */
+    protected boolean isEncodingCacheable() {
+        return false;
+    }
+
     /**
      * Private API - Called by {@link AMQCommand#transmit}
      */
     public Frame toFrame(int channelNumber, long bodySize) throws IOException {
-        Frame frame = new Frame(AMQP.FRAME_HEADER, channelNumber);
-        DataOutputStream bodyOut = frame.getOutputStream();
-        bodyOut.writeShort(getClassId());
-        writeTo(bodyOut, bodySize);
-        return frame;
+        byte[] properties = encodedProperties();
+        byte[] payload;
+        if (properties == NOT_CACHEABLE) {
+            payload = encodeProperties(12);
+        } else {
+            payload = new byte[12 + properties.length];
+            System.arraycopy(properties, 0, payload, 12, properties.length);
+        }
+        // class id, weight (not currently used), body size, then the properties
+        int classId = getClassId();
+        payload[0] = (byte) (classId >>> 8);
+        payload[1] = (byte) classId;
+        for (int i = 11; i >= 4; i--) {
+            payload[i] = (byte) bodySize;
+            bodySize >>>= 8;
+        }
+        return new Frame(AMQP.FRAME_HEADER, channelNumber, payload);
+    }
+
+    /**
+     * Encodes the properties into an array of the exact size.
+     * @param offset number of bytes to leave before the properties
+     * @return the array, with the properties from <code>offset</code>
+     */
+    private byte[] encodeProperties(int offset) throws IOException {
+        BufferValueWriter sizer = new BufferValueWriter();
+        writePropertiesTo(new ContentHeaderPropertyWriter(sizer));
+        byte[] encoded = new byte[offset + sizer.position()];
+        writePropertiesTo(new ContentHeaderPropertyWriter(new BufferValueWriter(encoded, offset)));
+        return encoded;
+    }
+
+    private byte[] encodedProperties() throws IOException {
+        byte[] encoded = this.encodedProperties;
+        if (encoded == null) {
+            if (isEncodingCacheable()) {
+                encoded = encodeProperties(0);
+            } else {
+                encoded = NOT_CACHEABLE;
+            }
+            // racing threads compute the same encoding
+            this.encodedProperties = encoded;
+        }
+        return encoded;
     }
     
     @Override
@@ -22,6 +22,7 @@ import org.slf4j.LoggerFactory;
 import java.util.*;
 import java.util.concurrent.ConcurrentHashMap;
 import java.util.concurrent.ConcurrentMap;
+import java.util.concurrent.TimeUnit;
 import java.util.concurrent.locks.Lock;
 import java.util.concurrent.locks.ReentrantLock;
 
@@ -146,6 +147,15 @@ public abstract class AbstractMetricsCollector implements MetricsCollector {
         }
     }
 
+    @Override
+    public void basicPublishConfirmLatency(Channel channel, long latency, TimeUnit unit) {
+        try {
+            updatePublishConfirmLatency(latency, unit);
+        } catch(Exception e) {
+            LOGGER.info("Error while computing metrics in basicPublishConfirmLatency: " + e.getMessage());
+        }
+    }
+
     @Override
     public void basicConsume(Channel channel, String consumerTag, boolean autoAck) {
         try {
@@ -408,4 +418,15 @@ public abstract class AbstractMetricsCollector implements MetricsCollector {
      * Marks the event of a published message not being routed.
      */
     protected abstract void markPublishedMessageNotRouted();
+
+    /**
+     * Records the time between the publishing of a message and its confirm.
+     * Does nothing by default, subclasses override it to keep track of the latency.
+     * @param latency the time between publish and confirm
+     * @param unit the unit of the latency
+     */
+    protected void updatePublishConfirmLatency(long latency, TimeUnit unit) {
+
+    }
+
 }
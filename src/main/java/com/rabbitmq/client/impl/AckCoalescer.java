@@ -0,0 +1,407 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import java.io.IOException;
+import java.util.Arrays;
+import java.util.HashSet;
+import java.util.Set;
+
+/**
+ * Accumulates positive acknowledgements of a channel and sends them
+ * as a single <code>basic.ack</code> with <code>multiple</code> set.
+ * <p>
+ * The state of every delivery tag received on the channel is tracked
+ * in a ring, from the lowest tag not yet settled: <i>unsettled</i>
+ * (waiting for the application), <i>ack pending</i> (acknowledged by the application,
+ * not sent yet), <i>settled</i> (no acknowledgement expected, e.g.
+ * automatic acknowledgement, or already sent) or <i>untracked</i>
+ * (skipped by the tags received so far, so possibly waiting for the application).
+ * Once the tags at the head of the ring are no longer unsettled, a
+ * multiple acknowledgement for the highest pending one covers all of them
+ * and cannot acknowledge a message the application has not acknowledged.
+ * Acknowledgements received out of order stay pending until the tags before them
+ * are settled.
+ * <p>
+ * Pending acknowledgements are sent when {@link #maxBatchSize} of them
+ * can be covered by a single frame, or when the oldest of them has waited
+ * for {@link #maxDelayNanos}, in which case out-of-order acknowledgements are
+ * sent individually. They are also sent before any negative acknowledgement,
+ * recover or close, so the broker sees operations in the order the application issued them.
+ * <p>
+ * A message that is never acknowledged keeps the head of the ring, so
+ * the ring is capped to {@link #MAX_TRACKED_TAGS} delivery tags. Past
+ * this, coalescing stops for good: pending acknowledgements are sent
+ * with the next acknowledgement, which is sent right away like all the
+ * following ones.
+ * <p>
+ * This class is thread-safe. Acknowledgements are collected under its lock
+ * and sent once it is released, so tracking deliveries on the connection
+ * thread never waits for a write. A separate send lock keeps the
+ * acknowledgements in order on the wire.
+ *
+ * @see ChannelN#setAckCoalescing(int, long)
+ */
+final class AckCoalescer {
+
+    /** Sends an acknowledgement, or another settlement, to the broker. */
+    interface AckSender {
+        void sendAck(long deliveryTag, boolean multiple) throws IOException;
+    }
+
+    private static final byte UNSETTLED = 0;
+    private static final byte ACK_PENDING = 1;
+    private static final byte SETTLED = 2;
+    private static final byte UNTRACKED = 3;
+
+    private static final int INITIAL_RING_SIZE = 64;
+    /** Maximum number of delivery tags in the ring, a power of two */
+    static final int MAX_TRACKED_TAGS = 1 << 16;
+
+    private final int maxBatchSize;
+    private final long maxDelayNanos;
+    private final AckSender sender;
+
+    /** Held while collecting and sending acknowledgements, before the lock of the coalescer */
+    private final Object sendLock = new Object();
+    /** Acknowledgements to send, as <code>tag &lt;&lt; 1 | multiple</code>, guarded by {@link #sendLock} */
+    private long[] outgoing = new long[8];
+    private int outgoingCount = 0;
+
+    /** Consumers whose deliveries are not acknowledged */
+    private final Set<String> autoAckConsumers = new HashSet<String>();
+
+    /** Delivery tag states, the length is a power of two */
+    private byte[] states = new byte[INITIAL_RING_SIZE];
+    private int head = 0;
+    private int count = 0;
+    /** Delivery tag at the head of the ring, or the next expected one if the ring is empty */
+    private long firstTag;
+
+    /** Highest acknowledgement popped from the ring and not sent yet, 0 if none */
+    private long contiguousAckTag = 0;
+    private int contiguousAcks = 0;
+    /** Number of pending acknowledgements still in the ring */
+    private int outOfOrderAcks = 0;
+    /** When the oldest pending acknowledgement was received */
+    private long oldestPendingAck = 0;
+    /** Whether too many tags were outstanding, acknowledgements are then sent right away */
+    private boolean direct = false;
+
+    /**
+     * @param firstTag the next delivery tag of the channel, lower tags are considered settled
+     * @param maxBatchSize maximum number of acknowledgements covered by a single frame
+     * @param maxDelayNanos maximum time an acknowledgement can wait, in nanoseconds
+     * @param sender sends acknowledgements to the broker
+     */
+    AckCoalescer(long firstTag, int maxBatchSize, long maxDelayNanos, AckSender sender) {
+        if (firstTag < 1) {
+            throw new IllegalArgumentException("First delivery tag must be strictly positive: " + firstTag);
+        }
+        if (maxBatchSize <= 1) {
+            throw new IllegalArgumentException("Batch size must be greater than 1: " + maxBatchSize);
+        }
+        if (maxDelayNanos < 0) {
+            throw new IllegalArgumentException("Delay must be positive: " + maxDelayNanos);
+        }
+        this.firstTag = firstTag;
+        this.maxBatchSize = maxBatchSize;
+        this.maxDelayNanos = maxDelayNanos;
+        this.sender = sender;
+    }
+
+    long getMaxDelayNanos() {
+        return maxDelayNanos;
+    }
+
+    synchronized void consumeOk(String consumerTag, boolean autoAck) {
+        if (autoAck) {
+            autoAckConsumers.add(consumerTag);
+        }
+    }
+
+    synchronized void consumerCancelled(String consumerTag) {
+        autoAckConsumers.remove(consumerTag);
+    }
+
+    synchronized void delivered(long deliveryTag, String consumerTag) {
+        delivered(deliveryTag, autoAckConsumers.contains(consumerTag));
+    }
+
+    /**
+     * Track a delivery tag.
+     * @param deliveryTag the delivery tag
+     * @param autoAck whether the message is automatically acknowledged
+     */
+    synchronized void delivered(long deliveryTag, boolean autoAck) {
+        long lastTag = firstTag + count - 1;
+        if (direct || deliveryTag < firstTag) {
+            return;
+        }
+        if (deliveryTag <= lastTag) {
+            // a tag skipped so far, only the first delivery of a tag counts
+            if (state(deliveryTag) == UNTRACKED) {
+                setState(deliveryTag, autoAck ? SETTLED : UNSETTLED);
+                popSettled();
+            }
+            return;
+        }
+        if (deliveryTag - firstTag >= MAX_TRACKED_TAGS) {
+            // the head is likely stuck on a message that is never acknowledged,
+            // tracking the tags behind it would cost more and more
+            direct = true;
+            return;
+        }
+        // the application may get the messages of skipped tags later,
+        // they must not be covered by a multiple acknowledgement
+        while (lastTag < deliveryTag - 1) {
+            append(UNTRACKED);
+            lastTag++;
+        }
+        append(autoAck ? SETTLED : UNSETTLED);
+        popSettled();
+    }
+
+    /**
+     * Mark a tracked delivery tag as not needing any acknowledgement,
+     * e.g. a message got with automatic acknowledgement.
+     * @param deliveryTag the delivery tag
+     */
+    synchronized void autoAcked(long deliveryTag) {
+        settled(deliveryTag, false);
+    }
+
+    /**
+     * Acknowledge messages, possibly later.
+     * @param deliveryTag the delivery tag, 0 with multiple for all messages
+     * @param multiple whether to acknowledge all messages up to the delivery tag
+     * @param now current time, in nanoseconds
+     * @return true if there are pending acknowledgements after this call
+     * @throws IOException if sending acknowledgements fails
+     */
+    boolean ack(long deliveryTag, boolean multiple, long now) throws IOException {
+        synchronized (sendLock) {
+            boolean pendingAcks;
+            synchronized (this) {
+                pendingAcks = collectAck(deliveryTag, multiple, now);
+            }
+            sendOutgoing();
+            return pendingAcks;
+        }
+    }
+
+    private boolean collectAck(long deliveryTag, boolean multiple, long now) {
+        boolean hadPendingAcks = hasPendingAcks();
+        long lastTag = firstTag + count - 1;
+        long upTo = multiple && deliveryTag == 0 ? lastTag : deliveryTag;
+        if (direct || upTo < firstTag || upTo > lastTag || (!multiple && state(upTo) != UNSETTLED)) {
+            // not something we can coalesce safely, let the broker deal with it
+            collectPendingAcks();
+            collect(deliveryTag, multiple);
+            settled(deliveryTag, multiple);
+            return false;
+        }
+        if (multiple) {
+            for (long tag = firstTag; tag <= upTo; tag++) {
+                byte state = state(tag);
+                if (state == UNSETTLED || state == UNTRACKED) {
+                    setState(tag, ACK_PENDING);
+                    outOfOrderAcks++;
+                }
+            }
+        } else {
+            setState(deliveryTag, ACK_PENDING);
+            outOfOrderAcks++;
+        }
+        if (!hadPendingAcks) {
+            oldestPendingAck = now;
+        }
+        popSettled();
+        if (contiguousAcks >= maxBatchSize) {
+            collectContiguousAcks();
+            if (outOfOrderAcks > 0) {
+                // only the age of the oldest acknowledgement is tracked,
+                // the remaining ones may wait a little longer than the maximum delay
+                oldestPendingAck = now;
+            }
+        }
+        if (hasPendingAcks() && now - oldestPendingAck >= maxDelayNanos) {
+            collectPendingAcks();
+        }
+        return hasPendingAcks();
+    }
+
+    /**
+     * Settle delivery tags otherwise than with a positive acknowledgement,
+     * e.g. with a negative acknowledgement.
+     * Pending acknowledgements are sent first.
+     * @param deliveryTag the delivery tag, 0 with multiple for all messages
+     * @param multiple whether to settle all messages up to the delivery tag
+     * @param settler sends the settlement to the broker
+     * @throws IOException if sending acknowledgements or the settlement fails
+     */
+    void settle(long deliveryTag, boolean multiple, AckSender settler) throws IOException {
+        synchronized (sendLock) {
+            synchronized (this) {
+                collectPendingAcks();
+                settled(deliveryTag, multiple);
+            }
+            sendOutgoing();
+            settler.sendAck(deliveryTag, multiple);
+        }
+    }
+
+    private void settled(long deliveryTag, boolean multiple) {
+        if (direct) {
+            return;
+        }
+        long lastTag = firstTag + count - 1;
+        if (multiple && (deliveryTag == 0 || deliveryTag > lastTag)) {
+            deliveryTag = lastTag;
+        }
+        if (deliveryTag < firstTag || deliveryTag > lastTag) {
+            return;
+        }
+        long from = multiple ? firstTag : deliveryTag;
+        for (long tag = from; tag <= deliveryTag; tag++) {
+            byte state = state(tag);
+            if (state == UNSETTLED || state == UNTRACKED) {
+                setState(tag, SETTLED);
+            }
+        }
+        popSettled();
+    }
+
+    /**
+     * Send pending acknowledgements if the oldest has waited long enough.
+     * @param now current time, in nanoseconds
+     * @return the time to wait before the next call, in nanoseconds, or -1 if nothing is pending
+     * @throws IOException if sending acknowledgements fails
+     */
+    long flushIfDue(long now) throws IOException {
+        synchronized (sendLock) {
+            long nextDelay;
+            synchronized (this) {
+                if (!hasPendingAcks()) {
+                    return -1;
+                }
+                long waited = now - oldestPendingAck;
+                if (direct || waited >= maxDelayNanos) {
+                    collectPendingAcks();
+                    nextDelay = -1;
+                } else {
+                    nextDelay = maxDelayNanos - waited;
+                }
+            }
+            sendOutgoing();
+            return nextDelay;
+        }
+    }
+
+    /**
+     * Send all pending acknowledgements.
+     * @throws IOException if sending acknowledgements fails
+     */
+    void flush() throws IOException {
+        synchronized (sendLock) {
+            synchronized (this) {
+                collectPendingAcks();
+            }
+            sendOutgoing();
+        }
+    }
+
+    private void collectPendingAcks() {
+        collectContiguousAcks();
+        if (outOfOrderAcks > 0) {
+            for (int i = 0; i < count && outOfOrderAcks > 0; i++) {
+                int index = (head + i) & (states.length - 1);
+                if (states[index] == ACK_PENDING) {
+                    states[index] = SETTLED;
+                    outOfOrderAcks--;
+                    collect(firstTag + i, false);
+                }
+            }
+            popSettled();
+        }
+    }
+
+    synchronized boolean hasPendingAcks() {
+        return contiguousAcks > 0 || outOfOrderAcks > 0;
+    }
+
+    private void collectContiguousAcks() {
+        if (contiguousAcks > 0) {
+            long tag = contiguousAckTag;
+            boolean multiple = contiguousAcks > 1;
+            contiguousAckTag = 0;
+            contiguousAcks = 0;
+            collect(tag, multiple);
+        }
+    }
+
+    private void collect(long deliveryTag, boolean multiple) {
+        if (outgoingCount == outgoing.length) {
+            outgoing = Arrays.copyOf(outgoing, outgoing.length << 1);
+        }
+        outgoing[outgoingCount++] = deliveryTag << 1 | (multiple ? 1 : 0);
+    }
+
+    /** Must be called with {@link #sendLock} held, and not the lock of the coalescer. */
+    private void sendOutgoing() throws IOException {
+        try {
+            for (int i = 0; i < outgoingCount; i++) {
+                sender.sendAck(outgoing[i] >>> 1, (outgoing[i] & 1) != 0);
+            }
+        } finally {
+            outgoingCount = 0;
+        }
+    }
+
+    private void popSettled() {
+        while (count > 0 && (states[head] == ACK_PENDING || states[head] == SETTLED)) {
+            if (states[head] == ACK_PENDING) {
+                outOfOrderAcks--;
+                contiguousAckTag = firstTag;
+                contiguousAcks++;
+            }
+            head = (head + 1) & (states.length - 1);
+            count--;
+            firstTag++;
+        }
+    }
+
+    private byte state(long deliveryTag) {
+        return states[(int) ((head + (deliveryTag - firstTag)) & (states.length - 1))];
+    }
+
+    private void setState(long deliveryTag, byte state) {
+        states[(int) ((head + (deliveryTag - firstTag)) & (states.length - 1))] = state;
+    }
+
+    private void append(byte state) {
+        if (count == states.length) {
+            byte[] grown = new byte[states.length << 1];
+            int firstPart = states.length - head;
+            System.arraycopy(states, head, grown, 0, firstPart);
+            System.arraycopy(states, 0, grown, firstPart, head);
+            states = grown;
+            head = 0;
+        }
+        states[(head + count) & (states.length - 1)] = state;
+        count++;
+    }
+}
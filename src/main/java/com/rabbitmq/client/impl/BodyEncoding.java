@@ -0,0 +1,110 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client.impl;
+
+import com.rabbitmq.client.AMQP;
+import com.rabbitmq.client.BodyCodec;
+import com.rabbitmq.client.Delivery;
+import com.rabbitmq.client.Envelope;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.io.IOException;
+
+/**
+ * Applies the {@link BodyCodec} of a connection to the bodies of published
+ * and delivered messages.
+ *
+ * @see com.rabbitmq.client.ConnectionFactory#setBodyCodec(BodyCodec)
+ */
+final class BodyEncoding {
+
+    private static final Logger LOGGER = LoggerFactory.getLogger(BodyEncoding.class);
+
+    private final BodyCodec codec;
+    /** Minimum size of the bodies to encode */
+    private final int threshold;
+    /** Maximum size of the decoded bodies */
+    private final int maxDecodedSize;
+    private final boolean decodeOnDispatchThread;
+
+    BodyEncoding(BodyCodec codec, int threshold, int maxDecodedSize, boolean decodeOnDispatchThread) {
+        this.codec = codec;
+        this.threshold = threshold;
+        this.maxDecodedSize = maxDecodedSize;
+        this.decodeOnDispatchThread = decodeOnDispatchThread;
+    }
+
+    /**
+     * @param props the properties of the message to publish, can be null
+     * @param body the body of the message to publish
+     * @return the encoded body, null if the body is not encoded,
+     * because it is too small, already encoded, or does not get smaller
+     * @throws IOException if the codec fails
+     */
+    byte[] encode(AMQP.BasicProperties props, byte[] body) throws IOException {
+        if (body == null || body.length < threshold ||
+            (props != null && props.getContentEncoding() != null)) {
+            return null;
+        }
+        byte[] encoded = codec.encode(body);
+        return encoded.length < body.length ? encoded : null;
+    }
+
+    /**
+     * @param props the properties of the message to publish, can be null
+     * @return the properties of the message once its body is encoded
+     */
+    AMQP.BasicProperties encodedProperties(AMQP.BasicProperties props) {
+        AMQP.BasicProperties.Builder builder = props == null ?
+            new AMQP.BasicProperties.Builder() : props.builder();
+        return builder.contentEncoding(codec.getContentEncoding()).build();
+    }
+
+    /**
+     * @param props the properties of a delivered message
+     * @return true if the body of the message is encoded with the codec
+     */
+    boolean isEncoded(AMQP.BasicProperties props) {
+        return props != null && codec.getContentEncoding().equals(props.getContentEncoding());
+    }
+
+    /** @return true if bodies are decoded on the consumer dispatch thread, not on the connection thread */
+    boolean decodesOnDispatchThread() {
+        return decodeOnDispatchThread;
+    }
+
+    /**
+     * Decodes a delivered message, whose body is encoded with the codec.
+     * If the body cannot be decoded, or is too big once decoded, the message is returned as is,
+     * its <code>content-encoding</code> tells the consumer the body is still encoded.
+     * @return the decoded message, without <code>content-encoding</code>
+     */
+    Delivery decode(Envelope envelope, AMQP.BasicProperties props, byte[] body) {
+        byte[] decoded;
+        try {
+            decoded = codec.decode(body, maxDecodedSize);
+        } catch (IOException | RuntimeException e) {
+            LOGGER.warn("Could not decode body of message with delivery tag {} from exchange '{}' " +
+                "with routing key '{}', delivering it encoded with '{}'",
+                envelope.getDeliveryTag(), envelope.getExchange(), envelope.getRoutingKey(),
+                codec.getContentEncoding(), e);
+            return new Delivery(envelope, props, body);
+        }
+        return new Delivery(envelope, props.builder().contentEncoding(null).build(), decoded);
+    }
+}
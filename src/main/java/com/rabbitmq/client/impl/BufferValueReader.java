@@ -0,0 +1,244 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import java.io.EOFException;
+import java.io.IOException;
+import java.math.BigDecimal;
+import java.math.BigInteger;
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.Date;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+import com.rabbitmq.client.LongString;
+import com.rabbitmq.client.MalformedFrameException;
+
+/**
+ * {@link ValueReader} over a {@link ByteBuffer}, e.g. a frame payload.
+ * <p>
+ * Values are read with absolute gets at a cursor, without the stream stack
+ * (<code>ByteArrayInputStream</code>, <code>DataInputStream</code>, and a
+ * <code>TruncatedInputStream</code> per table) of the stream-based reader.
+ * Strings are decoded straight from the backing array when there is one.
+ * The position of the buffer is not changed.
+ */
+final class BufferValueReader extends ValueReader {
+
+    private final ByteBuffer buffer;
+    private final int limit;
+    private int position;
+    private final ShortStringCache shortStringCache;
+
+    /**
+     * @param buffer the buffer to read from, from its position to its limit, in big-endian order
+     */
+    BufferValueReader(ByteBuffer buffer) {
+        this(buffer, null);
+    }
+
+    /**
+     * @param buffer the buffer to read from, from its position to its limit, in big-endian order
+     * @param shortStringCache cache to decode short strings with, can be null
+     */
+    BufferValueReader(ByteBuffer buffer, ShortStringCache shortStringCache) {
+        this.buffer = buffer;
+        this.position = buffer.position();
+        this.limit = buffer.limit();
+        this.shortStringCache = shortStringCache;
+    }
+
+    /** @return the position of the cursor in the buffer */
+    int position() {
+        return position;
+    }
+
+    /** Move the cursor after <code>length</code> bytes, returning the position before. */
+    private int advance(long length) throws IOException {
+        int start = position;
+        position = end(length);
+        return start;
+    }
+
+    /** @return the position <code>length</code> bytes after the cursor */
+    private int end(long length) throws IOException {
+        if (length > limit - position) {
+            throw new EOFException();
+        }
+        return position + (int) length;
+    }
+
+    @Override
+    public String readShortstr() throws IOException {
+        int length = readOctet();
+        int start = advance(length);
+        if (buffer.hasArray()) {
+            if (shortStringCache != null) {
+                return shortStringCache.get(buffer.array(), buffer.arrayOffset() + start, length);
+            }
+            return new String(buffer.array(), buffer.arrayOffset() + start, length, StandardCharsets.UTF_8);
+        }
+        return new String(copy(start, length), StandardCharsets.UTF_8);
+    }
+
+    @Override
+    public LongString readLongstr() throws IOException {
+        int length = readBytesLength();
+        int start = advance(length);
+        if (buffer.hasArray()) {
+            // a slice of the payload, not a copy
+            return LongStringHelper.asLongString(buffer.array(), buffer.arrayOffset() + start, length);
+        }
+        return LongStringHelper.asLongString(copy(start, length));
+    }
+
+    private byte[] readBytes() throws IOException {
+        int length = readBytesLength();
+        return copy(advance(length), length);
+    }
+
+    private int readBytesLength() throws IOException {
+        long length = readLong() & 0xffffffffL;
+        if (length >= Integer.MAX_VALUE) {
+            throw new UnsupportedOperationException
+                ("Very long byte vectors and strings not currently supported");
+        }
+        return (int) length;
+    }
+
+    private byte[] copy(int start, int length) {
+        byte[] bytes = new byte[length];
+        for (int i = 0; i < length; i++) {
+            bytes[i] = buffer.get(start + i);
+        }
+        return bytes;
+    }
+
+    @Override
+    public int readShort() throws IOException {
+        return buffer.getShort(advance(2)) & 0xffff;
+    }
+
+    @Override
+    public int readLong() throws IOException {
+        return buffer.getInt(advance(4));
+    }
+
+    @Override
+    public long readLonglong() throws IOException {
+        return buffer.getLong(advance(8));
+    }
+
+    @Override
+    public int readOctet() throws IOException {
+        return buffer.get(advance(1)) & 0xff;
+    }
+
+    @Override
+    public Date readTimestamp() throws IOException {
+        return new Date(readLonglong() * 1000);
+    }
+
+    @Override
+    public Map<String, Object> readTable() throws IOException {
+        long length = readLong() & 0xffffffffL;
+        if (length == 0) return Collections.emptyMap();
+        return readTableEntries(end(length));
+    }
+
+    /**
+     * Reads table entries up to a position.
+     * @param end the position of the end of the entries
+     */
+    Map<String, Object> readTableEntries(int end) throws IOException {
+        Map<String, Object> table = new HashMap<String, Object>();
+        while (position < end) {
+            String name = readShortstr();
+            Object value = readFieldValue();
+            if (!table.containsKey(name))
+                table.put(name, value);
+        }
+        if (position != end) {
+            throw new MalformedFrameException("Table value crosses the table boundary");
+        }
+        return table;
+    }
+
+    @Override
+    public Map<String, Object> readLazyTable() throws IOException {
+        long length = readLong() & 0xffffffffL;
+        if (length == 0) return Collections.emptyMap();
+        int start = advance(length);
+        if (buffer.hasArray()) {
+            return new LazyTable(buffer.array(), buffer.arrayOffset() + start, (int) length);
+        }
+        return new LazyTable(copy(start, (int) length));
+    }
+
+    private List<Object> readArray() throws IOException {
+        long length = readLong() & 0xffffffffL;
+        int end = end(length);
+        List<Object> array = new ArrayList<Object>();
+        while (position < end) {
+            array.add(readFieldValue());
+        }
+        if (position != end) {
+            throw new MalformedFrameException("Array value crosses the array boundary");
+        }
+        return array;
+    }
+
+    Object readFieldValue() throws IOException {
+        switch (readOctet()) {
+            case 'S':
+                return readLongstr();
+            case 'I':
+                return readLong();
+            case 'D':
+                int scale = readOctet();
+                byte[] unscaled = copy(advance(4), 4);
+                return new BigDecimal(new BigInteger(unscaled), scale);
+            case 'T':
+                return readTimestamp();
+            case 'F':
+                return readTable();
+            case 'A':
+                return readArray();
+            case 'b':
+                return buffer.get(advance(1));
+            case 'd':
+                return buffer.getDouble(advance(8));
+            case 'f':
+                return buffer.getFloat(advance(4));
+            case 'l':
+                return readLonglong();
+            case 's':
+                return buffer.getShort(advance(2));
+            case 't':
+                return buffer.get(advance(1)) != 0;
+            case 'x':
+                return readBytes();
+            case 'V':
+                return null;
+            default:
+                throw new MalformedFrameException("Unrecognised type in table");
+        }
+    }
+}
@@ -0,0 +1,267 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client.impl;
+
+import java.io.IOException;
+import java.util.List;
+import java.util.Map;
+
+import com.rabbitmq.client.LongString;
+
+/**
+ * {@link ValueWriter} encoding into a byte array sized beforehand, to build
+ * frame payloads without intermediate streams and without growing buffers.
+ * <p>
+ * A writer without an array only counts the bytes it would write: running
+ * the same encoding with it first gives the exact size of the array.
+ * Strings are encoded straight into the array, ASCII strings byte per char,
+ * and the length of tables and arrays is written once their content is,
+ * so nothing is encoded or walked twice.
+ */
+final class BufferValueWriter extends ValueWriter {
+
+    /** The array to encode into, null to only count bytes */
+    private final byte[] buffer;
+    private int position;
+
+    /** Constructs a writer that only computes the size of the encoding. */
+    BufferValueWriter() {
+        this(null, 0);
+    }
+
+    /**
+     * @param buffer the array to encode into, large enough for the encoding
+     * @param offset where to start encoding
+     */
+    BufferValueWriter(byte[] buffer, int offset) {
+        this.buffer = buffer;
+        this.position = offset;
+    }
+
+    /** @return the position after the last byte written */
+    int position() {
+        return position;
+    }
+
+    @Override
+    public void writeShortstr(String str) throws IOException {
+        int length = utf8Length(str);
+        if (length > 255) {
+            throw new IllegalArgumentException(
+                    "Short string too long; utf-8 encoded length = " + length +
+                    ", max = 255.");
+        }
+        writeOctet(length);
+        writeUtf8(str, length);
+    }
+
+    @Override
+    public void writeLongstr(LongString str) throws IOException {
+        writeLong((int) str.length());
+        if (str instanceof LongStringHelper.ByteArrayLongString) {
+            if (buffer != null) {
+                ((LongStringHelper.ByteArrayLongString) str).copyTo(buffer, position);
+            }
+            position += (int) str.length();
+        } else {
+            writeBytes(str.getBytes());
+        }
+    }
+
+    @Override
+    public void writeLongstr(String str) throws IOException {
+        int length = utf8Length(str);
+        writeLong(length);
+        writeUtf8(str, length);
+    }
+
+    @Override
+    public void writeShort(int s) throws IOException {
+        if (buffer != null) {
+            buffer[position] = (byte) (s >>> 8);
+            buffer[position + 1] = (byte) s;
+        }
+        position += 2;
+    }
+
+    @Override
+    public void writeLong(int l) throws IOException {
+        if (buffer != null) {
+            buffer[position] = (byte) (l >>> 24);
+            buffer[position + 1] = (byte) (l >>> 16);
+            buffer[position + 2] = (byte) (l >>> 8);
+            buffer[position + 3] = (byte) l;
+        }
+        position += 4;
+    }
+
+    @Override
+    public void writeLonglong(long ll) throws IOException {
+        writeLong((int) (ll >>> 32));
+        writeLong((int) ll);
+    }
+
+    @Override
+    public void writeTable(Map<String, Object> table) throws IOException {
+        int start = position;
+        writeLong(0);
+        if (table != null) {
+            for (Map.Entry<String, Object> entry : table.entrySet()) {
+                writeShortstr(entry.getKey());
+                writeFieldValue(entry.getValue());
+            }
+            patchLength(start);
+        }
+    }
+
+    @Override
+    public void writeArray(List<?> value) throws IOException {
+        if (value == null) {
+            writeOctet(0);
+        } else {
+            int start = position;
+            writeLong(0);
+            for (Object item : value) {
+                writeFieldValue(item);
+            }
+            patchLength(start);
+        }
+    }
+
+    @Override
+    public void writeArray(Object[] value) throws IOException {
+        if (value == null) {
+            writeOctet(0);
+        } else {
+            int start = position;
+            writeLong(0);
+            for (Object item : value) {
+                writeFieldValue(item);
+            }
+            patchLength(start);
+        }
+    }
+
+    @Override
+    protected void writeBytes(byte[] bytes) {
+        if (buffer != null) {
+            System.arraycopy(bytes, 0, buffer, position, bytes.length);
+        }
+        position += bytes.length;
+    }
+
+    @Override
+    public void writeOctet(int octet) throws IOException {
+        if (buffer != null) {
+            buffer[position] = (byte) octet;
+        }
+        position++;
+    }
+
+    @Override
+    public void writeOctet(byte octet) throws IOException {
+        writeOctet((int) octet);
+    }
+
+    @Override
+    public void flush() {
+        // nothing to flush
+    }
+
+    /** Write the length of the content written after the 4 bytes at <code>start</code>. */
+    private void patchLength(int start) throws IOException {
+        if (buffer != null) {
+            int end = position;
+            position = start;
+            writeLong(end - start - 4);
+            position = end;
+        }
+    }
+
+    /** Write the UTF-8 encoding of a string, <code>length</code> bytes long. */
+    private void writeUtf8(String str, int length) {
+        if (buffer != null) {
+            encodeUtf8(str, buffer, position);
+        }
+        position += length;
+    }
+
+    /**
+     * Computes the length of the UTF-8 encoding of a string, without encoding it.
+     * Unpaired surrogates count as one byte, like {@link String#getBytes} replaces them.
+     * @param str the string
+     * @return the length of its UTF-8 encoding
+     */
+    static int utf8Length(String str) {
+        int length = str.length();
+        int utf8Length = length;
+        for (int i = 0; i < length; i++) {
+            char c = str.charAt(i);
+            if (c >= 0x80) {
+                if (c < 0x800) {
+                    utf8Length += 1;
+                } else if (Character.isHighSurrogate(c) && i + 1 < length
+                           && Character.isLowSurrogate(str.charAt(i + 1))) {
+                    // 4 bytes for 2 chars
+                    utf8Length += 2;
+                    i++;
+                } else if (!Character.isSurrogate(c)) {
+                    utf8Length += 2;
+                }
+            }
+        }
+        return utf8Length;
+    }
+
+    /**
+     * Encodes a string in UTF-8 into an array, like {@link String#getBytes}.
+     * @return the position after the encoding
+     */
+    static int encodeUtf8(String str, byte[] bytes, int offset) {
+        int length = str.length();
+        int i = 0;
+        // ASCII prefix, usually the whole string
+        for (; i < length; i++) {
+            char c = str.charAt(i);
+            if (c >= 0x80) break;
+            bytes[offset++] = (byte) c;
+        }
+        for (; i < length; i++) {
+            char c = str.charAt(i);
+            if (c < 0x80) {
+                bytes[offset++] = (byte) c;
+            } else if (c < 0x800) {
+                bytes[offset++] = (byte) (0xc0 | (c >> 6));
+                bytes[offset++] = (byte) (0x80 | (c & 0x3f));
+            } else if (Character.isHighSurrogate(c) && i + 1 < length
+                       && Character.isLowSurrogate(str.charAt(i + 1))) {
+                int codePoint = Character.toCodePoint(c, str.charAt(++i));
+                bytes[offset++] = (byte) (0xf0 | (codePoint >> 18));
+                bytes[offset++] = (byte) (0x80 | ((codePoint >> 12) & 0x3f));
+                bytes[offset++] = (byte) (0x80 | ((codePoint >> 6) & 0x3f));
+                bytes[offset++] = (byte) (0x80 | (codePoint & 0x3f));
+            } else if (Character.isSurrogate(c)) {
+                bytes[offset++] = '?';
+            } else {
+                bytes[offset++] = (byte) (0xe0 | (c >> 12));
+                bytes[offset++] = (byte) (0x80 | ((c >> 6) & 0x3f));
+                bytes[offset++] = (byte) (0x80 | (c & 0x3f));
+            }
+        }
+        return offset;
+    }
+}
@@ -15,14 +15,20 @@
 
 package com.rabbitmq.client.impl;
 
+import java.io.ByteArrayInputStream;
 import java.io.IOException;
+import java.io.InputStream;
+import java.io.InterruptedIOException;
+import java.nio.channels.FileChannel;
+import java.util.ArrayList;
 import java.util.Collection;
 import java.util.Collections;
 import java.util.HashMap;
+import java.util.List;
 import java.util.Map;
-import java.util.SortedSet;
-import java.util.TreeSet;
 import java.util.concurrent.*;
+import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.function.LongConsumer;
 
 import com.rabbitmq.client.ConfirmCallback;
 import com.rabbitmq.client.*;
@@ -84,12 +90,43 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
 
     /** Set of currently unconfirmed messages (i.e. messages that have
      *  not been ack'd or nack'd by the server yet. */
-    private final SortedSet<Long> unconfirmedSet =
-            Collections.synchronizedSortedSet(new TreeSet<Long>());
+    private final ConfirmTracker<CompletableFuture<Void>> unconfirmedSet;
+
+    /** Whether publish confirm latencies are recorded in the metrics collector. */
+    private final boolean recordConfirmLatency;
+    /** Records the latency of each confirmed message, null if latencies are not recorded. */
+    private final LongConsumer confirmLatencyRecorder;
+    /** When the confirm being handled was received, guarded by unconfirmedSet. */
+    private long confirmTime;
+
+    /** Maximum number of unconfirmed messages, 0 for no limit. */
+    private volatile int confirmWindow = 0;
+    /** How long to wait for room in the confirm window, negative to wait indefinitely. */
+    private volatile long confirmWindowTimeoutInMs = -1;
+
+    /** Finds the publish sequence number of returned messages, in confirm mode. */
+    private final ReturnCorrelator returnCorrelator = new ReturnCorrelator();
+    /** Whether returns handed to {@link ReturnCallback}s carry their publish sequence number. */
+    private volatile boolean returnCorrelation = false;
+    /** Sequence number of the last mandatory message whose return is not correlated, 0 if none. */
+    private volatile long lastUncorrelatedMandatory = 0;
 
     /** Whether any nacks have been received since the last waitForConfirms(). */
     private volatile boolean onlyAcksReceived = true;
 
+    /** Accumulator of acknowledgements when they are coalesced, null otherwise. */
+    private volatile AckCoalescer ackCoalescer;
+    /** Whether a message has been received on the channel, with basic.deliver or basic.get-ok. */
+    private volatile boolean messageReceived = false;
+    /** Whether a task to send coalesced acknowledgements is scheduled. */
+    private final AtomicBoolean ackFlushScheduled = new AtomicBoolean(false);
+
+    /** Controller of the prefetch count when it is set automatically, null otherwise. */
+    private volatile PrefetchController prefetchController;
+
+    /** Codec of the message bodies, null if there is none. */
+    private final BodyEncoding bodyEncoding;
+
     protected final MetricsCollector metricsCollector;
 
     /**
@@ -121,6 +158,10 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
         super(connection, channelNumber);
         this.dispatcher = new ConsumerDispatcher(connection, this, workService);
         this.metricsCollector = metricsCollector;
+        this.recordConfirmLatency = !(metricsCollector instanceof NoOpMetricsCollector);
+        this.unconfirmedSet = new ConfirmTracker<CompletableFuture<Void>>(recordConfirmLatency);
+        this.confirmLatencyRecorder = recordConfirmLatency ? this::reportConfirmLatency : null;
+        this.bodyEncoding = connection.getBodyEncoding();
     }
 
     /**
@@ -140,9 +181,7 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
 
     @Override
     public ReturnListener addReturnListener(ReturnCallback returnCallback) {
-        ReturnListener returnListener = (replyCode, replyText, exchange, routingKey, properties, body) -> returnCallback.handle(new Return(
-            replyCode, replyText, exchange, routingKey, properties, body
-        ));
+        ReturnListener returnListener = new ReturnCallbackListener(returnCallback);
         this.addReturnListener(returnListener);
         return returnListener;
     }
@@ -300,9 +339,19 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
         this.dispatcher.quiesce();
         broadcastShutdownSignal(getCloseReason());
 
+        List<CompletableFuture<Void>> confirms = new ArrayList<CompletableFuture<Void>>();
         synchronized (unconfirmedSet) {
+            unconfirmedSet.clear(confirms);
             unconfirmedSet.notifyAll();
         }
+        for (ReturnCorrelator.Correlated uncorrelated : returnCorrelator.clear()) {
+            if (uncorrelated.callListeners) {
+                callReturnCallbacks(uncorrelated.returned);
+            }
+        }
+        for (CompletableFuture<Void> confirm : confirms) {
+            confirm.completeExceptionally(getCloseReason());
+        }
     }
 
     /**
@@ -351,7 +400,9 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
             // We're in normal running mode.
 
             if (method instanceof Basic.Deliver) {
-                processDelivery(command, (Basic.Deliver) method);
+                if (!isContentBodyStreamed(command)) {
+                    processDelivery(command, (Basic.Deliver) method);
+                }
                 return true;
             } else if (method instanceof Basic.Return) {
                 callReturnListeners(command, (Basic.Return) method);
@@ -366,14 +417,26 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
                 return true;
             } else if (method instanceof Basic.Ack) {
                 Basic.Ack ack = (Basic.Ack) method;
+                correlateReturns(ack.getDeliveryTag(), ack.getMultiple());
                 callConfirmListeners(command, ack);
                 handleAckNack(ack.getDeliveryTag(), ack.getMultiple(), false);
                 return true;
             } else if (method instanceof Basic.Nack) {
                 Basic.Nack nack = (Basic.Nack) method;
+                correlateReturns(nack.getDeliveryTag(), nack.getMultiple());
                 callConfirmListeners(command, nack);
                 handleAckNack(nack.getDeliveryTag(), nack.getMultiple(), true);
                 return true;
+            } else if (method instanceof Basic.GetOk) {
+                // tracked here rather than when basicGet returns, so that
+                // the coalescer sees tags in the order the broker assigned them
+                messageReceived = true;
+                AckCoalescer coalescer = this.ackCoalescer;
+                if (coalescer != null) {
+                    coalescer.delivered(((Basic.GetOk) method).getDeliveryTag() + getDeliveryTagOffset(), false);
+                }
+                // still handled by the basic.get RPC continuation
+                return false;
             } else if (method instanceof Basic.RecoverOk) {
                 for (Map.Entry<String, Consumer> entry : Utility.copy(_consumers).entrySet()) {
                     this.dispatcher.handleRecoverOk(entry.getValue(), entry.getKey());
@@ -386,6 +449,10 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
                 Basic.Cancel m = (Basic.Cancel)method;
                 String consumerTag = m.getConsumerTag();
                 Consumer callback = _consumers.remove(consumerTag);
+                AckCoalescer coalescer = this.ackCoalescer;
+                if (coalescer != null) {
+                    coalescer.consumerCancelled(consumerTag);
+                }
                 if (callback == null) {
                     callback = defaultConsumer;
                 }
@@ -425,6 +492,30 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
         }
     }
 
+    /**
+     * Protected API - streams the body of deliveries to {@link StreamingConsumer}s,
+     * which are dispatched as soon as the content header is received.
+     */
+    @Override
+    protected void handleContentHeader(AMQCommand command) throws IOException {
+        Method method = command.getMethod();
+        if (method instanceof Basic.Deliver && isOpen()) {
+            Basic.Deliver deliver = (Basic.Deliver) method;
+            Consumer callback = _consumers.get(deliver.getConsumerTag());
+            if (callback == null) {
+                callback = defaultConsumer;
+            }
+            if (callback instanceof StreamingConsumer) {
+                command.streamContentBody(new ContentBodyInputStream(command.getContentHeader().getBodySize()));
+                processDelivery(command, deliver);
+            }
+        }
+    }
+
+    private static boolean isContentBodyStreamed(Command command) {
+        return command instanceof AMQCommand && ((AMQCommand) command).getContentBodyStream() != null;
+    }
+
     protected void processDelivery(Command command, Basic.Deliver method) {
         Basic.Deliver m = method;
 
@@ -447,16 +538,41 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
                                          m.getRedelivered(),
                                          m.getExchange(),
                                          m.getRoutingKey());
+        messageReceived = true;
+        AckCoalescer coalescer = this.ackCoalescer;
+        if (coalescer != null) {
+            coalescer.delivered(m.getDeliveryTag(), m.getConsumerTag());
+        }
         try {
             // call metricsCollector before the dispatching (which is async anyway)
             // this way, the message is inside the stats before it is handled
             // in case a manual ack in the callback, the stats will be able to record the ack
             metricsCollector.consumedMessage(this, m.getDeliveryTag(), m.getConsumerTag());
-            this.dispatcher.handleDelivery(callback,
-                                           m.getConsumerTag(),
-                                           envelope,
-                                           (BasicProperties) command.getContentHeader(),
-                                           command.getContentBody());
+            if (callback instanceof StreamingConsumer) {
+                ContentBodyInputStream stream = isContentBodyStreamed(command) ?
+                    ((AMQCommand) command).getContentBodyStream() : null;
+                this.dispatcher.handleDelivery((StreamingConsumer) callback,
+                                               m.getConsumerTag(),
+                                               envelope,
+                                               (BasicProperties) command.getContentHeader(),
+                                               stream != null ? stream : new ByteArrayInputStream(command.getContentBody()));
+            } else {
+                BasicProperties properties = (BasicProperties) command.getContentHeader();
+                byte[] body = command.getContentBody();
+                BodyEncoding decoding = bodyEncoding != null && bodyEncoding.isEncoded(properties) ? bodyEncoding : null;
+                if (decoding != null && !decoding.decodesOnDispatchThread()) {
+                    Delivery delivery = decoding.decode(envelope, properties, body);
+                    properties = delivery.getProperties();
+                    body = delivery.getBody();
+                    decoding = null;
+                }
+                this.dispatcher.handleDelivery(callback,
+                                               m.getConsumerTag(),
+                                               envelope,
+                                               properties,
+                                               body,
+                                               decoding);
+            }
         } catch (WorkPoolFullException e) {
             // couldn't enqueue in work pool, propagating
             throw e;
@@ -471,13 +587,31 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
 
     private void callReturnListeners(Command command, Basic.Return basicReturn) {
         try {
+            byte[] body = command.getContentBody();
+            Return returned = new Return(basicReturn.getReplyCode(),
+                basicReturn.getReplyText(),
+                basicReturn.getExchange(),
+                basicReturn.getRoutingKey(),
+                (BasicProperties) command.getContentHeader(),
+                body);
+            // the sequence number of the message is known with the confirm that follows the return
+            boolean correlated = nextPublishSeqNo > 0 && returnCorrelation;
+            if (correlated || (nextPublishSeqNo > 0 && returnCorrelator.size() > 0)) {
+                returnCorrelator.returned(returned, correlated);
+            }
             for (ReturnListener l : this.returnListeners) {
-                l.handleReturn(basicReturn.getReplyCode(),
-                    basicReturn.getReplyText(),
-                    basicReturn.getExchange(),
-                    basicReturn.getRoutingKey(),
-                    (BasicProperties) command.getContentHeader(),
-                    command.getContentBody());
+                if (l instanceof ReturnCallbackListener) {
+                    if (!correlated) {
+                        ((ReturnCallbackListener) l).handleReturn(returned);
+                    }
+                } else {
+                    l.handleReturn(basicReturn.getReplyCode(),
+                        basicReturn.getReplyText(),
+                        basicReturn.getExchange(),
+                        basicReturn.getRoutingKey(),
+                        (BasicProperties) command.getContentHeader(),
+                        body);
+                }
             }
         } catch (Throwable ex) {
             getConnection().getExceptionHandler().handleReturnListenerException(this, ex);
@@ -486,6 +620,35 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
         }
     }
 
+    /**
+     * Correlate the pending returns with a confirm, which identifies
+     * the returned messages.
+     * @see ReturnCorrelator
+     */
+    private void correlateReturns(long seqNo, boolean multiple) {
+        for (ReturnCorrelator.Correlated correlated : returnCorrelator.confirmed(seqNo, multiple, lastUncorrelatedMandatory)) {
+            long publishSeqNo = correlated.returned.getPublishSeqNo();
+            if (publishSeqNo > 0 && unconfirmedSet.hasAttachments()) {
+                handleReturn(publishSeqNo, correlated.returned);
+            }
+            if (correlated.callListeners) {
+                callReturnCallbacks(correlated.returned);
+            }
+        }
+    }
+
+    private void callReturnCallbacks(Return returned) {
+        try {
+            for (ReturnListener l : this.returnListeners) {
+                if (l instanceof ReturnCallbackListener) {
+                    ((ReturnCallbackListener) l).handleReturn(returned);
+                }
+            }
+        } catch (Throwable ex) {
+            getConnection().getExceptionHandler().handleReturnListenerException(this, ex);
+        }
+    }
+
     private void callConfirmListeners(@SuppressWarnings("unused") Command command, Basic.Ack ack) {
         try {
             for (ConfirmListener l : this.confirmListeners) {
@@ -580,6 +743,9 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
                       Throwable cause,
                       boolean abort)
         throws IOException, TimeoutException {
+        // Send acknowledgements the application expects to have been sent.
+        flushAcks(true);
+
         // First, notify all our dependents that we are shutting down.
         // This clears isOpen(), so no further work from the
         // application side will be accepted, and any inbound commands
@@ -641,6 +807,7 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
     public void basicQos(int prefetchSize, int prefetchCount, boolean global)
 	throws IOException
     {
+        disableAutomaticPrefetch();
 	exnWrappingRpc(new Basic.Qos(prefetchSize, prefetchCount, global));
     }
 
@@ -660,6 +827,122 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
 	basicQos(0, prefetchCount, false);
     }
 
+    /** Public API - {@inheritDoc} */
+    @Override
+    public void setAutomaticPrefetch(int minPrefetchCount, int maxPrefetchCount)
+        throws IOException
+    {
+        PrefetchController controller = new PrefetchController(minPrefetchCount, maxPrefetchCount, System.nanoTime());
+        disableAutomaticPrefetch();
+        long start = System.nanoTime();
+        exnWrappingRpc(new Basic.Qos(0, controller.getPrefetchCount(), true));
+        controller.adjusted(System.nanoTime() - start);
+        this.prefetchController = controller;
+        dispatcher.setPrefetchController(controller);
+    }
+
+    private void disableAutomaticPrefetch() {
+        this.prefetchController = null;
+        dispatcher.setPrefetchController(null);
+    }
+
+    /** Public API - {@inheritDoc} */
+    @Override
+    public void setAckCoalescing(int maxBatchSize, long maxDelayInMs)
+        throws IOException
+    {
+        AckCoalescer current = this.ackCoalescer;
+        if (current != null) {
+            this.ackCoalescer = null;
+            current.flush();
+        }
+        if (maxBatchSize > 1) {
+            if (!_consumers.isEmpty() || messageReceived) {
+                throw new IllegalStateException("Acknowledgement coalescing must be set before receiving messages");
+            }
+            this.ackCoalescer = new AckCoalescer(getDeliveryTagOffset() + 1, maxBatchSize,
+                TimeUnit.MILLISECONDS.toNanos(maxDelayInMs), this::transmitAck);
+        }
+    }
+
+    private void flushAcks(boolean ignoreErrors) throws IOException {
+        AckCoalescer coalescer = this.ackCoalescer;
+        if (coalescer != null) {
+            try {
+                coalescer.flush();
+            } catch (IOException | ShutdownSignalException e) {
+                if (!ignoreErrors) {
+                    throw e;
+                }
+            }
+        }
+    }
+
+    private void scheduleAckFlush(AckCoalescer coalescer, long delayNanos) {
+        try {
+            // the timer thread is shared by all the channels, it must not wait for the socket
+            getConnection().getChannelTimer().schedule(
+                () -> executeAckFlush(coalescer), delayNanos, TimeUnit.NANOSECONDS);
+        } catch (RejectedExecutionException e) {
+            // connection is shut down, acknowledgements are moot
+            ackFlushScheduled.set(false);
+        }
+    }
+
+    private void executeAckFlush(AckCoalescer coalescer) {
+        try {
+            getConnection().getChannelTaskExecutor().execute(() -> {
+                try {
+                    long nextDelay = coalescer.flushIfDue(System.nanoTime());
+                    if (nextDelay >= 0) {
+                        scheduleAckFlush(coalescer, nextDelay);
+                        return;
+                    }
+                } catch (IOException | ShutdownSignalException e) {
+                    LOGGER.debug("Could not send acknowledgements on channel {}", getChannelNumber(), e);
+                }
+                ackFlushScheduled.set(false);
+                // an acknowledgement may have been added while we were not looking
+                if (coalescer.hasPendingAcks() && isOpen() && ackFlushScheduled.compareAndSet(false, true)) {
+                    scheduleAckFlush(coalescer, coalescer.getMaxDelayNanos());
+                }
+            });
+        } catch (RejectedExecutionException e) {
+            ackFlushScheduled.set(false);
+        }
+    }
+
+    /**
+     * Feed an acknowledgement to the prefetch controller, if any,
+     * and apply a new prefetch count if it is time to.
+     */
+    private void acknowledged(long deliveryTag) {
+        PrefetchController controller = this.prefetchController;
+        if (controller != null) {
+            long now = System.nanoTime();
+            controller.acknowledged(deliveryTag, now);
+            int prefetchCount = controller.nextPrefetchCount(now);
+            if (prefetchCount > 0) {
+                try {
+                    asyncCompletableRpc(new Basic.Qos(0, prefetchCount, true)).whenComplete((command, ex) ->
+                        controller.adjusted(ex == null ? System.nanoTime() - now : -1));
+                } catch (IOException | ShutdownSignalException e) {
+                    controller.adjusted(-1);
+                    LOGGER.debug("Could not set prefetch count to {} on channel {}", prefetchCount, getChannelNumber(), e);
+                }
+            }
+        }
+    }
+
+    /** Public API - {@inheritDoc} */
+    @Override
+    public void setConsumerDispatchWeight(int weight) {
+        if (weight <= 0) {
+            throw new IllegalArgumentException("Dispatch weight must be strictly positive: " + weight);
+        }
+        dispatcher.setWeight(weight);
+    }
+
     /** Public API - {@inheritDoc} */
     @Override
     public void basicPublish(String exchange, String routingKey,
@@ -686,10 +969,118 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
                              BasicProperties props, byte[] body)
         throws IOException
     {
-        if (nextPublishSeqNo > 0) {
-            unconfirmedSet.add(getNextPublishSeqNo());
-            nextPublishSeqNo++;
+        publish(exchange, routingKey, mandatory, immediate, props, body, null);
+    }
+
+    /** Public API - {@inheritDoc} */
+    @Override
+    public void basicPublish(String exchange, String routingKey,
+                             boolean mandatory,
+                             BasicProperties props, InputStream body, long bodySize)
+        throws IOException
+    {
+        publish(exchange, routingKey, mandatory, props, ContentBodySource.of(body, bodySize));
+    }
+
+    /** Public API - {@inheritDoc} */
+    @Override
+    public void basicPublish(String exchange, String routingKey,
+                             boolean mandatory,
+                             BasicProperties props, FileChannel body, long position, long bodySize)
+        throws IOException
+    {
+        publish(exchange, routingKey, mandatory, props, ContentBodySource.of(body, position, bodySize));
+    }
+
+    /** Public API - {@inheritDoc} */
+    @Override
+    public <T> void basicPublish(String exchange, String routingKey,
+                                 boolean mandatory,
+                                 BasicProperties props, MessageCodec<T> codec, T message)
+        throws IOException
+    {
+        FragmentOutputStream body = new FragmentOutputStream(AMQCommand.streamedFragmentSize(getConnection().getFrameMax()));
+        codec.encode(message, body);
+        if (codec.getContentType() != null && (props == null || props.getContentType() == null)) {
+            props = (props == null ? new BasicProperties.Builder() : props.builder())
+                .contentType(codec.getContentType()).build();
+        }
+        if (bodyEncoding != null) {
+            // the body codec works on whole bodies
+            basicPublish(exchange, routingKey, mandatory, props, body.toByteArray());
+        } else {
+            publish(exchange, routingKey, mandatory, props, ContentBodySource.of(body.fragments(), body.size()));
+        }
+    }
+
+    /** Public API - {@inheritDoc} */
+    @Override
+    public CompletableFuture<Void> basicPublishAsync(String exchange, String routingKey,
+                                                     BasicProperties props, byte[] body)
+        throws IOException
+    {
+        return basicPublishAsync(exchange, routingKey, false, props, body);
+    }
+
+    /** Public API - {@inheritDoc} */
+    @Override
+    public CompletableFuture<Void> basicPublishAsync(String exchange, String routingKey,
+                                                     boolean mandatory,
+                                                     BasicProperties props, byte[] body)
+        throws IOException
+    {
+        if (nextPublishSeqNo == 0L)
+            throw new IllegalStateException("Confirms not selected");
+        long seqNo = nextPublishSeqNo;
+        CompletableFuture<Void> confirm = new CompletableFuture<Void>();
+        try {
+            publish(exchange, routingKey, mandatory, false, props, body, confirm);
+        } catch (IOException | RuntimeException e) {
+            // the caller gets the exception, not the future
+            unconfirmedSet.detach(seqNo);
+            throw e;
         }
+        return confirm;
+    }
+
+    /** Public API - {@inheritDoc} */
+    @Override
+    public PreparedPublish preparePublish(String exchange, String routingKey, boolean mandatory)
+        throws IOException
+    {
+        return new PublishTemplate(this, exchange, routingKey, mandatory);
+    }
+
+    /**
+     * Publish a message with pre-encoded frames.
+     * @see PublishTemplate
+     */
+    void publish(PublishTemplate template, BasicProperties props, byte[] body)
+        throws IOException
+    {
+        byte[] encoded = bodyEncoding == null ? null : bodyEncoding.encode(props, body);
+        if (encoded != null) {
+            props = bodyEncoding.encodedProperties(props);
+            body = encoded;
+        }
+        trackPublish(null);
+        trackReturn(template.isMandatory(), false);
+        transmitPublish(template.command(props, body));
+    }
+
+    private void publish(String exchange, String routingKey,
+                         boolean mandatory, boolean immediate,
+                         BasicProperties props, byte[] body,
+                         CompletableFuture<Void> confirm)
+        throws IOException
+    {
+        byte[] encoded = bodyEncoding == null ? null : bodyEncoding.encode(props, body);
+        if (encoded != null) {
+            props = bodyEncoding.encodedProperties(props);
+            body = encoded;
+        }
+        trackPublish(confirm);
+        trackReturn(mandatory, confirm != null);
         if (props == null) {
             props = MessageProperties.MINIMAL_BASIC;
         }
@@ -700,6 +1091,66 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
                 .mandatory(mandatory)
                 .immediate(immediate)
                 .build(), props, body);
+        transmitPublish(command);
+    }
+
+    /** Publish a message with a body read while it is transmitted. */
+    private void publish(String exchange, String routingKey,
+                         boolean mandatory,
+                         BasicProperties props, ContentBodySource body)
+        throws IOException
+    {
+        // fails before a sequence number is allocated if the source fails right away
+        body.prefetch(AMQCommand.streamedFragmentSize(getConnection().getFrameMax()));
+        trackPublish(null);
+        trackReturn(mandatory, false);
+        if (props == null) {
+            props = MessageProperties.MINIMAL_BASIC;
+        }
+        AMQCommand command = new AMQCommand(
+            new Basic.Publish.Builder()
+                .exchange(exchange)
+                .routingKey(routingKey)
+                .mandatory(mandatory)
+                .build(), props, body);
+        transmitPublish(command);
+    }
+
+    /** Allocate the sequence number of a message about to be published, in confirm mode. */
+    private void trackPublish(CompletableFuture<Void> confirm)
+        throws IOException
+    {
+        if (nextPublishSeqNo > 0) {
+            if (confirmWindow > 0) {
+                try {
+                    awaitConfirmWindow();
+                } catch (IOException e) {
+                    metricsCollector.basicPublishFailure(this, e);
+                    throw e;
+                }
+            }
+            unconfirmedSet.add(getNextPublishSeqNo(), confirm, recordConfirmLatency ? System.nanoTime() : 0L);
+            nextPublishSeqNo++;
+        }
+    }
+
+    /**
+     * Track a mandatory message just given a sequence number, to correlate its return,
+     * if return correlation is enabled or the message has a future to fail.
+     */
+    private void trackReturn(boolean mandatory, boolean async) {
+        if (mandatory && nextPublishSeqNo > 0) {
+            if (async || returnCorrelation) {
+                returnCorrelator.published(nextPublishSeqNo - 1);
+            } else {
+                lastUncorrelatedMandatory = nextPublishSeqNo - 1;
+            }
+        }
+    }
+
+    private void transmitPublish(AMQCommand command)
+        throws IOException
+    {
         try {
             transmit(command);
         } catch (IOException e) {
@@ -1153,15 +1604,26 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
 
         if (method instanceof Basic.GetOk) {
             Basic.GetOk getOk = (Basic.GetOk)method;
-            Envelope envelope = new Envelope(getOk.getDeliveryTag(),
+            long deliveryTag = getOk.getDeliveryTag() + getDeliveryTagOffset();
+            Envelope envelope = new Envelope(deliveryTag,
                                              getOk.getRedelivered(),
                                              getOk.getExchange(),
                                              getOk.getRoutingKey());
             BasicProperties props = (BasicProperties)replyCommand.getContentHeader();
             byte[] body = replyCommand.getContentBody();
             int messageCount = getOk.getMessageCount();
+            if (bodyEncoding != null && bodyEncoding.isEncoded(props)) {
+                Delivery delivery = bodyEncoding.decode(envelope, props, body);
+                props = delivery.getProperties();
+                body = delivery.getBody();
+            }
 
-            metricsCollector.consumedMessage(this, getOk.getDeliveryTag(), autoAck);
+            metricsCollector.consumedMessage(this, deliveryTag, autoAck);
+            AckCoalescer coalescer = this.ackCoalescer;
+            if (coalescer != null && autoAck) {
+                // tracked as unsettled when the get-ok was received
+                coalescer.autoAcked(deliveryTag);
+            }
 
             return new GetResponse(envelope, props, body, messageCount);
         } else if (method instanceof Basic.GetEmpty) {
@@ -1176,26 +1638,85 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
     public void basicAck(long deliveryTag, boolean multiple)
         throws IOException
     {
-        transmit(new Basic.Ack(deliveryTag, multiple));
+        AckCoalescer coalescer = this.ackCoalescer;
+        if (coalescer == null) {
+            transmitAck(deliveryTag, multiple);
+        } else if (coalescer.ack(deliveryTag, multiple, System.nanoTime())
+            && ackFlushScheduled.compareAndSet(false, true)) {
+            scheduleAckFlush(coalescer, coalescer.getMaxDelayNanos());
+        }
         metricsCollector.basicAck(this, deliveryTag, multiple);
+        acknowledged(deliveryTag);
     }
 
     /** Public API - {@inheritDoc} */
     @Override
-    public void basicNack(long deliveryTag, boolean multiple, boolean requeue)
+    public void basicNack(long deliveryTag, boolean multiple, final boolean requeue)
         throws IOException
     {
-        transmit(new Basic.Nack(deliveryTag, multiple, requeue));
+        AckCoalescer coalescer = this.ackCoalescer;
+        if (coalescer == null) {
+            transmitNack(deliveryTag, multiple, requeue);
+        } else {
+            coalescer.settle(deliveryTag, multiple, (tag, m) -> transmitNack(tag, m, requeue));
+        }
         metricsCollector.basicNack(this, deliveryTag);
+        acknowledged(deliveryTag);
     }
 
     /** Public API - {@inheritDoc} */
     @Override
-    public void basicReject(long deliveryTag, boolean requeue)
+    public void basicReject(long deliveryTag, final boolean requeue)
         throws IOException
     {
-        transmit(new Basic.Reject(deliveryTag, requeue));
+        AckCoalescer coalescer = this.ackCoalescer;
+        if (coalescer == null) {
+            transmitReject(deliveryTag, requeue);
+        } else {
+            coalescer.settle(deliveryTag, false, (tag, m) -> transmitReject(tag, requeue));
+        }
         metricsCollector.basicReject(this, deliveryTag);
+        acknowledged(deliveryTag);
+    }
+
+    /**
+     * Protected API - the offset between the delivery tags of the broker and
+     * the ones seen by the application.
+     * @return the offset, 0 unless tags are shifted after recovery
+     */
+    protected long getDeliveryTagOffset() {
+        return 0;
+    }
+
+    /**
+     * Protected API - send a <code>basic.ack</code>.
+     * @param deliveryTag the delivery tag, as seen by the application
+     * @param multiple true to acknowledge all messages up to and including the delivery tag
+     * @throws IOException if an error is encountered
+     */
+    protected void transmitAck(long deliveryTag, boolean multiple) throws IOException {
+        transmit(new Basic.Ack(deliveryTag, multiple));
+    }
+
+    /**
+     * Protected API - send a <code>basic.nack</code>.
+     * @param deliveryTag the delivery tag, as seen by the application
+     * @param multiple true to reject all messages up to and including the delivery tag
+     * @param requeue true if the rejected messages should be requeued
+     * @throws IOException if an error is encountered
+     */
+    protected void transmitNack(long deliveryTag, boolean multiple, boolean requeue) throws IOException {
+        transmit(new Basic.Nack(deliveryTag, multiple, requeue));
+    }
+
+    /**
+     * Protected API - send a <code>basic.reject</code>.
+     * @param deliveryTag the delivery tag, as seen by the application
+     * @param requeue true if the rejected message should be requeued
+     * @throws IOException if an error is encountered
+     */
+    protected void transmitReject(long deliveryTag, boolean requeue) throws IOException {
+        transmit(new Basic.Reject(deliveryTag, requeue));
     }
 
     /** Public API - {@inheritDoc} */
@@ -1246,6 +1767,12 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
         return basicConsume(queue, autoAck, "", consumerFromDeliverCancelCallbacks(deliverCallback, cancelCallback));
     }
 
+    /** Public API - {@inheritDoc} */
+    @Override
+    public <T> String basicConsume(String queue, boolean autoAck, MessageCodec<T> codec, TypedDeliverCallback<T> deliverCallback, CancelCallback cancelCallback) throws IOException {
+        return basicConsume(queue, autoAck, "", consumerFromTypedCallbacks(codec, deliverCallback, cancelCallback));
+    }
+
     @Override
     public String basicConsume(String queue, boolean autoAck, DeliverCallback deliverCallback, CancelCallback cancelCallback,
         ConsumerShutdownSignalCallback shutdownSignalCallback) throws IOException {
@@ -1352,6 +1879,10 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
             public String transformReply(AMQCommand replyCommand) {
                 String actualConsumerTag = ((Basic.ConsumeOk) replyCommand.getMethod()).getConsumerTag();
                 _consumers.put(actualConsumerTag, callback);
+                AckCoalescer coalescer = ackCoalescer;
+                if (coalescer != null) {
+                    coalescer.consumeOk(actualConsumerTag, autoAck);
+                }
 
                 // need to register consumer in stats before it actually starts consuming
                 metricsCollector.basicConsume(ChannelN.this, actualConsumerTag, autoAck);
@@ -1379,6 +1910,34 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
         }
     }
 
+    private <T> Consumer consumerFromTypedCallbacks(final MessageCodec<T> codec, final TypedDeliverCallback<T> deliverCallback,
+                                                    final CancelCallback cancelCallback) {
+        return new Consumer() {
+
+            @Override
+            public void handleConsumeOk(String consumerTag) { }
+
+            @Override
+            public void handleCancelOk(String consumerTag) { }
+
+            @Override
+            public void handleCancel(String consumerTag) throws IOException {
+                cancelCallback.handle(consumerTag);
+            }
+
+            @Override
+            public void handleShutdownSignal(String consumerTag, ShutdownSignalException sig) { }
+
+            @Override
+            public void handleRecoverOk(String consumerTag) { }
+
+            @Override
+            public void handleDelivery(String consumerTag, Envelope envelope, BasicProperties properties, byte[] body) throws IOException {
+                deliverCallback.handle(consumerTag, envelope, properties, codec.decode(properties, body));
+            }
+        };
+    }
+
     private Consumer consumerFromDeliverCancelCallbacks(final DeliverCallback deliverCallback, final CancelCallback cancelCallback) {
         return new Consumer() {
 
@@ -1476,6 +2035,10 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
                 if (!(replyCommand.getMethod() instanceof Basic.CancelOk))
                     LOGGER.warn("Received reply {} was not of expected method Basic.CancelOk", replyCommand.getMethod());
                 _consumers.remove(consumerTag); //may already have been removed
+                AckCoalescer coalescer = ackCoalescer;
+                if (coalescer != null) {
+                    coalescer.consumerCancelled(consumerTag);
+                }
                 dispatcher.handleCancelOk(originalConsumer, consumerTag);
                 return originalConsumer;
             }
@@ -1514,6 +2077,7 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
     public Basic.RecoverOk basicRecover(boolean requeue)
         throws IOException
     {
+        flushAcks(false);
         return (Basic.RecoverOk) exnWrappingRpc(new Basic.Recover(requeue)).getMethod();
     }
 
@@ -1559,6 +2123,57 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
         return nextPublishSeqNo;
     }
 
+    /** Public API - {@inheritDoc} */
+    @Override
+    public void setReturnCorrelation(boolean enabled) {
+        this.returnCorrelation = enabled;
+    }
+
+    /** Public API - {@inheritDoc} */
+    @Override
+    public void setConfirmWindow(int maxOutstandingConfirms, long timeoutInMs) {
+        if (maxOutstandingConfirms < 0) {
+            throw new IllegalArgumentException("Confirm window must be positive: " + maxOutstandingConfirms);
+        }
+        synchronized (unconfirmedSet) {
+            this.confirmWindow = maxOutstandingConfirms;
+            this.confirmWindowTimeoutInMs = timeoutInMs;
+            // the window may have grown
+            unconfirmedSet.notifyAll();
+        }
+    }
+
+    /**
+     * Wait until there is room in the confirm window.
+     * Woken up by {@link #handleAckNack(long, boolean, boolean)}.
+     */
+    private void awaitConfirmWindow() throws IOException {
+        synchronized (unconfirmedSet) {
+            long timeout = confirmWindowTimeoutInMs;
+            long deadline = System.nanoTime() + TimeUnit.MILLISECONDS.toNanos(Math.max(0, timeout));
+            int window;
+            while ((window = confirmWindow) > 0 && unconfirmedSet.size() >= window) {
+                if (getCloseReason() != null) {
+                    throw new AlreadyClosedException(getCloseReason());
+                }
+                try {
+                    if (timeout < 0) {
+                        unconfirmedSet.wait();
+                    } else {
+                        long remaining = deadline - System.nanoTime();
+                        if (remaining <= 0) {
+                            throw new ConfirmWindowFullException(window);
+                        }
+                        TimeUnit.NANOSECONDS.timedWait(unconfirmedSet, remaining);
+                    }
+                } catch (InterruptedException e) {
+                    Thread.currentThread().interrupt();
+                    throw new InterruptedIOException("Interrupted while waiting for confirms");
+                }
+            }
+        }
+    }
+
     @Override
     public void asyncRpc(Method method) throws IOException {
         transmit(method);
@@ -1590,16 +2205,45 @@ public class ChannelN extends AMQChannel implements com.rabbitmq.client.Channel
     }
 
     private void handleAckNack(long seqNo, boolean multiple, boolean nack) {
-        if (multiple) {
-            unconfirmedSet.headSet(seqNo + 1).clear();
-        } else {
-            unconfirmedSet.remove(seqNo);
-        }
+        List<CompletableFuture<Void>> confirms = null;
         synchronized (unconfirmedSet) {
+            if (unconfirmedSet.hasAttachments()) {
+                confirms = new ArrayList<CompletableFuture<Void>>();
+            }
+            if (recordConfirmLatency) {
+                confirmTime = System.nanoTime();
+            }
+            // latencies are recorded as the messages are removed
+            int confirmed = unconfirmedSet.remove(seqNo, multiple, confirms, confirmLatencyRecorder);
             onlyAcksReceived = onlyAcksReceived && !nack;
-            if (unconfirmedSet.isEmpty())
+            if (unconfirmedSet.isEmpty() || (confirmed > 0 && confirmWindow > 0))
                 unconfirmedSet.notifyAll();
         }
+        if (confirms != null) {
+            for (CompletableFuture<Void> confirm : confirms) {
+                if (nack) {
+                    confirm.completeExceptionally(new PublishRejectedException());
+                } else {
+                    confirm.complete(null);
+                }
+            }
+        }
+    }
+
+    private void reportConfirmLatency(long publishTime) {
+        metricsCollector.basicPublishConfirmLatency(this, confirmTime - publishTime, TimeUnit.NANOSECONDS);
+    }
+
+    /**
+     * Fail the future of a returned message, if it was published with
+     * {@link #basicPublishAsync(String, String, boolean, BasicProperties, byte[])}.
+     * The message stays unconfirmed until the broker acks it.
+     */
+    private void handleReturn(long publishSeqNo, Return returned) {
+        CompletableFuture<Void> confirm = unconfirmedSet.detach(publishSeqNo);
+        if (confirm != null) {
+            confirm.completeExceptionally(new PublishRejectedException(returned));
+        }
     }
 
     private static void validateQueueNameLength(String queue) {
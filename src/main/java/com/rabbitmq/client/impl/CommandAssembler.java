@@ -16,6 +16,7 @@
 package com.rabbitmq.client.impl;
 
 import java.io.IOException;
+import java.nio.ByteBuffer;
 import java.util.ArrayList;
 import java.util.List;
 
@@ -52,7 +53,19 @@ final class CommandAssembler {
     /** No bytes of content body not yet accumulated */
     private long remainingBodyBytes;
 
+    /** Where the content body goes instead of {@link #bodyN}, null to accumulate it */
+    private volatile ContentBodyInputStream bodyStream;
+
+    /** Cache to decode short strings with, null if there is none */
+    private final ShortStringCache shortStringCache;
+
     public CommandAssembler(Method method, AMQContentHeader contentHeader, byte[] body) {
+        this(method, contentHeader, body, null);
+    }
+
+    CommandAssembler(Method method, AMQContentHeader contentHeader, byte[] body,
+                     ShortStringCache shortStringCache) {
+        this.shortStringCache = shortStringCache;
         this.method = method;
         this.contentHeader = contentHeader;
         this.bodyN = new ArrayList<byte[]>(2);
@@ -77,6 +90,19 @@ final class CommandAssembler {
         return this.contentHeader;
     }
 
+    /**
+     * Streams the content body instead of accumulating it.
+     * @param stream the stream to append the fragments of the body to
+     */
+    synchronized void streamContentBody(ContentBodyInputStream stream) {
+        this.bodyStream = stream;
+    }
+
+    /** @return the stream the content body goes to, null if it is accumulated */
+    synchronized ContentBodyInputStream getContentBodyStream() {
+        return this.bodyStream;
+    }
+
     /** @return true if the command is complete */
     public synchronized boolean isComplete() {
         return (this.state == CAState.COMPLETE);
@@ -87,9 +113,13 @@ final class CommandAssembler {
         this.state = (this.remainingBodyBytes > 0) ? CAState.EXPECTING_CONTENT_BODY : CAState.COMPLETE;
     }
 
+    private ValueReader reader(Frame f) {
+        return new BufferValueReader(ByteBuffer.wrap(f.getPayload()), this.shortStringCache);
+    }
+
     private void consumeMethodFrame(Frame f) throws IOException {
         if (f.type == AMQP.FRAME_METHOD) {
-            this.method = AMQImpl.readMethodFrom(f.getInputStream());
+            this.method = AMQImpl.readMethodFrom(reader(f));
             this.state = this.method.hasContent() ? CAState.EXPECTING_CONTENT_HEADER : CAState.COMPLETE;
         } else {
             throw new UnexpectedFrameError(f, AMQP.FRAME_METHOD);
@@ -98,7 +128,7 @@ final class CommandAssembler {
 
     private void consumeHeaderFrame(Frame f) throws IOException {
         if (f.type == AMQP.FRAME_HEADER) {
-            this.contentHeader = AMQImpl.readContentHeaderFrom(f.getInputStream());
+            this.contentHeader = AMQImpl.readContentHeaderFrom(reader(f));
             this.remainingBodyBytes = this.contentHeader.getBodySize();
             updateContentBodyState();
         } else {
@@ -106,7 +136,8 @@ final class CommandAssembler {
         }
     }
 
-    private void consumeBodyFrame(Frame f) {
+    /** @return the fragment to append to {@link #bodyStream}, null if it is accumulated */
+    private byte[] consumeBodyFrame(Frame f) throws IOException {
         if (f.type == AMQP.FRAME_BODY) {
             byte[] fragment = f.getPayload();
             this.remainingBodyBytes -= fragment.length;
@@ -114,7 +145,11 @@ final class CommandAssembler {
             if (this.remainingBodyBytes < 0) {
                 throw new UnsupportedOperationException("%%%%%% FIXME unimplemented");
             }
+            if (this.bodyStream != null) {
+                return fragment;
+            }
             appendBodyFragment(fragment);
+            return null;
         } else {
             throw new UnexpectedFrameError(f, AMQP.FRAME_BODY);
         }
@@ -151,16 +186,27 @@ final class CommandAssembler {
      * @return true if command becomes complete
      * @throws IOException if error reading frame
      */
-    public synchronized boolean handleFrame(Frame f) throws IOException
+    public boolean handleFrame(Frame f) throws IOException
     {
-        switch (this.state) {
-          case EXPECTING_METHOD:          consumeMethodFrame(f); break;
-          case EXPECTING_CONTENT_HEADER:  consumeHeaderFrame(f); break;
-          case EXPECTING_CONTENT_BODY:    consumeBodyFrame(f);   break;
-
-          default:
-              throw new IllegalStateException("Bad Command State " + this.state);
+        byte[] streamed = null;
+        ContentBodyInputStream stream;
+        boolean complete;
+        synchronized (this) {
+            switch (this.state) {
+              case EXPECTING_METHOD:          consumeMethodFrame(f); break;
+              case EXPECTING_CONTENT_HEADER:  consumeHeaderFrame(f); break;
+              case EXPECTING_CONTENT_BODY:    streamed = consumeBodyFrame(f); break;
+
+              default:
+                  throw new IllegalStateException("Bad Command State " + this.state);
+            }
+            stream = this.bodyStream;
+            complete = isComplete();
+        }
+        if (streamed != null) {
+            // may wait for the consumer to read, so not while holding the lock
+            stream.append(streamed);
         }
-        return isComplete();
+        return complete;
     }
 }
@@ -0,0 +1,349 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import java.util.Arrays;
+import java.util.List;
+import java.util.function.LongConsumer;
+
+/**
+ * Set of the publish sequence numbers of a channel that have not been
+ * confirmed (ack'd or nack'd) by the broker yet.
+ * <p>
+ * Sequence numbers are allocated in increasing order and are confirmed
+ * roughly in the same order, so the set is a bitmap over the window
+ * between the lowest unconfirmed sequence number and the highest one.
+ * The bitmap is a ring of 64-bit words indexed by the sequence number itself,
+ * which grows when the window does not fit. Adding a sequence number
+ * is O(1) and confirming <code>k</code> of them with <code>multiple</code> set
+ * is O(k / 64), without allocating.
+ * <p>
+ * An attachment, e.g. a future to complete, can be associated with a sequence
+ * number. It is handed back when the sequence number is removed. Attachments
+ * are stored in an array indexed like the bitmap, allocated on first use.
+ * The time each sequence number was added can be recorded the same way, to
+ * compute confirm latencies.
+ * <p>
+ * This class is thread-safe. Its monitor can be used to wait for
+ * the set to be empty, it is not notified by this class.
+ */
+final class ConfirmTracker<T> {
+
+    /** Initial capacity, in sequence numbers, a power of two and a multiple of 64 */
+    private static final int INITIAL_CAPACITY = 1024;
+
+    /** Bit <code>n % 64</code> of word <code>(n / 64) % words.length</code> is set if <code>n</code> is unconfirmed */
+    private long[] words = new long[INITIAL_CAPACITY >>> 6];
+    /** Lowest sequence number that may be unconfirmed, all bits below are clear */
+    private long low = 0;
+    /** Highest sequence number that may be unconfirmed + 1, all bits from there are clear */
+    private long high = 0;
+    private int size = 0;
+
+    /** Attachments, indexed by <code>n % (64 * words.length)</code>, null until an attachment is added */
+    private Object[] attachments;
+    private int attachmentCount = 0;
+
+    private final boolean recordTimestamps;
+    /** Timestamps, indexed like attachments, null until a sequence number is added if they are recorded */
+    private long[] timestamps;
+
+    ConfirmTracker() {
+        this(false);
+    }
+
+    /**
+     * @param recordTimestamps whether to record when sequence numbers are added
+     */
+    ConfirmTracker(boolean recordTimestamps) {
+        this.recordTimestamps = recordTimestamps;
+    }
+
+    /**
+     * Add an unconfirmed sequence number.
+     * @param seqNo the sequence number
+     */
+    synchronized void add(long seqNo) {
+        add(seqNo, null, 0L);
+    }
+
+    /**
+     * Add an unconfirmed sequence number.
+     * @param seqNo the sequence number
+     * @param attachment attachment to associate with the sequence number, can be null
+     */
+    synchronized void add(long seqNo, T attachment) {
+        add(seqNo, attachment, 0L);
+    }
+
+    /**
+     * Add an unconfirmed sequence number.
+     * @param seqNo the sequence number
+     * @param attachment attachment to associate with the sequence number, can be null
+     * @param timestamp when the sequence number is added, in nanoseconds, ignored if timestamps are not recorded
+     */
+    synchronized void add(long seqNo, T attachment, long timestamp) {
+        if (size == 0) {
+            low = seqNo;
+            high = seqNo + 1;
+        } else if (seqNo < low || seqNo >= high) {
+            long newLow = Math.min(low, seqNo);
+            long newHigh = Math.max(high, seqNo + 1);
+            ensureCapacity(newLow, newHigh);
+            low = newLow;
+            high = newHigh;
+        }
+        int index = wordIndex(seqNo);
+        long bit = 1L << seqNo;
+        if ((words[index] & bit) == 0) {
+            words[index] |= bit;
+            size++;
+        }
+        if (attachment != null) {
+            if (attachments == null) {
+                attachments = new Object[words.length << 6];
+            }
+            int slot = slot(seqNo);
+            if (attachments[slot] == null) {
+                attachmentCount++;
+            }
+            attachments[slot] = attachment;
+        }
+        if (recordTimestamps) {
+            if (timestamps == null) {
+                timestamps = new long[words.length << 6];
+            }
+            timestamps[slot(seqNo)] = timestamp;
+        }
+    }
+
+    /**
+     * Remove confirmed sequence numbers.
+     * @param seqNo the sequence number
+     * @param multiple whether to remove all sequence numbers up to and including <code>seqNo</code>
+     * @return the number of sequence numbers removed
+     */
+    synchronized int remove(long seqNo, boolean multiple) {
+        return remove(seqNo, multiple, null, null);
+    }
+
+    /**
+     * Remove confirmed sequence numbers.
+     * @param seqNo the sequence number
+     * @param multiple whether to remove all sequence numbers up to and including <code>seqNo</code>
+     * @param removedAttachments where to add the attachments of the removed sequence numbers, can be null
+     * @return the number of sequence numbers removed
+     */
+    synchronized int remove(long seqNo, boolean multiple, List<T> removedAttachments) {
+        return remove(seqNo, multiple, removedAttachments, null);
+    }
+
+    /**
+     * Remove confirmed sequence numbers.
+     * @param seqNo the sequence number
+     * @param multiple whether to remove all sequence numbers up to and including <code>seqNo</code>
+     * @param removedAttachments where to add the attachments of the removed sequence numbers, can be null
+     * @param removedTimestamps called with the timestamp of each removed sequence number, can be null
+     * @return the number of sequence numbers removed
+     */
+    synchronized int remove(long seqNo, boolean multiple,
+                            List<T> removedAttachments, LongConsumer removedTimestamps) {
+        boolean visit = attachmentCount > 0 || (timestamps != null && removedTimestamps != null);
+        if (size == 0 || seqNo < low) {
+            return 0;
+        }
+        int removed = 0;
+        if (multiple) {
+            long last = Math.min(seqNo, high - 1);
+            long lastWord = last >>> 6;
+            for (long word = low >>> 6; word <= lastWord; word++) {
+                int index = (int) word & (words.length - 1);
+                long bits = words[index];
+                if (word == lastWord) {
+                    bits &= -1L >>> (63 - (last & 63));
+                }
+                removed += Long.bitCount(bits);
+                words[index] &= ~bits;
+                if (visit) {
+                    visit(word, bits, removedAttachments, removedTimestamps);
+                }
+            }
+            low = last + 1;
+        } else if (seqNo < high) {
+            int index = wordIndex(seqNo);
+            long bit = 1L << seqNo;
+            if ((words[index] & bit) != 0) {
+                words[index] &= ~bit;
+                removed = 1;
+                if (visit) {
+                    visit(seqNo >>> 6, bit, removedAttachments, removedTimestamps);
+                }
+            }
+        }
+        size -= removed;
+        skipConfirmed();
+        return removed;
+    }
+
+    /**
+     * @param seqNo the sequence number
+     * @return <code><b>true</b></code> if the sequence number is unconfirmed
+     */
+    synchronized boolean contains(long seqNo) {
+        return seqNo >= low && seqNo < high && (words[wordIndex(seqNo)] & (1L << seqNo)) != 0;
+    }
+
+    /**
+     * Remove the attachment of a sequence number, which stays unconfirmed.
+     * @param seqNo the sequence number
+     * @return the attachment, or null if there is none
+     */
+    synchronized T detach(long seqNo) {
+        if (attachmentCount == 0 || !contains(seqNo)) {
+            return null;
+        }
+        return detachSlot(slot(seqNo));
+    }
+
+    synchronized boolean hasAttachments() {
+        return attachmentCount > 0;
+    }
+
+    synchronized boolean isEmpty() {
+        return size == 0;
+    }
+
+    synchronized int size() {
+        return size;
+    }
+
+    /** Remove all sequence numbers. */
+    synchronized void clear() {
+        clear(null);
+    }
+
+    /**
+     * Remove all sequence numbers.
+     * @param removedAttachments where to add the attachments of the removed sequence numbers, can be null
+     */
+    synchronized void clear(List<T> removedAttachments) {
+        if (attachmentCount > 0) {
+            for (long seqNo = low; seqNo < high; seqNo++) {
+                T attachment = detachSlot(slot(seqNo));
+                if (attachment != null && removedAttachments != null) {
+                    removedAttachments.add(attachment);
+                }
+            }
+        }
+        Arrays.fill(words, 0L);
+        low = high;
+        size = 0;
+    }
+
+    /** Hand back the attachments and timestamps of the removed sequence numbers of a word. */
+    private void visit(long word, long bits, List<T> removedAttachments, LongConsumer removedTimestamps) {
+        while (bits != 0) {
+            long seqNo = (word << 6) + Long.numberOfTrailingZeros(bits);
+            bits &= bits - 1;
+            int slot = slot(seqNo);
+            if (attachmentCount > 0) {
+                T attachment = detachSlot(slot);
+                if (attachment != null && removedAttachments != null) {
+                    removedAttachments.add(attachment);
+                }
+            }
+            if (timestamps != null && removedTimestamps != null) {
+                removedTimestamps.accept(timestamps[slot]);
+            }
+        }
+    }
+
+    @SuppressWarnings("unchecked")
+    private T detachSlot(int slot) {
+        if (attachments == null) {
+            return null;
+        }
+        Object attachment = attachments[slot];
+        if (attachment != null) {
+            attachments[slot] = null;
+            attachmentCount--;
+        }
+        return (T) attachment;
+    }
+
+    /** Move {@link #low} to the lowest unconfirmed sequence number. */
+    private void skipConfirmed() {
+        if (size == 0) {
+            low = high;
+            return;
+        }
+        while (true) {
+            // shifts only use the 6 lowest bits of the sequence number
+            long bits = words[wordIndex(low)] & (-1L << low);
+            if (bits != 0) {
+                low = (low & ~63L) + Long.numberOfTrailingZeros(bits);
+                return;
+            }
+            low = (low | 63L) + 1;
+        }
+    }
+
+    /** Grow the ring so that it covers <code>[newLow, newHigh)</code>. */
+    private void ensureCapacity(long newLow, long newHigh) {
+        long span = ((newHigh - 1) >>> 6) - (newLow >>> 6) + 1;
+        if (span <= words.length) {
+            return;
+        }
+        int length = words.length;
+        while (length < span) {
+            if (length >= 1 << 24) {
+                throw new IllegalStateException("Too many unconfirmed messages: " + (newHigh - newLow));
+            }
+            length <<= 1;
+        }
+        long[] grown = new long[length];
+        for (long word = low >>> 6; word <= (high - 1) >>> 6; word++) {
+            grown[(int) word & (length - 1)] = words[(int) word & (words.length - 1)];
+        }
+        int slotMask = (length << 6) - 1;
+        if (attachments != null) {
+            Object[] grownAttachments = new Object[length << 6];
+            if (attachmentCount > 0) {
+                for (long seqNo = low; seqNo < high; seqNo++) {
+                    grownAttachments[(int) seqNo & slotMask] = attachments[slot(seqNo)];
+                }
+            }
+            attachments = grownAttachments;
+        }
+        if (timestamps != null) {
+            long[] grownTimestamps = new long[length << 6];
+            for (long seqNo = low; seqNo < high; seqNo++) {
+                grownTimestamps[(int) seqNo & slotMask] = timestamps[slot(seqNo)];
+            }
+            timestamps = grownTimestamps;
+        }
+        words = grown;
+    }
+
+    private int wordIndex(long seqNo) {
+        return (int) (seqNo >>> 6) & (words.length - 1);
+    }
+
+    /** Index of a sequence number in the attachment and timestamp arrays */
+    private int slot(long seqNo) {
+        return (int) seqNo & ((words.length << 6) - 1);
+    }
+}
@@ -15,6 +15,8 @@
 
 package com.rabbitmq.client.impl;
 
+import com.rabbitmq.client.BodyCodec;
+import com.rabbitmq.client.ConnectionFactory;
 import com.rabbitmq.client.ExceptionHandler;
 import com.rabbitmq.client.RecoveryDelayHandler;
 import com.rabbitmq.client.RecoveryDelayHandler.DefaultRecoveryDelayHandler;
@@ -50,6 +52,11 @@ public class ConnectionParams {
     private boolean channelShouldCheckRpcResponseType;
     private ErrorOnWriteListener errorOnWriteListener;
     private int workPoolTimeout = -1;
+    private boolean virtualThreadDispatch = false;
+    private BodyCodec bodyCodec;
+    private int bodyCodecThreshold = ConnectionFactory.DEFAULT_BODY_CODEC_THRESHOLD;
+    private int bodyCodecMaxDecodedSize = ConnectionFactory.DEFAULT_BODY_CODEC_MAX_DECODED_SIZE;
+    private boolean bodyDecodingOnDispatchThread = false;
     private TopologyRecoveryFilter topologyRecoveryFilter;
     private Predicate<ShutdownSignalException> connectionRecoveryTriggeringCondition;
     private RetryHandler topologyRecoveryRetryHandler;
@@ -243,6 +250,46 @@ public class ConnectionParams {
         return workPoolTimeout;
     }
 
+    public void setVirtualThreadDispatch(boolean virtualThreadDispatch) {
+        this.virtualThreadDispatch = virtualThreadDispatch;
+    }
+
+    public boolean isVirtualThreadDispatch() {
+        return virtualThreadDispatch;
+    }
+
+    public void setBodyCodec(BodyCodec bodyCodec) {
+        this.bodyCodec = bodyCodec;
+    }
+
+    public BodyCodec getBodyCodec() {
+        return bodyCodec;
+    }
+
+    public void setBodyCodecThreshold(int bodyCodecThreshold) {
+        this.bodyCodecThreshold = bodyCodecThreshold;
+    }
+
+    public int getBodyCodecThreshold() {
+        return bodyCodecThreshold;
+    }
+
+    public void setBodyCodecMaxDecodedSize(int bodyCodecMaxDecodedSize) {
+        this.bodyCodecMaxDecodedSize = bodyCodecMaxDecodedSize;
+    }
+
+    public int getBodyCodecMaxDecodedSize() {
+        return bodyCodecMaxDecodedSize;
+    }
+
+    public void setBodyDecodingOnDispatchThread(boolean bodyDecodingOnDispatchThread) {
+        this.bodyDecodingOnDispatchThread = bodyDecodingOnDispatchThread;
+    }
+
+    public boolean isBodyDecodingOnDispatchThread() {
+        return bodyDecodingOnDispatchThread;
+    }
+
     public void setTopologyRecoveryFilter(TopologyRecoveryFilter topologyRecoveryFilter) {
         this.topologyRecoveryFilter = topologyRecoveryFilter;
     }
@@ -18,11 +18,14 @@ package com.rabbitmq.client.impl;
 import com.rabbitmq.client.AMQP;
 import com.rabbitmq.client.Channel;
 import com.rabbitmq.client.Consumer;
+import com.rabbitmq.client.Delivery;
 import com.rabbitmq.client.Envelope;
 import com.rabbitmq.client.ShutdownSignalException;
+import com.rabbitmq.client.StreamingConsumer;
 import com.rabbitmq.utility.Utility;
 
 import java.io.IOException;
+import java.io.InputStream;
 import java.util.Map;
 import java.util.concurrent.CountDownLatch;
 
@@ -47,6 +50,8 @@ final class ConsumerDispatcher {
 
     private volatile ShutdownSignalException shutdownSignal = null;
 
+    private volatile PrefetchController prefetchController = null;
+
     public ConsumerDispatcher(AMQConnection connection,
                               Channel channel,
                               ConsumerWorkService workService) {
@@ -66,6 +71,14 @@ final class ConsumerDispatcher {
         this.workService.setUnlimited(channel, unlimited);
     }
 
+    public void setWeight(int weight) {
+        this.workService.setWeight(channel, weight);
+    }
+
+    public void setPrefetchController(PrefetchController prefetchController) {
+        this.prefetchController = prefetchController;
+    }
+
     public void handleConsumeOk(final Consumer delegate,
                                 final String consumerTag) {
         executeUnlessShuttingDown(
@@ -141,15 +154,80 @@ final class ConsumerDispatcher {
                                final Envelope envelope,
                                final AMQP.BasicProperties properties,
                                final byte[] body) throws IOException {
+        handleDelivery(delegate, consumerTag, envelope, properties, body, null);
+    }
+
+    /**
+     * Dispatches a delivery, decoding its body first on the dispatch thread
+     * if <code>decoding</code> is not null.
+     */
+    public void handleDelivery(final Consumer delegate,
+                               final String consumerTag,
+                               final Envelope envelope,
+                               final AMQP.BasicProperties properties,
+                               final byte[] body,
+                               final BodyEncoding decoding) throws IOException {
         executeUnlessShuttingDown(
         new Runnable() {
             @Override
             public void run() {
+                PrefetchController controller = ConsumerDispatcher.this.prefetchController;
+                long start = controller == null ? 0 : System.nanoTime();
+                try {
+                    if (decoding != null) {
+                        Delivery delivery = decoding.decode(envelope, properties, body);
+                        delegate.handleDelivery(consumerTag,
+                                envelope,
+                                delivery.getProperties(),
+                                delivery.getBody());
+                    } else {
+                        delegate.handleDelivery(consumerTag,
+                                envelope,
+                                properties,
+                                body);
+                    }
+                    if (controller != null) {
+                        controller.delivered(envelope.getDeliveryTag(), start, System.nanoTime());
+                    }
+                } catch (Throwable ex) {
+                    connection.getExceptionHandler().handleConsumerException(
+                            channel,
+                            ex,
+                            delegate,
+                            consumerTag,
+                            "handleDelivery");
+                }
+            }
+        });
+    }
+
+    /**
+     * Dispatches a delivery to a streaming consumer. The body is closed once the
+     * consumer returns, or right away if the delivery is not dispatched, so that
+     * the thread reading frames never waits for a body nobody reads.
+     */
+    public void handleDelivery(final StreamingConsumer delegate,
+                               final String consumerTag,
+                               final Envelope envelope,
+                               final AMQP.BasicProperties properties,
+                               final InputStream body) throws IOException {
+        if (this.shuttingDown) {
+            body.close();
+            return;
+        }
+        Runnable delivery = new Runnable() {
+            @Override
+            public void run() {
+                PrefetchController controller = ConsumerDispatcher.this.prefetchController;
+                long start = controller == null ? 0 : System.nanoTime();
                 try {
                     delegate.handleDelivery(consumerTag,
                             envelope,
                             properties,
                             body);
+                    if (controller != null) {
+                        controller.delivered(envelope.getDeliveryTag(), start, System.nanoTime());
+                    }
                 } catch (Throwable ex) {
                     connection.getExceptionHandler().handleConsumerException(
                             channel,
@@ -157,9 +235,21 @@ final class ConsumerDispatcher {
                             delegate,
                             consumerTag,
                             "handleDelivery");
+                } finally {
+                    try {
+                        body.close();
+                    } catch (IOException ignored) {
+                        // the body is in memory or discarded from now on
+                    }
                 }
             }
-        });
+        };
+        try {
+            execute(delivery);
+        } catch (RuntimeException e) {
+            body.close();
+            throw e;
+        }
     }
 
     public CountDownLatch handleShutdownSignal(final Map<String, Consumer> consumers,
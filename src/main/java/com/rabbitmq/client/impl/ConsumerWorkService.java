@@ -15,6 +15,7 @@
 
 package com.rabbitmq.client.impl;
 
+import java.lang.reflect.Method;
 import java.util.ArrayList;
 import java.util.List;
 import java.util.concurrent.ExecutorService;
@@ -22,8 +23,11 @@ import java.util.concurrent.Executors;
 import java.util.concurrent.ThreadFactory;
 
 import com.rabbitmq.client.Channel;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
 
 final public class ConsumerWorkService {
+    private static final Logger LOGGER = LoggerFactory.getLogger(ConsumerWorkService.class);
     private static final int MAX_RUNNABLE_BLOCK_SIZE = 16;
     private static final int DEFAULT_NUM_THREADS = Runtime.getRuntime().availableProcessors() * 2;
     private final ExecutorService executor;
@@ -31,18 +35,53 @@ final public class ConsumerWorkService {
     private final WorkPool<Channel, Runnable> workPool;
     private final int shutdownTimeout;
 
-    public ConsumerWorkService(ExecutorService executor, ThreadFactory threadFactory, int queueingTimeout, int shutdownTimeout) {
+    public ConsumerWorkService(ExecutorService executor, ThreadFactory threadFactory, int queueingTimeout, int shutdownTimeout,
+                               boolean virtualThreadDispatch) {
         this.privateExecutor = (executor == null);
-        this.executor = (executor == null) ? Executors.newFixedThreadPool(DEFAULT_NUM_THREADS, threadFactory)
+        this.executor = (executor == null) ? privateExecutor(threadFactory, virtualThreadDispatch)
                                            : executor;
         this.workPool = new WorkPool<>(queueingTimeout);
         this.shutdownTimeout = shutdownTimeout;
     }
 
+    public ConsumerWorkService(ExecutorService executor, ThreadFactory threadFactory, int queueingTimeout, int shutdownTimeout) {
+        this(executor, threadFactory, queueingTimeout, shutdownTimeout, false);
+    }
+
     public ConsumerWorkService(ExecutorService executor, ThreadFactory threadFactory, int shutdownTimeout) {
         this(executor, threadFactory, -1, shutdownTimeout);
     }
 
+    private static ExecutorService privateExecutor(ThreadFactory threadFactory, boolean virtualThreadDispatch) {
+        if (virtualThreadDispatch) {
+            ExecutorService executor = newVirtualThreadPerTaskExecutor();
+            if (executor != null) {
+                return executor;
+            }
+        }
+        return Executors.newFixedThreadPool(DEFAULT_NUM_THREADS, threadFactory);
+    }
+
+    /**
+     * Create an executor starting a new virtual thread for each task.
+     * Each task processes a block of work for a single channel, and the
+     * {@link WorkPool} never hands out work for a channel that is already
+     * in progress, so per-channel ordering is kept.
+     * Looked up reflectively as virtual threads are not available on all supported JVMs.
+     * @return the executor, or <code>null</code> if the JVM does not support virtual threads
+     */
+    static ExecutorService newVirtualThreadPerTaskExecutor() {
+        try {
+            Method factoryMethod = Executors.class.getMethod("newVirtualThreadPerTaskExecutor");
+            return (ExecutorService) factoryMethod.invoke(null);
+        } catch (NoSuchMethodException e) {
+            LOGGER.debug("Virtual threads not supported by this JVM, using a thread pool for consumer dispatch");
+        } catch (Exception e) {
+            LOGGER.warn("Could not create virtual thread executor, using a thread pool for consumer dispatch", e);
+        }
+        return null;
+    }
+
     public int getShutdownTimeout() {
         return shutdownTimeout;
     }
@@ -76,6 +115,16 @@ final public class ConsumerWorkService {
         }
     }
 
+    /**
+     * Set the share of the dispatch threads a channel gets when
+     * several channels have consumer work pending.
+     * @param channel the channel
+     * @param weight strictly positive weight, default is 1
+     */
+    public void setWeight(Channel channel, int weight) {
+        this.workPool.setWeight(channel, weight);
+    }
+
     public void addWork(Channel channel, Runnable runnable) {
         if (this.workPool.addWorkItem(channel, runnable)) {
             this.executor.execute(new WorkPoolRunnable());
@@ -0,0 +1,175 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.InterruptedIOException;
+import java.util.ArrayDeque;
+
+/**
+ * Content body handed to a {@link com.rabbitmq.client.StreamingConsumer},
+ * fed with the payload of body frames as the thread reading frames receives them.
+ * <p>
+ * At most {@link #CAPACITY} fragments wait to be read: the thread reading frames
+ * waits for the consumer to read before appending more, so memory stays bounded
+ * whatever the size of the body. Once the stream is closed, the rest of the body
+ * is discarded without waiting.
+ */
+final class ContentBodyInputStream extends InputStream {
+
+    /** Maximum number of fragments waiting to be read */
+    static final int CAPACITY = 8;
+
+    private final ArrayDeque<byte[]> fragments = new ArrayDeque<byte[]>(CAPACITY);
+    /** Number of bytes not appended yet */
+    private long remaining;
+    /** Fragment being read, null if none */
+    private byte[] current;
+    private int position;
+    private boolean closed = false;
+    /** Why the body will never be complete, null if it is not known */
+    private IOException failure;
+
+    /**
+     * @param bodySize the size of the body, from the content header
+     */
+    ContentBodyInputStream(long bodySize) {
+        this.remaining = bodySize;
+    }
+
+    /**
+     * Appends a fragment of the body, waiting while the stream is full.
+     * Called by the thread reading frames.
+     */
+    synchronized void append(byte[] fragment) throws InterruptedIOException {
+        while (fragments.size() >= CAPACITY && !closed && failure == null) {
+            try {
+                wait();
+            } catch (InterruptedException e) {
+                Thread.currentThread().interrupt();
+                throw new InterruptedIOException("Interrupted while waiting for the content body to be read");
+            }
+        }
+        remaining -= fragment.length;
+        if (!closed && failure == null && fragment.length > 0) {
+            fragments.add(fragment);
+        }
+        notifyAll();
+    }
+
+    /**
+     * Makes reads fail once the fragments received so far have been read,
+     * e.g. when the channel closes before the end of the body.
+     */
+    synchronized void abort(IOException cause) {
+        if (failure == null) {
+            failure = cause;
+        }
+        notifyAll();
+    }
+
+    @Override
+    public int read() throws IOException {
+        byte[] single = new byte[1];
+        int read = read(single, 0, 1);
+        return read < 0 ? -1 : single[0] & 0xff;
+    }
+
+    @Override
+    public synchronized int read(byte[] b, int off, int len) throws IOException {
+        if (off < 0 || len < 0 || len > b.length - off) {
+            throw new IndexOutOfBoundsException();
+        }
+        if (closed) {
+            throw new IOException("Stream closed");
+        }
+        if (len == 0) {
+            return 0;
+        }
+        if (!nextFragment()) {
+            return -1;
+        }
+        int read = Math.min(len, current.length - position);
+        System.arraycopy(current, position, b, off, read);
+        position += read;
+        return read;
+    }
+
+    @Override
+    public synchronized long skip(long n) throws IOException {
+        if (closed) {
+            throw new IOException("Stream closed");
+        }
+        if (n <= 0 || !nextFragment()) {
+            return 0;
+        }
+        int skipped = (int) Math.min(n, current.length - position);
+        position += skipped;
+        return skipped;
+    }
+
+    @Override
+    public synchronized int available() throws IOException {
+        if (closed) {
+            throw new IOException("Stream closed");
+        }
+        int available = current == null ? 0 : current.length - position;
+        for (byte[] fragment : fragments) {
+            available += fragment.length;
+        }
+        return available;
+    }
+
+    @Override
+    public synchronized void close() {
+        closed = true;
+        current = null;
+        fragments.clear();
+        notifyAll();
+    }
+
+    /**
+     * Makes {@link #current} a fragment with bytes left to read, waiting for one if needed.
+     * @return false at the end of the body
+     */
+    private boolean nextFragment() throws IOException {
+        while (current == null || position == current.length) {
+            byte[] next = fragments.poll();
+            if (next != null) {
+                current = next;
+                position = 0;
+                // room for the next fragment
+                notifyAll();
+            } else if (remaining == 0) {
+                return false;
+            } else if (failure != null) {
+                throw new IOException("Content body incomplete", failure);
+            } else {
+                try {
+                    wait();
+                } catch (InterruptedException e) {
+                    Thread.currentThread().interrupt();
+                    throw new InterruptedIOException("Interrupted while waiting for the content body");
+                }
+                if (closed) {
+                    throw new IOException("Stream closed");
+                }
+            }
+        }
+        return true;
+    }
+}
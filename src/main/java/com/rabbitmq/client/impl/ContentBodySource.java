@@ -0,0 +1,175 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client.impl;
+
+import java.io.EOFException;
+import java.io.IOException;
+import java.io.InputStream;
+import java.nio.ByteBuffer;
+import java.nio.channels.FileChannel;
+import java.util.Iterator;
+import java.util.List;
+
+/**
+ * Content body of an outbound message handed over while it is transmitted,
+ * one body frame at a time, instead of being held in memory as a whole.
+ * @see AMQCommand#transmit(AMQChannel)
+ */
+abstract class ContentBodySource {
+
+    private final long size;
+    /** Fragment read ahead, null if none */
+    private byte[] prefetched;
+
+    private ContentBodySource(long size) {
+        if (size < 0) {
+            throw new IllegalArgumentException("Body size must be positive or zero: " + size);
+        }
+        this.size = size;
+    }
+
+    /** @return the size of the body, declared in the content header */
+    final long size() {
+        return this.size;
+    }
+
+    /**
+     * Reads the first fragment ahead, so that a source failing right away
+     * fails before anything is sent. Does nothing if it is already read.
+     * @param maxLength the maximum size of a fragment
+     * @throws IOException if the source fails or ends before the declared size
+     */
+    final void prefetch(int maxLength) throws IOException {
+        if (this.prefetched == null) {
+            this.prefetched = nextFragment(maxLength);
+        }
+    }
+
+    /**
+     * @param maxLength the maximum size of a fragment
+     * @return the next fragment of the body, null at the end of the body
+     * @throws IOException if the source fails or ends before the declared size
+     */
+    final byte[] nextFragment(int maxLength) throws IOException {
+        if (this.prefetched != null) {
+            byte[] fragment = this.prefetched;
+            this.prefetched = null;
+            return fragment;
+        }
+        return readFragment(maxLength);
+    }
+
+    /**
+     * @param maxLength the maximum size of a fragment
+     * @return the fragment after the ones already returned, null at the end of the body
+     * @throws IOException if the source fails or ends before the declared size
+     */
+    abstract byte[] readFragment(int maxLength) throws IOException;
+
+    /**
+     * @param in the stream to read the body from, from its current position
+     * @param size the number of bytes to read from the stream
+     */
+    static ContentBodySource of(final InputStream in, long size) {
+        return new Reading(size) {
+
+            @Override
+            void read(byte[] fragment) throws IOException {
+                int offset = 0;
+                while (offset < fragment.length) {
+                    int read = in.read(fragment, offset, fragment.length - offset);
+                    if (read < 0) {
+                        throw new EOFException("Content body stream ended before the declared body size");
+                    }
+                    offset += read;
+                }
+            }
+        };
+    }
+
+    /**
+     * @param channel the file to read the body from, its position is not changed
+     * @param position the position of the body in the file
+     * @param size the number of bytes to read from the file
+     */
+    static ContentBodySource of(final FileChannel channel, final long position, long size) {
+        if (position < 0) {
+            throw new IllegalArgumentException("Position must be positive or zero: " + position);
+        }
+        return new Reading(size) {
+
+            private long next = position;
+
+            @Override
+            void read(byte[] fragment) throws IOException {
+                ByteBuffer buffer = ByteBuffer.wrap(fragment);
+                while (buffer.hasRemaining()) {
+                    int read = channel.read(buffer, next);
+                    if (read < 0) {
+                        throw new EOFException("Content body file ended before the declared body size");
+                    }
+                    next += read;
+                }
+            }
+        };
+    }
+
+    /**
+     * @param fragments the fragments of the body, each one no bigger than the frames
+     * @param size the size of the body, the sum of the sizes of the fragments
+     */
+    static ContentBodySource of(List<byte[]> fragments, long size) {
+        final Iterator<byte[]> iterator = fragments.iterator();
+        return new ContentBodySource(size) {
+
+            @Override
+            byte[] readFragment(int maxLength) {
+                return iterator.hasNext() ? iterator.next() : null;
+            }
+        };
+    }
+
+    /** Source reading the body into fragments of the maximum size. */
+    private abstract static class Reading extends ContentBodySource {
+
+        /** Number of bytes not read yet */
+        private long remaining;
+
+        Reading(long size) {
+            super(size);
+            this.remaining = size;
+        }
+
+        @Override
+        final byte[] readFragment(int maxLength) throws IOException {
+            if (this.remaining == 0) {
+                return null;
+            }
+            byte[] fragment = new byte[(int) Math.min(this.remaining, maxLength)];
+            read(fragment);
+            this.remaining -= fragment.length;
+            return fragment;
+        }
+
+        /**
+         * Reads the next bytes of the body.
+         * @param fragment the array to fill entirely
+         * @throws IOException if the source fails or ends before the declared size
+         */
+        abstract void read(byte[] fragment) throws IOException;
+    }
+}
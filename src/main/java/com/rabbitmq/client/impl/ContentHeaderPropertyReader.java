@@ -43,7 +43,14 @@ public class ContentHeaderPropertyReader {
      * Protected API - Constructs a reader from the given input stream
      */
     public ContentHeaderPropertyReader(DataInputStream in) throws IOException {
-        this.in = new ValueReader(in);
+        this(new ValueReader(in));
+    }
+
+    /**
+     * Protected API - Constructs a reader from the given value reader
+     */
+    public ContentHeaderPropertyReader(ValueReader in) throws IOException {
+        this.in = in;
         this.flagWord = 1; // just the continuation bit
         this.bitCount = 15; // forces a flagWord read
     }
@@ -103,9 +110,13 @@ public class ContentHeaderPropertyReader {
         return in.readLonglong();
     }
 
-    /** Reads and returns an AMQP table content header field. */
+    /**
+     * Reads and returns an AMQP table content header field.
+     * The table is decoded when accessed: consumers that do not
+     * read the headers of messages do not pay for it.
+     */
     public Map<String, Object> readTable() throws IOException {
-        return in.readTable();
+        return in.readLazyTable();
     }
 
     /** Reads and returns an AMQP octet content header field. */
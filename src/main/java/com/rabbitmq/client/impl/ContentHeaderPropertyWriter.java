@@ -42,7 +42,14 @@ public class ContentHeaderPropertyWriter {
      * Constructs a fresh ContentHeaderPropertyWriter.
      */
     public ContentHeaderPropertyWriter(DataOutputStream out) {
-        this.out = new ValueWriter(out);
+        this(new ValueWriter(out));
+    }
+
+    /**
+     * Constructs a fresh ContentHeaderPropertyWriter writing to a value writer.
+     */
+    public ContentHeaderPropertyWriter(ValueWriter out) {
+        this.out = out;
         this.flagWord = 0;
         this.bitCount = 0;
     }
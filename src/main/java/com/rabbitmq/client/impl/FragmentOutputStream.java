@@ -0,0 +1,119 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client.impl;
+
+import java.io.OutputStream;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+
+/**
+ * Stream encoding a content body directly into fragments of the size of
+ * body frames, which become the payloads of the frames. Unlike a
+ * {@link java.io.ByteArrayOutputStream}, the body is not copied into a
+ * single array, only the last fragment is trimmed to its size.
+ */
+final class FragmentOutputStream extends OutputStream {
+
+    private static final int INITIAL_CAPACITY = 256;
+
+    private final int fragmentSize;
+    /** Full fragments */
+    private final List<byte[]> fragments = new ArrayList<byte[]>(1);
+    /** Fragment being written, grown up to the fragment size */
+    private byte[] current;
+    private int position = 0;
+    private long size = 0;
+
+    /**
+     * @param fragmentSize the size of the fragments, the maximum payload of a body frame
+     */
+    FragmentOutputStream(int fragmentSize) {
+        this.fragmentSize = fragmentSize;
+        this.current = new byte[Math.min(INITIAL_CAPACITY, fragmentSize)];
+    }
+
+    @Override
+    public void write(int b) {
+        ensureRoom();
+        current[position++] = (byte) b;
+        size++;
+    }
+
+    @Override
+    public void write(byte[] b, int off, int len) {
+        if (off < 0 || len < 0 || len > b.length - off) {
+            throw new IndexOutOfBoundsException();
+        }
+        while (len > 0) {
+            ensureRoom();
+            int length = Math.min(len, current.length - position);
+            System.arraycopy(b, off, current, position, length);
+            position += length;
+            off += length;
+            len -= length;
+            size += length;
+        }
+    }
+
+    /** @return the number of bytes written */
+    long size() {
+        return size;
+    }
+
+    /**
+     * @return the fragments of the body, all of them of the fragment size but the last one
+     */
+    List<byte[]> fragments() {
+        List<byte[]> result = new ArrayList<byte[]>(fragments.size() + 1);
+        result.addAll(fragments);
+        if (position > 0) {
+            result.add(position == current.length ? current : Arrays.copyOf(current, position));
+        }
+        return result;
+    }
+
+    /** @return the body in a single array */
+    byte[] toByteArray() {
+        if (fragments.isEmpty()) {
+            return Arrays.copyOf(current, position);
+        }
+        byte[] body = new byte[(int) size];
+        int offset = 0;
+        for (byte[] fragment : fragments) {
+            System.arraycopy(fragment, 0, body, offset, fragment.length);
+            offset += fragment.length;
+        }
+        System.arraycopy(current, 0, body, offset, position);
+        return body;
+    }
+
+    /** Makes room in {@link #current} for at least one byte. */
+    private void ensureRoom() {
+        if (position < current.length) {
+            return;
+        }
+        if (current.length < fragmentSize) {
+            current = Arrays.copyOf(current, (int) Math.min((long) current.length * 2, fragmentSize));
+        } else {
+            fragments.add(current);
+            // the body is big, the next fragment is likely to be full
+            current = new byte[fragmentSize];
+            position = 0;
+        }
+    }
+}
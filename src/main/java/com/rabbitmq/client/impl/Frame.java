@@ -336,13 +336,13 @@ public class Frame {
     private static int longStrSize(String str)
         throws UnsupportedEncodingException
     {
-        return str.getBytes("utf-8").length + 4;
+        return BufferValueWriter.utf8Length(str) + 4;
     }
 
     /** Computes the AMQP wire-protocol length of a protocol-encoded short string. */
     private static int shortStrSize(String str)
         throws UnsupportedEncodingException
     {
-        return str.getBytes("utf-8").length + 1;
+        return BufferValueWriter.utf8Length(str) + 1;
     }
 }
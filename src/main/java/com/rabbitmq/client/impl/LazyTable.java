@@ -0,0 +1,231 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import com.rabbitmq.client.MalformedFrameException;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
+import java.util.AbstractMap;
+import java.util.Map;
+import java.util.Set;
+
+/**
+ * Table backed by its encoded bytes, decoded on demand.
+ * <p>
+ * {@link #get(Object)} and {@link #containsKey(Object)} scan the bytes and decode only
+ * the value of the requested key. Any other operation decodes the whole table
+ * into a {@link java.util.HashMap}, which backs the table from then on, modifications included.
+ * <p>
+ * The structure of the bytes is validated on creation, so that malformed tables
+ * are still detected when the frame is read.
+ */
+final class LazyTable extends AbstractMap<String, Object> {
+
+    private final byte[] bytes;
+    private final int start;
+    private final int end;
+    private Map<String, Object> decoded;
+
+    /**
+     * @param bytes the entries of the table, without the length prefix
+     * @throws MalformedFrameException if the bytes are not a valid table
+     */
+    LazyTable(byte[] bytes) throws MalformedFrameException {
+        this(bytes, 0, bytes.length);
+    }
+
+    /**
+     * @param bytes array holding the entries of the table, e.g. a frame payload, it must not be modified
+     * @param offset offset of the entries, after the length prefix
+     * @param length length of the entries
+     * @throws MalformedFrameException if the bytes are not a valid table
+     */
+    LazyTable(byte[] bytes, int offset, int length) throws MalformedFrameException {
+        this.bytes = bytes;
+        this.start = offset;
+        this.end = offset + length;
+        validate(bytes, start, end, true);
+    }
+
+    @Override
+    public Object get(Object key) {
+        Map<String, Object> table = decodedIfAny();
+        if (table != null) {
+            return table.get(key);
+        }
+        int offset = valueOffset(key);
+        return offset < 0 ? null : decodeValue(offset);
+    }
+
+    @Override
+    public boolean containsKey(Object key) {
+        Map<String, Object> table = decodedIfAny();
+        if (table != null) {
+            return table.containsKey(key);
+        }
+        return valueOffset(key) >= 0;
+    }
+
+    @Override
+    public Object put(String key, Object value) {
+        return decoded().put(key, value);
+    }
+
+    @Override
+    public Object remove(Object key) {
+        return decoded().remove(key);
+    }
+
+    @Override
+    public void clear() {
+        decoded().clear();
+    }
+
+    @Override
+    public int size() {
+        return decoded().size();
+    }
+
+    @Override
+    public Set<Entry<String, Object>> entrySet() {
+        return decoded().entrySet();
+    }
+
+    private synchronized Map<String, Object> decodedIfAny() {
+        return decoded;
+    }
+
+    private synchronized Map<String, Object> decoded() {
+        if (decoded == null) {
+            try {
+                decoded = reader(start).readTableEntries(end);
+            } catch (IOException e) {
+                // cannot happen, the bytes have been validated
+                throw new IllegalStateException("Could not decode table", e);
+            }
+        }
+        return decoded;
+    }
+
+    /**
+     * @return the offset of the type of the value of the first entry with the key, -1 if there is none
+     */
+    private int valueOffset(Object key) {
+        if (!(key instanceof String)) {
+            return -1;
+        }
+        byte[] name = ((String) key).getBytes(StandardCharsets.UTF_8);
+        int offset = start;
+        while (offset < end) {
+            int nameLength = bytes[offset] & 0xff;
+            int nameOffset = offset + 1;
+            offset = nameOffset + nameLength;
+            if (nameLength == name.length && regionEquals(name, nameOffset)) {
+                return offset;
+            }
+            offset = skipValue(bytes, offset, end);
+        }
+        return -1;
+    }
+
+    private boolean regionEquals(byte[] name, int offset) {
+        for (int i = 0; i < name.length; i++) {
+            if (bytes[offset + i] != name[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    private Object decodeValue(int offset) {
+        try {
+            return reader(offset).readFieldValue();
+        } catch (IOException e) {
+            // cannot happen, the bytes have been validated
+            throw new IllegalStateException("Could not decode table value", e);
+        }
+    }
+
+    /** Long strings read by the reader are slices of {@link #bytes}. */
+    private BufferValueReader reader(int offset) {
+        return new BufferValueReader(ByteBuffer.wrap(bytes, offset, end - offset));
+    }
+
+    /**
+     * Check the bytes are a sequence of table entries, or of array values.
+     */
+    private static void validate(byte[] bytes, int offset, int end, boolean table) throws MalformedFrameException {
+        while (offset < end) {
+            if (table) {
+                offset += 1 + (bytes[offset] & 0xff);
+            }
+            if (offset >= end) {
+                throw new MalformedFrameException("Truncated table");
+            }
+            int type = bytes[offset] & 0xff;
+            int next = skipValue(bytes, offset, end);
+            if (next < 0 || next > end) {
+                throw new MalformedFrameException(next == -2 ? "Unrecognised type in table" : "Truncated table");
+            }
+            if (type == 'F' || type == 'A') {
+                validate(bytes, offset + 5, next, type == 'F');
+            }
+            offset = next;
+        }
+    }
+
+    /**
+     * @return the offset after the value whose type is at the offset,
+     * -1 if the bytes are truncated, -2 if the type is unknown
+     */
+    private static int skipValue(byte[] bytes, int offset, int end) {
+        int type = bytes[offset] & 0xff;
+        offset++;
+        switch (type) {
+            case 'V':
+                return offset;
+            case 'b':
+            case 't':
+                return offset + 1;
+            case 's':
+                return offset + 2;
+            case 'I':
+            case 'f':
+                return offset + 4;
+            case 'D':
+                return offset + 5;
+            case 'T':
+            case 'd':
+            case 'l':
+                return offset + 8;
+            case 'S':
+            case 'x':
+            case 'F':
+            case 'A':
+                if (offset + 4 > end) {
+                    return -1;
+                }
+                long length = ((bytes[offset] & 0xffL) << 24) | ((bytes[offset + 1] & 0xff) << 16)
+                    | ((bytes[offset + 2] & 0xff) << 8) | (bytes[offset + 3] & 0xff);
+                long next = offset + 4 + length;
+                return next > end ? -1 : (int) next;
+            default:
+                return -2;
+        }
+    }
+}
@@ -19,8 +19,8 @@ package com.rabbitmq.client.impl;
 import java.io.ByteArrayInputStream;
 import java.io.DataInputStream;
 import java.io.IOException;
-import java.io.UnsupportedEncodingException;
-import java.nio.charset.Charset;
+import java.io.OutputStream;
+import java.nio.charset.StandardCharsets;
 import java.util.Arrays;
 
 import com.rabbitmq.client.LongString;
@@ -31,39 +31,86 @@ import com.rabbitmq.client.LongString;
 public class LongStringHelper
 {
     /**
-     * Private API - Implementation of {@link LongString}. When
-     * interpreting bytes as a string, uses UTF-8 encoding.
+     * Private API - Implementation of {@link LongString}, over a range
+     * of a byte array. When interpreting bytes as a string, uses UTF-8 encoding.
+     * <p>
+     * The range can be a slice of a frame payload, so that long strings read
+     * from the network are not copied, nor copied again when they are written
+     * out. Such a slice keeps the whole payload alive.
      */
-    private static class ByteArrayLongString
+    static final class ByteArrayLongString
         implements LongString
     {
         private final byte [] bytes;
+        private final int offset;
+        private final int length;
+        /** The bytes of the range in an array of their own, once {@link #getBytes()} has been called */
+        private volatile byte [] copy;
+        /** The decoded string, once {@link #toString()} has been called */
+        private volatile String string;
 
         public ByteArrayLongString(byte[] bytes)
+        {
+            this(bytes, 0, bytes.length);
+        }
+
+        ByteArrayLongString(byte[] bytes, int offset, int length)
         {
             this.bytes = bytes;
+            this.offset = offset;
+            this.length = length;
         }
 
         @Override public boolean equals(Object o)
         {
+            if(o instanceof ByteArrayLongString) {
+                ByteArrayLongString other = (ByteArrayLongString)o;
+                return regionEquals(other.bytes, other.offset, other.length);
+            }
             if(o instanceof LongString) {
-                LongString other = (LongString)o;
-                return Arrays.equals(this.bytes, other.getBytes());
+                byte [] other = ((LongString)o).getBytes();
+                return regionEquals(other, 0, other.length);
             }
 
             return false;
         }
 
+        private boolean regionEquals(byte [] other, int otherOffset, int otherLength)
+        {
+            if (otherLength != this.length) {
+                return false;
+            }
+            for (int i = 0; i < this.length; i++) {
+                if (this.bytes[this.offset + i] != other[otherOffset + i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
         @Override public int hashCode()
         {
-           return Arrays.hashCode(this.bytes);
+            // same as Arrays.hashCode on the range
+            int result = 1;
+            for (int i = this.offset; i < this.offset + this.length; i++) {
+                result = 31 * result + this.bytes[i];
+            }
+            return result;
         }
 
         /** {@inheritDoc} */
         @Override
         public byte[] getBytes()
         {
-            return bytes;
+            if (this.offset == 0 && this.length == this.bytes.length) {
+                return this.bytes;
+            }
+            byte [] result = this.copy;
+            if (result == null) {
+                result = Arrays.copyOfRange(this.bytes, this.offset, this.offset + this.length);
+                this.copy = result;
+            }
+            return result;
         }
 
         /** {@inheritDoc} */
@@ -71,20 +118,38 @@ public class LongStringHelper
         public DataInputStream getStream()
             throws IOException
         {
-            return new DataInputStream(new ByteArrayInputStream(bytes));
+            return new DataInputStream(new ByteArrayInputStream(this.bytes, this.offset, this.length));
         }
 
         /** {@inheritDoc} */
         @Override
         public long length()
         {
-            return bytes.length;
+            return this.length;
         }
 
         @Override
         public String toString()
         {
-            return new String(bytes, Charset.forName("utf-8"));
+            String result = this.string;
+            if (result == null) {
+                result = new String(this.bytes, this.offset, this.length, StandardCharsets.UTF_8);
+                this.string = result;
+            }
+            return result;
+        }
+
+        /** Writes the bytes with a single write. */
+        void writeTo(OutputStream out)
+            throws IOException
+        {
+            out.write(this.bytes, this.offset, this.length);
+        }
+
+        /** Copies the bytes into an array. */
+        void copyTo(byte [] destination, int destinationOffset)
+        {
+            System.arraycopy(this.bytes, this.offset, destination, destinationOffset, this.length);
         }
     }
 
@@ -97,7 +162,7 @@ public class LongStringHelper
     {
         if (string == null)
             return null;
-        return new ByteArrayLongString(string.getBytes(Charset.forName("utf-8")));
+        return new ByteArrayLongString(string.getBytes(StandardCharsets.UTF_8));
     }
 
     /**
@@ -110,4 +175,23 @@ public class LongStringHelper
         if (bytes==null) return null;
         return new ByteArrayLongString(bytes);
     }
+
+    /**
+     * Converts a range of a binary block to a LongString, without copying it.
+     * The range must not be modified afterwards.
+     * @param bytes the array holding the data to wrap
+     * @param offset the offset of the data in the array
+     * @param length the length of the data
+     * @return a LongString wrapping the range
+     * @since 6.0.0
+     */
+    public static LongString asLongString(byte [] bytes, int offset, int length)
+    {
+        if (bytes==null) return null;
+        if (offset < 0 || length < 0 || offset + length > bytes.length) {
+            throw new IndexOutOfBoundsException(
+                "Range [" + offset + ", " + offset + " + " + length + ") out of bounds for length " + bytes.length);
+        }
+        return new ByteArrayLongString(bytes, offset, length);
+    }
 }
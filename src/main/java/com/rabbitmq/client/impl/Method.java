@@ -16,7 +16,6 @@
 
 package com.rabbitmq.client.impl;
 
-import java.io.DataOutputStream;
 import java.io.IOException;
 
 import com.rabbitmq.client.AMQP;
@@ -77,13 +76,18 @@ public abstract class Method implements com.rabbitmq.client.Method {
     }
 
     public Frame toFrame(int channelNumber) throws IOException {
-        Frame frame = new Frame(AMQP.FRAME_METHOD, channelNumber);
-        DataOutputStream bodyOut = frame.getOutputStream();
-        bodyOut.writeShort(protocolClassId());
-        bodyOut.writeShort(protocolMethodId());
-        MethodArgumentWriter argWriter = new MethodArgumentWriter(new ValueWriter(bodyOut));
+        // encode once to compute the size of the payload, then into it
+        BufferValueWriter sizer = new BufferValueWriter();
+        MethodArgumentWriter argWriter = new MethodArgumentWriter(sizer);
         writeArgumentsTo(argWriter);
         argWriter.flush();
-        return frame;
+        byte[] payload = new byte[4 + sizer.position()];
+        BufferValueWriter out = new BufferValueWriter(payload, 0);
+        out.writeShort(protocolClassId());
+        out.writeShort(protocolMethodId());
+        argWriter = new MethodArgumentWriter(out);
+        writeArgumentsTo(argWriter);
+        argWriter.flush();
+        return new Frame(AMQP.FRAME_METHOD, channelNumber, payload);
     }
 }
@@ -0,0 +1,73 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client.impl;
+
+import java.nio.charset.StandardCharsets;
+
+/**
+ * Helpers for the encoders generated for the methods that make up most
+ * of the traffic (e.g. <code>basic.publish</code>, <code>basic.deliver</code>,
+ * <code>basic.ack</code>). These encoders compute the exact size of the
+ * method frame payload and write each argument at its offset, instead
+ * of going through {@link MethodArgumentWriter} and a growing stream.
+ * <p>
+ * The <code>put</code> methods return the offset after the value they write.
+ */
+final class MethodCodec {
+
+    private MethodCodec() { }
+
+    /**
+     * @param str the short string
+     * @return the UTF-8 encoding of the short string
+     * @throws IllegalArgumentException if the encoding is longer than 255 bytes
+     */
+    static byte[] shortstr(String str) {
+        byte[] bytes = str.getBytes(StandardCharsets.UTF_8);
+        if (bytes.length > 255) {
+            throw new IllegalArgumentException(
+                    "Short string too long; utf-8 encoded length = " + bytes.length +
+                    ", max = 255.");
+        }
+        return bytes;
+    }
+
+    static int putShortstr(byte[] payload, int offset, byte[] str) {
+        payload[offset++] = (byte) str.length;
+        System.arraycopy(str, 0, payload, offset, str.length);
+        return offset + str.length;
+    }
+
+    static int putShort(byte[] payload, int offset, int value) {
+        payload[offset] = (byte) (value >>> 8);
+        payload[offset + 1] = (byte) value;
+        return offset + 2;
+    }
+
+    static int putLong(byte[] payload, int offset, int value) {
+        payload[offset] = (byte) (value >>> 24);
+        payload[offset + 1] = (byte) (value >>> 16);
+        payload[offset + 2] = (byte) (value >>> 8);
+        payload[offset + 3] = (byte) value;
+        return offset + 4;
+    }
+
+    static int putLonglong(byte[] payload, int offset, long value) {
+        putLong(payload, offset, (int) (value >>> 32));
+        return putLong(payload, offset + 4, (int) value);
+    }
+}
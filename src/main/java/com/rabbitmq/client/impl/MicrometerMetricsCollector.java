@@ -22,8 +22,10 @@ import io.micrometer.core.instrument.Counter;
 import io.micrometer.core.instrument.MeterRegistry;
 import io.micrometer.core.instrument.Tag;
 import io.micrometer.core.instrument.Tags;
+import io.micrometer.core.instrument.Timer;
 
 import java.util.Collections;
+import java.util.concurrent.TimeUnit;
 import java.util.concurrent.atomic.AtomicLong;
 import java.util.function.Function;
 
@@ -63,6 +65,8 @@ public class MicrometerMetricsCollector extends AbstractMetricsCollector {
 
     private final Counter rejectedMessages;
 
+    private final Timer publishConfirmLatency;
+
     public MicrometerMetricsCollector(MeterRegistry registry) {
         this(registry, "rabbitmq");
     }
@@ -90,6 +94,7 @@ public class MicrometerMetricsCollector extends AbstractMetricsCollector {
         this.ackedPublishedMessages = (Counter) metricsCreator.apply(ACKED_PUBLISHED_MESSAGES);
         this.nackedPublishedMessages = (Counter) metricsCreator.apply(NACKED_PUBLISHED_MESSAGES);
         this.unroutedPublishedMessages = (Counter) metricsCreator.apply(UNROUTED_PUBLISHED_MESSAGES);
+        this.publishConfirmLatency = (Timer) metricsCreator.apply(PUBLISH_CONFIRM_LATENCY);
     }
 
     @Override
@@ -152,6 +157,11 @@ public class MicrometerMetricsCollector extends AbstractMetricsCollector {
         unroutedPublishedMessages.increment();
     }
 
+    @Override
+    protected void updatePublishConfirmLatency(long latency, TimeUnit unit) {
+        publishConfirmLatency.record(latency, unit);
+    }
+
     public AtomicLong getConnections() {
         return connections;
     }
@@ -192,6 +202,10 @@ public class MicrometerMetricsCollector extends AbstractMetricsCollector {
         return rejectedMessages;
     }
 
+    public Timer getPublishConfirmLatency() {
+        return publishConfirmLatency;
+    }
+
     public enum Metrics {
         CONNECTIONS {
             @Override
@@ -252,6 +266,15 @@ public class MicrometerMetricsCollector extends AbstractMetricsCollector {
             Object create(MeterRegistry registry, String prefix, Iterable<Tag> tags) {
                 return registry.counter(prefix + ".unrouted_published", tags);
             }
+        },
+        PUBLISH_CONFIRM_LATENCY {
+            @Override
+            Object create(MeterRegistry registry, String prefix, Iterable<Tag> tags) {
+                return Timer.builder(prefix + ".publish_confirm_latency")
+                    .tags(tags)
+                    .publishPercentileHistogram()
+                    .register(registry);
+            }
         };
 
         abstract Object create(MeterRegistry registry, String prefix, Iterable<Tag> tags);
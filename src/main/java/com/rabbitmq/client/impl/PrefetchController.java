@@ -0,0 +1,172 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import java.util.concurrent.TimeUnit;
+
+/**
+ * Computes the channel prefetch count from what is observed on the dispatch
+ * and acknowledgement paths.
+ * <p>
+ * Deliveries of a channel are dispatched one at a time, so the channel
+ * can process at most <code>1 / p</code> messages per second, <code>p</code>
+ * being the average time spent in <code>handleDelivery</code>.
+ * A message stays unacknowledged for the network round trip plus
+ * <code>h</code>, the average time between the start of its dispatch
+ * and its acknowledgement. Keeping the consumer busy therefore needs
+ * <code>(rtt + h) / p</code> messages in flight (the bandwidth-delay product),
+ * which is the target prefetch count, plus some headroom.
+ * Time spent waiting in the client work pool is not counted, so
+ * raising the prefetch count does not feed back into the target.
+ * <p>
+ * The round trip is measured on the <code>basic.qos</code> calls
+ * issued to apply the prefetch count.
+ * <p>
+ * This class is thread-safe.
+ *
+ * @see ChannelN#setAutomaticPrefetch(int, int)
+ */
+final class PrefetchController {
+
+    static final long ADJUSTMENT_INTERVAL_NANOS = TimeUnit.SECONDS.toNanos(1);
+    /** Minimum number of samples in an interval to compute a new target */
+    static final int MIN_SAMPLES = 10;
+    private static final double HEADROOM = 1.25;
+    /** Ignore changes smaller than this ratio of the current prefetch count */
+    private static final double MIN_CHANGE_RATIO = 0.1;
+    private static final int DISPATCH_RING_SIZE = 4096;
+    private static final int DISPATCH_RING_MASK = DISPATCH_RING_SIZE - 1;
+
+    private final int minPrefetchCount;
+    private final int maxPrefetchCount;
+
+    /** Dispatch start times, indexed by delivery tag, to compute the hold time on acknowledgement */
+    private final long[] dispatchTags = new long[DISPATCH_RING_SIZE];
+    private final long[] dispatchStarts = new long[DISPATCH_RING_SIZE];
+
+    private int prefetchCount;
+    private long roundTripNanos = -1;
+    private boolean adjustmentInProgress = false;
+
+    private long intervalStart;
+    private long processingNanos;
+    private long processingSamples;
+    private long holdNanos;
+    private long holdSamples;
+
+    PrefetchController(int minPrefetchCount, int maxPrefetchCount, long now) {
+        // the prefetch count is an unsigned short on the wire
+        if (minPrefetchCount <= 0 || maxPrefetchCount < minPrefetchCount || maxPrefetchCount > 65535) {
+            throw new IllegalArgumentException("Invalid prefetch count range: [" +
+                minPrefetchCount + ", " + maxPrefetchCount + "]");
+        }
+        this.minPrefetchCount = minPrefetchCount;
+        this.maxPrefetchCount = maxPrefetchCount;
+        this.prefetchCount = minPrefetchCount;
+        this.intervalStart = now;
+    }
+
+    int getMinPrefetchCount() {
+        return minPrefetchCount;
+    }
+
+    int getMaxPrefetchCount() {
+        return maxPrefetchCount;
+    }
+
+    synchronized int getPrefetchCount() {
+        return prefetchCount;
+    }
+
+    /**
+     * Record a dispatched delivery.
+     * @param deliveryTag the delivery tag
+     * @param start when <code>handleDelivery</code> was called, in nanoseconds
+     * @param end when <code>handleDelivery</code> returned, in nanoseconds
+     */
+    synchronized void delivered(long deliveryTag, long start, long end) {
+        int index = (int) (deliveryTag & DISPATCH_RING_MASK);
+        dispatchTags[index] = deliveryTag;
+        dispatchStarts[index] = start;
+        processingNanos += end - start;
+        processingSamples++;
+    }
+
+    /**
+     * Record an acknowledgement (positive or not).
+     * Only the given delivery tag is sampled for <code>multiple</code> acknowledgements.
+     * @param deliveryTag the delivery tag
+     * @param now current time, in nanoseconds
+     */
+    synchronized void acknowledged(long deliveryTag, long now) {
+        int index = (int) (deliveryTag & DISPATCH_RING_MASK);
+        if (dispatchTags[index] == deliveryTag) {
+            dispatchTags[index] = 0;
+            holdNanos += now - dispatchStarts[index];
+            holdSamples++;
+        }
+    }
+
+    /**
+     * Compute a new prefetch count if the adjustment interval has elapsed.
+     * Measurements start over for the next interval.
+     * When a new prefetch count is returned, {@link #adjusted(long)} must be called
+     * once it is applied.
+     * @param now current time, in nanoseconds
+     * @return the new prefetch count, or 0 if it should not change
+     */
+    synchronized int nextPrefetchCount(long now) {
+        if (adjustmentInProgress || now - intervalStart < ADJUSTMENT_INTERVAL_NANOS) {
+            return 0;
+        }
+        if (processingSamples < MIN_SAMPLES) {
+            return 0;
+        }
+        long processing = Math.max(1, processingNanos / processingSamples);
+        long hold = holdSamples < MIN_SAMPLES ? processing : Math.max(processing, holdNanos / holdSamples);
+        long roundTrip = Math.max(0, roundTripNanos);
+        resetInterval(now);
+
+        long target = (long) Math.ceil((double) (roundTrip + hold) / processing * HEADROOM);
+        target = Math.max(minPrefetchCount, Math.min(maxPrefetchCount, target));
+        if (target == prefetchCount || Math.abs(target - prefetchCount) < prefetchCount * MIN_CHANGE_RATIO) {
+            return 0;
+        }
+        adjustmentInProgress = true;
+        prefetchCount = (int) target;
+        return prefetchCount;
+    }
+
+    /**
+     * Record that a prefetch count returned by {@link #nextPrefetchCount(long)} has been applied.
+     * @param roundTripNanos duration of the <code>basic.qos</code> round trip, or a negative value if it failed
+     */
+    synchronized void adjusted(long roundTripNanos) {
+        adjustmentInProgress = false;
+        if (roundTripNanos >= 0) {
+            // smooth out the variations
+            this.roundTripNanos = this.roundTripNanos < 0 ? roundTripNanos : (this.roundTripNanos + roundTripNanos) / 2;
+        }
+    }
+
+    private void resetInterval(long now) {
+        intervalStart = now;
+        processingNanos = 0;
+        processingSamples = 0;
+        holdNanos = 0;
+        holdSamples = 0;
+    }
+}
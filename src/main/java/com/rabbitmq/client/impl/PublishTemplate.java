@@ -0,0 +1,91 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import com.rabbitmq.client.AMQP;
+import com.rabbitmq.client.MessageProperties;
+import com.rabbitmq.client.PreparedPublish;
+
+import java.io.IOException;
+
+/**
+ * {@link PreparedPublish} of a {@link ChannelN}.
+ * <p>
+ * The <code>basic.publish</code> method frame is encoded when the template is created
+ * and shared by all the messages. So is the content header frame of messages without properties,
+ * except its body size, which is written in a copy for each message.
+ */
+final class PublishTemplate implements PreparedPublish {
+
+    /** Offset of the body size in a content header frame payload, after class id and weight */
+    private static final int BODY_SIZE_OFFSET = 4;
+
+    private final ChannelN channel;
+    private final AMQImpl.Basic.Publish method;
+    private final Frame methodFrame;
+    private final byte[] minimalHeader;
+
+    PublishTemplate(ChannelN channel, String exchange, String routingKey, boolean mandatory) throws IOException {
+        this.channel = channel;
+        this.method = (AMQImpl.Basic.Publish) new AMQP.Basic.Publish.Builder()
+            .exchange(exchange)
+            .routingKey(routingKey)
+            .mandatory(mandatory)
+            .build();
+        int channelNumber = channel.getChannelNumber();
+        this.methodFrame = new Frame(AMQP.FRAME_METHOD, channelNumber, method.toFrame(channelNumber).getPayload());
+        this.minimalHeader = MessageProperties.MINIMAL_BASIC.toFrame(channelNumber, 0).getPayload();
+    }
+
+    @Override
+    public void publish(AMQP.BasicProperties props, byte[] body) throws IOException {
+        channel.publish(this, props, body);
+    }
+
+    /**
+     * @param props the properties, null for none
+     * @param body the body
+     * @return the command to transmit, with the pre-encoded frames
+     */
+    AMQCommand command(AMQP.BasicProperties props, byte[] body) {
+        if (props != null) {
+            return new AMQCommand(method, props, body, methodFrame, null);
+        }
+        byte[] header = minimalHeader.clone();
+        long size = body.length;
+        for (int i = BODY_SIZE_OFFSET + 7; i >= BODY_SIZE_OFFSET; i--) {
+            header[i] = (byte) size;
+            size >>>= 8;
+        }
+        return new AMQCommand(method, MessageProperties.MINIMAL_BASIC, body, methodFrame,
+            new Frame(AMQP.FRAME_HEADER, channel.getChannelNumber(), header));
+    }
+
+    @Override
+    public String getExchange() {
+        return method.getExchange();
+    }
+
+    @Override
+    public String getRoutingKey() {
+        return method.getRoutingKey();
+    }
+
+    @Override
+    public boolean isMandatory() {
+        return method.getMandatory();
+    }
+}
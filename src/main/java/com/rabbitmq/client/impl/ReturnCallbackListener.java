@@ -0,0 +1,46 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import com.rabbitmq.client.AMQP;
+import com.rabbitmq.client.Return;
+import com.rabbitmq.client.ReturnCallback;
+import com.rabbitmq.client.ReturnListener;
+
+/**
+ * {@link ReturnListener} calling a {@link ReturnCallback}. The channel hands it
+ * the {@link Return} directly, with what it knows about the returned message.
+ *
+ * @see com.rabbitmq.client.Channel#addReturnListener(ReturnCallback)
+ */
+public final class ReturnCallbackListener implements ReturnListener {
+
+    private final ReturnCallback callback;
+
+    public ReturnCallbackListener(ReturnCallback callback) {
+        this.callback = callback;
+    }
+
+    @Override
+    public void handleReturn(int replyCode, String replyText, String exchange, String routingKey,
+                             AMQP.BasicProperties properties, byte[] body) {
+        callback.handle(new Return(replyCode, replyText, exchange, routingKey, properties, body));
+    }
+
+    void handleReturn(Return returned) {
+        callback.handle(returned);
+    }
+}
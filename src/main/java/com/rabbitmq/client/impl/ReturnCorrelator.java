@@ -0,0 +1,151 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import com.rabbitmq.client.Return;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+import java.util.NavigableSet;
+import java.util.TreeSet;
+
+/**
+ * Finds the publish sequence number of returned messages, without
+ * adding anything to the messages.
+ * <p>
+ * The broker sends the <code>basic.return</code> of an unroutable
+ * <code>mandatory</code> message before confirming the message, so a return
+ * is kept pending until the next <code>basic.ack</code> or <code>basic.nack</code>,
+ * which identifies the returned message. If that confirm is for several
+ * tracked messages (<code>multiple</code> flag) and there are fewer pending
+ * returns than confirmed messages, the returned messages cannot be told
+ * apart and the returns get the sequence number 0. So does a confirm with the
+ * <code>multiple</code> flag that may cover a <code>mandatory</code> message which
+ * is not tracked.
+ * <p>
+ * This class is thread-safe.
+ */
+final class ReturnCorrelator {
+
+    /** Sequence numbers of the outstanding tracked messages */
+    private final NavigableSet<Long> published = new TreeSet<Long>();
+
+    /** Returns waiting for the next confirm, in arrival order */
+    private final List<Pending> pending = new ArrayList<Pending>();
+
+    /** Highest sequence number of the confirms with the <code>multiple</code> flag */
+    private long multipleConfirmed = 0;
+
+    /**
+     * Track a message, before it is sent.
+     * @param seqNo the publish sequence number of the message
+     */
+    synchronized void published(long seqNo) {
+        published.add(seqNo);
+    }
+
+    /**
+     * Keep a return until the confirm of its message.
+     * @param returned the return, without sequence number
+     * @param callListeners whether the return listeners must be called
+     *                      with the correlated return
+     */
+    synchronized void returned(Return returned, boolean callListeners) {
+        pending.add(new Pending(returned, callListeners));
+    }
+
+    /**
+     * Correlate the pending returns with a confirm and forget the confirmed messages.
+     * @param seqNo the sequence number of the confirm
+     * @param multiple whether all messages up to the sequence number are confirmed
+     * @param lastUntracked the sequence number of the last <code>mandatory</code> message
+     *                      published without being tracked, 0 if none
+     * @return the correlated returns, in arrival order
+     */
+    synchronized List<Correlated> confirmed(long seqNo, boolean multiple, long lastUntracked) {
+        // messages up to the previous multiple confirm are all confirmed
+        boolean untrackedConfirmed = multiple && lastUntracked > multipleConfirmed;
+        if (multiple) {
+            multipleConfirmed = Math.max(multipleConfirmed, seqNo);
+        }
+        List<Long> confirmed;
+        if (multiple) {
+            NavigableSet<Long> head = published.headSet(seqNo, true);
+            confirmed = pending.isEmpty() ? Collections.<Long>emptyList() : new ArrayList<Long>(head);
+            head.clear();
+        } else {
+            confirmed = published.remove(seqNo) ? Collections.singletonList(seqNo) : Collections.<Long>emptyList();
+        }
+        if (pending.isEmpty()) {
+            return Collections.emptyList();
+        }
+        boolean known = confirmed.size() == pending.size() && !untrackedConfirmed;
+        List<Correlated> correlated = new ArrayList<Correlated>(pending.size());
+        for (int i = 0; i < pending.size(); i++) {
+            correlated.add(pending.get(i).correlate(known ? confirmed.get(i) : 0));
+        }
+        pending.clear();
+        return correlated;
+    }
+
+    /**
+     * Forget everything, e.g. when the channel is closed.
+     * @return the pending returns, without sequence number
+     */
+    synchronized List<Correlated> clear() {
+        List<Correlated> uncorrelated = new ArrayList<Correlated>(pending.size());
+        for (Pending p : pending) {
+            uncorrelated.add(p.correlate(0));
+        }
+        published.clear();
+        pending.clear();
+        return uncorrelated;
+    }
+
+    synchronized int size() {
+        return published.size();
+    }
+
+    /** A return with the sequence number of its message, 0 if unknown */
+    static final class Correlated {
+
+        final Return returned;
+        final boolean callListeners;
+
+        private Correlated(Return returned, boolean callListeners) {
+            this.returned = returned;
+            this.callListeners = callListeners;
+        }
+    }
+
+    private static final class Pending {
+
+        private final Return returned;
+        private final boolean callListeners;
+
+        private Pending(Return returned, boolean callListeners) {
+            this.returned = returned;
+            this.callListeners = callListeners;
+        }
+
+        private Correlated correlate(long seqNo) {
+            Return r = returned;
+            return new Correlated(new Return(r.getReplyCode(), r.getReplyText(), r.getExchange(), r.getRoutingKey(),
+                r.getProperties(), r.getBody(), seqNo), callListeners);
+        }
+    }
+}
@@ -0,0 +1,80 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import java.nio.charset.StandardCharsets;
+
+/**
+ * Cache of recently decoded short strings, e.g. consumer tags, exchanges
+ * and routing keys, which are mostly the same from a delivery to the next.
+ * <p>
+ * The cache is direct-mapped on the hash of the encoded bytes: a hit returns
+ * the same {@link String} instance as the previous decoding, hash code already computed,
+ * a miss decodes the bytes and replaces the entry. ASCII strings, the common case,
+ * are decoded without the UTF-8 decoder.
+ * <p>
+ * This class is not thread-safe, there is one per channel, used by the thread
+ * reading frames.
+ */
+final class ShortStringCache {
+
+    /** Number of entries, a power of two */
+    private static final int SIZE = 64;
+
+    private final byte[][] keys = new byte[SIZE][];
+    private final String[] values = new String[SIZE];
+
+    /**
+     * @param bytes array holding the UTF-8 encoded string
+     * @param offset offset of the string
+     * @param length length of the string, in bytes
+     * @return the decoded string
+     */
+    String get(byte[] bytes, int offset, int length) {
+        int hash = 0;
+        boolean ascii = true;
+        for (int i = offset; i < offset + length; i++) {
+            byte b = bytes[i];
+            hash = 31 * hash + b;
+            ascii &= b >= 0;
+        }
+        int index = (hash ^ (hash >>> 16)) & (SIZE - 1);
+        byte[] key = keys[index];
+        if (key != null && regionEquals(key, bytes, offset, length)) {
+            return values[index];
+        }
+        String value = ascii ?
+            new String(bytes, offset, length, StandardCharsets.ISO_8859_1) :
+            new String(bytes, offset, length, StandardCharsets.UTF_8);
+        key = new byte[length];
+        System.arraycopy(bytes, offset, key, 0, length);
+        keys[index] = key;
+        values[index] = value;
+        return value;
+    }
+
+    private static boolean regionEquals(byte[] key, byte[] bytes, int offset, int length) {
+        if (key.length != length) {
+            return false;
+        }
+        for (int i = 0; i < length; i++) {
+            if (key[i] != bytes[offset + i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
@@ -18,16 +18,23 @@ package com.rabbitmq.client.impl;
 import com.codahale.metrics.Counter;
 import com.codahale.metrics.Meter;
 import com.codahale.metrics.MetricRegistry;
+import com.codahale.metrics.Timer;
 import com.rabbitmq.client.Channel;
 import com.rabbitmq.client.Connection;
 import com.rabbitmq.client.MetricsCollector;
 
+import java.util.concurrent.TimeUnit;
+
 /**
  * Dropwizard Metrics implementation of {@link MetricsCollector}.
  * Note transactions are not supported (see {@link MetricsCollector}.
  * Metrics provides out-of-the-box support for report backends like JMX,
  * Graphite, Ganglia, or plain HTTP. See Metrics documentation for
  * more details.
+ * <p>
+ * The publish confirm latency timer uses the default reservoir of the
+ * registry. To use another reservoir, e.g. an HDR histogram, register the timer
+ * (<code>prefix.publish_confirm_latency</code>) before creating the collector.
  *
  * @see MetricsCollector
  */
@@ -45,6 +52,7 @@ public class StandardMetricsCollector extends AbstractMetricsCollector {
     private final Meter publishAcknowledgedMessages;
     private final Meter publishNacknowledgedMessages;
     private final Meter publishUnroutedMessages;
+    private final Timer publishConfirmLatency;
 
 
     public StandardMetricsCollector(MetricRegistry registry, String metricsPrefix) {
@@ -56,6 +64,7 @@ public class StandardMetricsCollector extends AbstractMetricsCollector {
         this.publishAcknowledgedMessages = registry.meter(metricsPrefix+".publish_ack");
         this.publishNacknowledgedMessages = registry.meter(metricsPrefix+".publish_nack");
         this.publishUnroutedMessages = registry.meter(metricsPrefix+".publish_unrouted");
+        this.publishConfirmLatency = registry.timer(metricsPrefix+".publish_confirm_latency");
         this.consumedMessages = registry.meter(metricsPrefix+".consumed");
         this.acknowledgedMessages = registry.meter(metricsPrefix+".acknowledged");
         this.rejectedMessages = registry.meter(metricsPrefix+".rejected");
@@ -129,6 +138,11 @@ public class StandardMetricsCollector extends AbstractMetricsCollector {
         publishUnroutedMessages.mark();
     }
 
+    @Override
+    protected void updatePublishConfirmLatency(long latency, TimeUnit unit) {
+        publishConfirmLatency.update(latency, unit);
+    }
+
     public MetricRegistry getMetricRegistry() {
         return registry;
     }
@@ -173,4 +187,8 @@ public class StandardMetricsCollector extends AbstractMetricsCollector {
         return publishUnroutedMessages;
     }
 
+    public Timer getPublishConfirmLatency() {
+        return publishConfirmLatency;
+    }
+
 }
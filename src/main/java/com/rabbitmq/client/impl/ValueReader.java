@@ -32,6 +32,7 @@ import com.rabbitmq.client.MalformedFrameException;
 
 /**
  * Helper class to read AMQP wire-protocol encoded values.
+ * @see BufferValueReader
  */
 public class ValueReader
 {
@@ -58,6 +59,14 @@ public class ValueReader
         this.in = in;
     }
 
+    /**
+     * For subclasses that do not read from a stream.
+     */
+    protected ValueReader()
+    {
+        this.in = null;
+    }
+
     /** Convenience method - reads a short string from a DataInput
      * Stream.
      */
@@ -70,7 +79,7 @@ public class ValueReader
     }
 
     /** Public API - reads a short string. */
-    public final String readShortstr()
+    public String readShortstr()
         throws IOException
     {
         return readShortstr(this.in);
@@ -104,28 +113,28 @@ public class ValueReader
 
 
     /** Public API - reads a long string. */
-    public final LongString readLongstr()
+    public LongString readLongstr()
         throws IOException
     {
         return readLongstr(this.in);
     }
 
     /** Public API - reads a short integer. */
-    public final int readShort()
+    public int readShort()
         throws IOException
     {
         return in.readUnsignedShort();
     }
 
     /** Public API - reads an integer. */
-    public final int readLong()
+    public int readLong()
         throws IOException
     {
         return in.readInt();
     }
 
     /** Public API - reads a long integer. */
-    public final long readLonglong()
+    public long readLonglong()
         throws IOException
     {
         return in.readLong();
@@ -141,9 +150,18 @@ public class ValueReader
         long tableLength = unsignedExtend(in.readInt());
         if (tableLength == 0) return Collections.emptyMap();
         
-        Map<String, Object> table = new HashMap<String, Object>();
         DataInputStream tableIn = new DataInputStream
             (new TruncatedInputStream(in, tableLength));
+        return readTableEntries(tableIn);
+    }
+
+    /**
+     * Reads the entries of a table until the end of the stream.
+     */
+    private static Map<String, Object> readTableEntries(DataInputStream tableIn)
+        throws IOException
+    {
+        Map<String, Object> table = new HashMap<String, Object>();
         while(tableIn.available() > 0) {
             String name = readShortstr(tableIn);
             Object value = readFieldValue(tableIn);
@@ -153,6 +171,7 @@ public class ValueReader
         return table;
     }
 
+    /** Reads a field value, type included. */
     private static Object readFieldValue(DataInputStream in)
         throws IOException {
         Object value = null;
@@ -225,14 +244,26 @@ public class ValueReader
     }
 
     /** Public API - reads a table. */
-    public final Map<String, Object> readTable()
+    public Map<String, Object> readTable()
         throws IOException
     {
         return readTable(this.in);
     }
 
+    /**
+     * Reads a table, decoded only when accessed.
+     * @see LazyTable
+     */
+    public Map<String, Object> readLazyTable()
+        throws IOException
+    {
+        byte[] bytes = readBytes(this.in);
+        if (bytes.length == 0) return Collections.emptyMap();
+        return new LazyTable(bytes);
+    }
+
     /** Public API - reads an octet. */
-    public final int readOctet()
+    public int readOctet()
         throws IOException
     {
         return in.readUnsignedByte();
@@ -247,7 +278,7 @@ public class ValueReader
 
 
     /** Public API - reads an timestamp. */
-    public final Date readTimestamp()
+    public Date readTimestamp()
         throws IOException
     {
         return readTimestamp(this.in);
@@ -22,6 +22,7 @@ import java.io.InputStream;
 import java.io.OutputStream;
 import java.math.BigDecimal;
 import java.math.BigInteger;
+import java.nio.charset.StandardCharsets;
 import java.util.Date;
 import java.util.Map;
 import java.util.List;
@@ -40,11 +41,17 @@ public class ValueWriter
         this.out = out;
     }
 
+    /** For subclasses that do not write to a stream. */
+    protected ValueWriter()
+    {
+        this.out = null;
+    }
+
     /** Public API - encodes a short string. */
-    public final void writeShortstr(String str)
+    public void writeShortstr(String str)
         throws IOException
     {
-        byte [] bytes = str.getBytes("utf-8");
+        byte [] bytes = str.getBytes(StandardCharsets.UTF_8);
         int length = bytes.length;
         if (length > 255) {
             throw new IllegalArgumentException(
@@ -56,11 +63,15 @@ public class ValueWriter
     }
 
     /** Public API - encodes a long string from a LongString. */
-    public final void writeLongstr(LongString str)
+    public void writeLongstr(LongString str)
         throws IOException
     {
         writeLong((int)str.length());
-        copy(str.getStream(), out);
+        if (str instanceof LongStringHelper.ByteArrayLongString) {
+            ((LongStringHelper.ByteArrayLongString) str).writeTo(out);
+        } else {
+            copy(str.getStream(), out);
+        }
     }
 
     private static final int COPY_BUFFER_SIZE = 4096;
@@ -75,23 +86,23 @@ public class ValueWriter
     }
 
     /** Public API - encodes a long string from a String. */
-    public final void writeLongstr(String str)
+    public void writeLongstr(String str)
         throws IOException
     {
-        byte [] bytes = str.getBytes("utf-8");
+        byte [] bytes = str.getBytes(StandardCharsets.UTF_8);
         writeLong(bytes.length);
         out.write(bytes);
     }
 
     /** Public API - encodes a short integer. */
-    public final void writeShort(int s)
+    public void writeShort(int s)
         throws IOException
     {
         out.writeShort(s);
     }
 
     /** Public API - encodes an integer. */
-    public final void writeLong(int l)
+    public void writeLong(int l)
         throws IOException
     {
         // java's arithmetic on this type is signed, however it's
@@ -102,14 +113,14 @@ public class ValueWriter
     }
 
     /** Public API - encodes a long integer. */
-    public final void writeLonglong(long ll)
+    public void writeLonglong(long ll)
         throws IOException
     {
         out.writeLong(ll);
     }
 
     /** Public API - encodes a table. */
-    public final void writeTable(Map<String, Object> table)
+    public void writeTable(Map<String, Object> table)
         throws IOException
     {
         if (table == null) {
@@ -125,7 +136,7 @@ public class ValueWriter
         }
     }
 
-    public final void writeFieldValue(Object value)
+    public void writeFieldValue(Object value)
         throws IOException
     {
         if(value instanceof String) {
@@ -165,32 +176,32 @@ public class ValueWriter
         }
         else if (value instanceof Byte) {
             writeOctet('b');
-            out.writeByte((Byte)value);
+            writeOctet((Byte)value);
         }
         else if(value instanceof Double) {
             writeOctet('d');
-            out.writeDouble((Double)value);
+            writeLonglong(Double.doubleToLongBits((Double)value));
         }
         else if(value instanceof Float) {
             writeOctet('f');
-            out.writeFloat((Float)value);
+            writeLong(Float.floatToIntBits((Float)value));
         }
         else if(value instanceof Long) {
             writeOctet('l');
-            out.writeLong((Long)value);
+            writeLonglong((Long)value);
         }
         else if(value instanceof Short) {
             writeOctet('s');
-            out.writeShort((Short)value);
+            writeShort((Short)value);
         }
         else if(value instanceof Boolean) {
             writeOctet('t');
-            out.writeBoolean((Boolean)value);
+            writeOctet((Boolean)value ? 1 : 0);
         }
         else if(value instanceof byte[]) {
             writeOctet('x');
             writeLong(((byte[])value).length);
-            out.write((byte[])value);
+            writeBytes((byte[])value);
         }
         else if(value == null) {
             writeOctet('V');
@@ -209,11 +220,11 @@ public class ValueWriter
         }
     }
 
-    public final void writeArray(List<?> value)
+    public void writeArray(List<?> value)
         throws IOException
     {
         if (value==null) {
-            out.write(0);
+            writeOctet(0);
         }
         else {
             out.writeInt((int)Frame.arraySize(value));
@@ -223,11 +234,11 @@ public class ValueWriter
         }
     }
 
-    public final void writeArray(Object[] value)
+    public void writeArray(Object[] value)
         throws IOException
     {
         if (value==null) {
-            out.write(0);
+            writeOctet(0);
         }
         else {
             out.writeInt((int)Frame.arraySize(value));
@@ -237,22 +248,29 @@ public class ValueWriter
         }
     }
 
+    /** Writes bytes as they are. */
+    protected void writeBytes(byte[] bytes)
+        throws IOException
+    {
+        out.write(bytes);
+    }
+
     /** Public API - encodes an octet from an int. */
-    public final void writeOctet(int octet)
+    public void writeOctet(int octet)
         throws IOException
     {
         out.writeByte(octet);
     }
 
     /** Public API - encodes an octet from a byte. */
-    public final void writeOctet(byte octet)
+    public void writeOctet(byte octet)
         throws IOException
     {
         out.writeByte(octet);
     }
 
     /** Public API - encodes a timestamp. */
-    public final void writeTimestamp(Date timestamp)
+    public void writeTimestamp(Date timestamp)
         throws IOException
     {
         // AMQP uses POSIX time_t which is in seconds since the epoch began
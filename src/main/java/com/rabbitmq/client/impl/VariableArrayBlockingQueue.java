@@ -0,0 +1,262 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import java.util.Collection;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.locks.Condition;
+import java.util.concurrent.locks.ReentrantLock;
+
+/**
+ * <p>An array-backed, bounded FIFO queue whose capacity can be changed
+ * while it is in use with {@link #setCapacity(int)}.</p>
+ * <p>Elements are stored in a power-of-two ring buffer which only grows
+ * (by doubling) when it is full and the capacity allows more elements,
+ * so steady-state enqueueing and dequeueing allocate nothing.
+ * The ring never holds more than {@link #getCapacity()} elements except
+ * when the capacity is lowered below the current size: existing elements
+ * are kept and producers block until enough of them are taken.</p>
+ * <p>Only the operations needed by {@link WorkPool} are provided:
+ * blocking insertion at the tail, non-blocking removal at the head
+ * and bulk removal with {@link #drainTo(Collection, int)}.</p>
+ * <h2>Concurrent Semantics</h2>
+ * This implementation is thread-safe.
+ * @param <E> the type of elements held in this queue
+ */
+public class VariableArrayBlockingQueue<E> {
+    private static final int INITIAL_ARRAY_SIZE = 16;
+    private static final int MAXIMUM_ARRAY_SIZE = 1 << 30;
+
+    /** Main lock guarding all access */
+    private final ReentrantLock lock = new ReentrantLock();
+    /** Wait queue for waiting puts */
+    private final Condition notFull = lock.newCondition();
+
+    /** The ring, its length is always a power of two */
+    private Object[] items;
+    /** Index of the head of the queue */
+    private int head;
+    /** Number of elements in the queue */
+    private int count;
+    /** The capacity bound, or Integer.MAX_VALUE if none */
+    private int capacity;
+
+    /**
+     * Creates a queue with the given capacity.
+     * @param capacity the capacity of this queue
+     * @throws IllegalArgumentException if <tt>capacity</tt> is not greater than zero
+     */
+    public VariableArrayBlockingQueue(int capacity) {
+        if (capacity <= 0) throw new IllegalArgumentException();
+        this.capacity = capacity;
+        this.items = new Object[ringSizeFor(Math.min(capacity, INITIAL_ARRAY_SIZE))];
+    }
+
+    private static int ringSizeFor(int n) {
+        int size = Integer.highestOneBit(n);
+        return size == n ? size : size << 1;
+    }
+
+    /**
+     * Set a new capacity for the queue. Increasing the capacity can
+     * cause any waiting {@link #put(Object)} invocations to succeed if the new
+     * capacity is larger than the queue.
+     * @param capacity the new capacity for the queue
+     */
+    public void setCapacity(int capacity) {
+        if (capacity <= 0) throw new IllegalArgumentException();
+        final ReentrantLock lock = this.lock;
+        lock.lock();
+        try {
+            int oldCapacity = this.capacity;
+            this.capacity = capacity;
+            if (capacity > oldCapacity && count < capacity) {
+                notFull.signalAll();
+            }
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * @return the current capacity bound of this queue
+     */
+    public int getCapacity() {
+        final ReentrantLock lock = this.lock;
+        lock.lock();
+        try {
+            return capacity;
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * Inserts the specified element at the tail of this queue, waiting if
+     * necessary for space to become available.
+     * @param e the element to add
+     * @throws InterruptedException if interrupted while waiting
+     * @throws NullPointerException if the specified element is null
+     */
+    public void put(E e) throws InterruptedException {
+        if (e == null) throw new NullPointerException();
+        final ReentrantLock lock = this.lock;
+        lock.lockInterruptibly();
+        try {
+            while (count >= capacity) {
+                notFull.await();
+            }
+            enqueue(e);
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * Inserts the specified element at the tail of this queue, waiting if
+     * necessary up to the specified wait time for space to become available.
+     * @param e the element to add
+     * @param timeout how long to wait before giving up, in units of <tt>unit</tt>
+     * @param unit a <tt>TimeUnit</tt> determining how to interpret the <tt>timeout</tt> parameter
+     * @return <tt>true</tt> if successful, or <tt>false</tt> if
+     *         the specified waiting time elapses before space is available
+     * @throws InterruptedException if interrupted while waiting
+     * @throws NullPointerException if the specified element is null
+     */
+    public boolean offer(E e, long timeout, TimeUnit unit) throws InterruptedException {
+        if (e == null) throw new NullPointerException();
+        long nanos = unit.toNanos(timeout);
+        final ReentrantLock lock = this.lock;
+        lock.lockInterruptibly();
+        try {
+            while (count >= capacity) {
+                if (nanos <= 0) {
+                    return false;
+                }
+                nanos = notFull.awaitNanos(nanos);
+            }
+            enqueue(e);
+            return true;
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * Retrieves and removes the head of this queue.
+     * @return the head of this queue, or <tt>null</tt> if this queue is empty
+     */
+    public E poll() {
+        final ReentrantLock lock = this.lock;
+        lock.lock();
+        try {
+            if (count == 0) {
+                return null;
+            }
+            E e = dequeue();
+            notFull.signal();
+            return e;
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * Removes at most the given number of elements from this queue
+     * and adds them to the given collection, in FIFO order.
+     * @param c the collection to transfer elements into
+     * @param maxElements the maximum number of elements to transfer
+     * @return the number of elements transferred
+     */
+    public int drainTo(Collection<? super E> c, int maxElements) {
+        if (c == null) throw new NullPointerException();
+        final ReentrantLock lock = this.lock;
+        lock.lock();
+        try {
+            int n = Math.min(maxElements, count);
+            for (int i = 0; i < n; i++) {
+                c.add(dequeue());
+            }
+            if (n > 0) {
+                notFull.signalAll();
+            }
+            return n;
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * @return the number of elements in this queue
+     */
+    public int size() {
+        final ReentrantLock lock = this.lock;
+        lock.lock();
+        try {
+            return count;
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * @return <tt>true</tt> if this queue contains no elements
+     */
+    public boolean isEmpty() {
+        return size() == 0;
+    }
+
+    /**
+     * Adds an element at the tail, growing the ring if needed.
+     * Call only while holding the lock.
+     */
+    private void enqueue(E e) {
+        Object[] items = this.items;
+        if (count == items.length) {
+            items = grow();
+        }
+        items[(head + count) & (items.length - 1)] = e;
+        count++;
+    }
+
+    /**
+     * Removes the head element, clearing its slot.
+     * Call only while holding the lock and when the queue is not empty.
+     */
+    @SuppressWarnings("unchecked")
+    private E dequeue() {
+        Object[] items = this.items;
+        E e = (E) items[head];
+        items[head] = null;
+        head = (head + 1) & (items.length - 1);
+        count--;
+        return e;
+    }
+
+    private Object[] grow() {
+        Object[] old = this.items;
+        if (old.length >= MAXIMUM_ARRAY_SIZE) {
+            throw new IllegalStateException("Queue cannot hold more than " + MAXIMUM_ARRAY_SIZE + " elements");
+        }
+        Object[] grown = new Object[old.length << 1];
+        int firstPart = old.length - head;
+        System.arraycopy(old, head, grown, 0, firstPart);
+        System.arraycopy(old, 0, grown, firstPart, head);
+        this.items = grown;
+        this.head = 0;
+        return grown;
+    }
+}
@@ -0,0 +1,179 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import java.util.Comparator;
+import java.util.HashMap;
+import java.util.Map;
+import java.util.TreeSet;
+
+/**
+ * <p>A queue-like implementation (supporting operations <code>addIfNotPresent</code>,
+ * <code>poll</code>, <code>contains</code>, and <code>isEmpty</code>)
+ * which restricts a queue element to appear at most once
+ * and orders elements by weighted fair share rather than by arrival.
+ * </p>
+ * Each element has a <i>weight</i> (default {@link #DEFAULT_WEIGHT}) and a <i>virtual time</i>.
+ * {@link #poll()} returns the element with the smallest virtual time, ties being
+ * broken by arrival order, so with equal weights and equal charges the queue is FIFO.
+ * After polling an element, the caller reports the work done for it with
+ * {@link #charge(Object, int)}, which advances its virtual time inversely
+ * to its weight: an element of weight 4 can be served 4 times as much
+ * as an element of weight 1 before falling behind it.
+ * An element re-added after being idle starts no earlier than the virtual time
+ * of the last polled element, so it cannot accumulate credit while idle.
+ * <p/>
+ * Weights and virtual times are kept for elements that are not in the queue,
+ * until they are {@link #remove(Object) removed}.
+ * Elements must not be <code><b>null</b></code>.
+ * <h2>Concurrent Semantics</h2>
+ * This implementation is <i>not</i> thread-safe.
+ * @param <T> type of elements in the queue
+ */
+public class WeightedSetQueue<T> {
+    public static final int DEFAULT_WEIGHT = 1;
+
+    /** Virtual time units for one unit of work at weight 1 */
+    private static final long VIRTUAL_TIME_SCALE = 1 << 20;
+
+    private final Map<T, Entry<T>> entries = new HashMap<T, Entry<T>>();
+    private final TreeSet<Entry<T>> queue = new TreeSet<Entry<T>>(new Comparator<Entry<T>>() {
+        @Override
+        public int compare(Entry<T> e1, Entry<T> e2) {
+            int c = Long.compare(e1.virtualTime, e2.virtualTime);
+            return c != 0 ? c : Long.compare(e1.sequence, e2.sequence);
+        }
+    });
+    /** Virtual time of the last polled element */
+    private long virtualTime = 0;
+    private long sequence = 0;
+
+    /** Add an element to the queue and return <code><b>true</b></code>, or else return <code><b>false</b></code>.
+     * @param item to add
+     * @return <b><code>true</code></b> if the element was added, <b><code>false</code></b> if it is already present.
+     */
+    public boolean addIfNotPresent(T item) {
+        Entry<T> entry = entry(item);
+        if (entry.queued) {
+            return false;
+        }
+        entry.virtualTime = Math.max(entry.virtualTime, this.virtualTime);
+        entry.sequence = this.sequence++;
+        entry.queued = true;
+        this.queue.add(entry);
+        return true;
+    }
+
+    /** Remove the element with the smallest virtual time and return it.
+     * @return head element of the queue, or <b><code>null</code></b> if the queue is empty.
+     */
+    public T poll() {
+        Entry<T> entry = this.queue.pollFirst();
+        if (entry == null) {
+            return null;
+        }
+        entry.queued = false;
+        this.virtualTime = entry.virtualTime;
+        return entry.item;
+    }
+
+    /** Account for work done for an element that is not in the queue.
+     * @param item the element the work was done for
+     * @param units amount of work done, e.g. the number of items processed
+     * @throws IllegalStateException if the element is in the queue
+     */
+    public void charge(T item, int units) {
+        Entry<T> entry = this.entries.get(item);
+        if (entry == null || units <= 0) {
+            return;
+        }
+        if (entry.queued) {
+            throw new IllegalStateException("Cannot charge " + item + " while it is queued");
+        }
+        entry.virtualTime += units * VIRTUAL_TIME_SCALE / entry.weight;
+    }
+
+    /** Set the weight of an element, whether it is in the queue or not.
+     * The new weight applies to subsequent charges.
+     * @param item the element
+     * @param weight the weight, must be strictly positive
+     */
+    public void setWeight(T item, int weight) {
+        if (weight <= 0) {
+            throw new IllegalArgumentException("Weight must be strictly positive: " + weight);
+        }
+        entry(item).weight = weight;
+    }
+
+    /** @param item the element
+     * @return the weight of the element, {@link #DEFAULT_WEIGHT} if unknown */
+    public int getWeight(T item) {
+        Entry<T> entry = this.entries.get(item);
+        return entry == null ? DEFAULT_WEIGHT : entry.weight;
+    }
+
+    /** @param item to look for in queue
+     * @return <code><b>true</b></code> if and only if <b>item</b> is in the queue.*/
+    public boolean contains(T item) {
+        Entry<T> entry = this.entries.get(item);
+        return entry != null && entry.queued;
+    }
+
+    /** @return <code><b>true</b></code> if and only if the queue is empty.*/
+    public boolean isEmpty() {
+        return this.queue.isEmpty();
+    }
+
+    /** Remove item from queue, if present, and forget its weight and virtual time.
+     * @param item to remove
+     *  @return <code><b>true</b></code> if and only if item was initially present and was removed.
+     */
+    public boolean remove(T item) {
+        Entry<T> entry = this.entries.remove(item);
+        if (entry != null && entry.queued) {
+            this.queue.remove(entry);
+            return true;
+        }
+        return false;
+    }
+
+    /** Remove all items from the queue, and forget all weights and virtual times. */
+    public void clear() {
+        this.queue.clear();
+        this.entries.clear();
+    }
+
+    private Entry<T> entry(T item) {
+        Entry<T> entry = this.entries.get(item);
+        if (entry == null) {
+            entry = new Entry<T>(item);
+            this.entries.put(item, entry);
+        }
+        return entry;
+    }
+
+    private static final class Entry<T> {
+        private final T item;
+        private int weight = DEFAULT_WEIGHT;
+        private long virtualTime;
+        private long sequence;
+        private boolean queued;
+
+        private Entry(T item) {
+            this.item = item;
+        }
+    }
+}
@@ -38,6 +38,10 @@ import java.util.function.BiConsumer;
  * The next <i>ready</i> client, together with a collection of its items,
  * may be retrieved with <code><b>nextWorkBlock(collection,max)</b></code>
  * (making that client <i>in progress</i>).
+ * Ready clients are served in weighted fair share order: each client has a <i>weight</i>
+ * (set with <code><b>setWeight(K, int)</b></code>, default 1), and a client of weight <i>n</i>
+ * gets <i>n</i> times as many items as a client of weight 1 when both always have work.
+ * With equal weights, clients are served round-robin.
  * An <i>in progress</i> client can finish (processing a batch of items) with <code><b>finishWorkBlock(K)</b></code>.
  * It then becomes either <i>dormant</i> or <i>ready</i>, depending if its queue of work items is empty or no.
  * If a client has items queued, it is either <i>in progress</i> or <i>ready</i> but cannot be both.
@@ -55,15 +59,15 @@ import java.util.function.BiConsumer;
 public class WorkPool<K, W> {
     private static final int MAX_QUEUE_LENGTH = 1000;
 
-    /** An injective queue of <i>ready</i> clients. */
-    private final SetQueue<K> ready = new SetQueue<K>();
+    /** An injective queue of <i>ready</i> clients, served by weighted fair share. */
+    private final WeightedSetQueue<K> ready = new WeightedSetQueue<K>();
     /** The set of clients which have work <i>in progress</i>. */
     private final Set<K> inProgress = new HashSet<K>();
     /** The pool of registered clients, with their work queues. */
-    private final Map<K, VariableLinkedBlockingQueue<W>> pool = new HashMap<K, VariableLinkedBlockingQueue<W>>();
+    private final Map<K, VariableArrayBlockingQueue<W>> pool = new HashMap<K, VariableArrayBlockingQueue<W>>();
     /** Those keys which want limits to be removed. We do not limit queue size if this is non-empty. */
     private final Set<K> unlimited = new HashSet<K>();
-    private final BiConsumer<VariableLinkedBlockingQueue<W>, W> enqueueingCallback;
+    private final BiConsumer<VariableArrayBlockingQueue<W>, W> enqueueingCallback;
 
     public WorkPool(final int queueingTimeout) {
         if (queueingTimeout > 0) {
@@ -98,7 +102,7 @@ public class WorkPool<K, W> {
         synchronized (this) {
             if (!this.pool.containsKey(key)) {
                 int initialCapacity = unlimited.isEmpty() ? MAX_QUEUE_LENGTH : Integer.MAX_VALUE;
-                this.pool.put(key, new VariableLinkedBlockingQueue<W>(initialCapacity));
+                this.pool.put(key, new VariableArrayBlockingQueue<W>(initialCapacity));
             }
         }
     }
@@ -118,12 +122,26 @@ public class WorkPool<K, W> {
     }
 
     private void setCapacities(int capacity) {
-        Iterator<VariableLinkedBlockingQueue<W>> it = pool.values().iterator();
+        Iterator<VariableArrayBlockingQueue<W>> it = pool.values().iterator();
         while (it.hasNext()) {
             it.next().setCapacity(capacity);
         }
     }
 
+    /**
+     * Set the scheduling weight of a registered client.
+     * No-op if <code><b>key</b></code> is not registered.
+     * @param key client to set the weight of
+     * @param weight strictly positive weight, higher weights get a larger share of the work
+     */
+    public void setWeight(K key, int weight) {
+        synchronized (this) {
+            if (isRegistered(key)) {
+                this.ready.setWeight(key, weight);
+            }
+        }
+    }
+
     /**
      * Remove client from pool and from any other state. Has no effect if client already absent.
      * @param key of client to unregister
@@ -162,32 +180,13 @@ public class WorkPool<K, W> {
         synchronized (this) {
             K nextKey = readyToInProgress();
             if (nextKey != null) {
-                VariableLinkedBlockingQueue<W> queue = this.pool.get(nextKey);
-                drainTo(queue, to, size);
+                VariableArrayBlockingQueue<W> queue = this.pool.get(nextKey);
+                this.ready.charge(nextKey, queue.drainTo(to, size));
             }
             return nextKey;
         }
     }
 
-    /**
-     * Private implementation of <code><b>drainTo</b></code> (not implemented for <code><b>LinkedList&lt;W&gt;</b></code>s).
-     * @param deList to take (poll) elements from
-     * @param c to add elements to
-     * @param maxElements to take from deList
-     * @return number of elements actually taken
-     */
-    private int drainTo(VariableLinkedBlockingQueue<W> deList, Collection<W> c, int maxElements) {
-        int n = 0;
-        while (n < maxElements) {
-            W first = deList.poll();
-            if (first == null)
-                break;
-            c.add(first);
-            ++n;
-        }
-        return n;
-    }
-
     /**
      * Add (enqueue) an item for a specific client.
      * No change and returns <code><b>false</b></code> if client not registered.
@@ -198,7 +197,7 @@ public class WorkPool<K, W> {
      * &mdash; <i>as a result of this work item</i>
      */
     public boolean addWorkItem(K key, W item) {
-        VariableLinkedBlockingQueue<W> queue;
+        VariableArrayBlockingQueue<W> queue;
         synchronized (this) {
             queue = this.pool.get(key);
         }
@@ -242,7 +241,7 @@ public class WorkPool<K, W> {
     }
 
     private boolean moreWorkItems(K key) {
-        VariableLinkedBlockingQueue<W> leList = this.pool.get(key);
+        VariableArrayBlockingQueue<W> leList = this.pool.get(key);
         return leList != null && !leList.isEmpty();
     }
 
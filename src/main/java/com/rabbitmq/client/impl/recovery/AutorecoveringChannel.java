@@ -17,8 +17,11 @@ package com.rabbitmq.client.impl.recovery;
 
 import com.rabbitmq.client.*;
 import com.rabbitmq.client.RecoverableChannel;
+import com.rabbitmq.client.impl.ReturnCallbackListener;
 
 import java.io.IOException;
+import java.io.InputStream;
+import java.nio.channels.FileChannel;
 import java.util.*;
 import java.util.concurrent.CompletableFuture;
 import java.util.concurrent.CopyOnWriteArrayList;
@@ -40,6 +43,14 @@ public class AutorecoveringChannel implements RecoverableChannel {
     private final Set<String> consumerTags = Collections.synchronizedSet(new HashSet<String>());
     private int prefetchCountConsumer;
     private int prefetchCountGlobal;
+    private int consumerDispatchWeight;
+    private int automaticPrefetchMin;
+    private int automaticPrefetchMax;
+    private int ackCoalescingBatchSize;
+    private long ackCoalescingDelayInMs;
+    private boolean returnCorrelation;
+    private int confirmWindow;
+    private long confirmWindowTimeoutInMs;
     private boolean usesPublisherConfirms;
     private boolean usesTransactions;
 
@@ -101,9 +112,7 @@ public class AutorecoveringChannel implements RecoverableChannel {
 
     @Override
     public ReturnListener addReturnListener(ReturnCallback returnCallback) {
-        ReturnListener returnListener = (replyCode, replyText, exchange, routingKey, properties, body) -> returnCallback.handle(new Return(
-            replyCode, replyText, exchange, routingKey, properties, body
-        ));
+        ReturnListener returnListener = new ReturnCallbackListener(returnCallback);
         this.addReturnListener(returnListener);
         return returnListener;
     }
@@ -168,6 +177,8 @@ public class AutorecoveringChannel implements RecoverableChannel {
 
     @Override
     public void basicQos(int prefetchSize, int prefetchCount, boolean global) throws IOException {
+        this.automaticPrefetchMin = 0;
+        this.automaticPrefetchMax = 0;
         if (global) {
             this.prefetchCountGlobal = prefetchCount;
         } else {
@@ -182,6 +193,26 @@ public class AutorecoveringChannel implements RecoverableChannel {
         basicQos(0, prefetchCount, false);
     }
 
+    @Override
+    public void setAutomaticPrefetch(int minPrefetchCount, int maxPrefetchCount) throws IOException {
+        delegate.setAutomaticPrefetch(minPrefetchCount, maxPrefetchCount);
+        this.automaticPrefetchMin = minPrefetchCount;
+        this.automaticPrefetchMax = maxPrefetchCount;
+    }
+
+    @Override
+    public void setAckCoalescing(int maxBatchSize, long maxDelayInMs) throws IOException {
+        delegate.setAckCoalescing(maxBatchSize, maxDelayInMs);
+        this.ackCoalescingBatchSize = maxBatchSize;
+        this.ackCoalescingDelayInMs = maxDelayInMs;
+    }
+
+    @Override
+    public void setConsumerDispatchWeight(int weight) {
+        delegate.setConsumerDispatchWeight(weight);
+        this.consumerDispatchWeight = weight;
+    }
+
     @Override
     public void basicQos(int prefetchCount, boolean global) throws IOException {
         basicQos(0, prefetchCount, global);
@@ -202,6 +233,67 @@ public class AutorecoveringChannel implements RecoverableChannel {
         delegate.basicPublish(exchange, routingKey, mandatory, immediate, props, body);
     }
 
+    @Override
+    public void basicPublish(String exchange, String routingKey, boolean mandatory, AMQP.BasicProperties props, InputStream body, long bodySize) throws IOException {
+        delegate.basicPublish(exchange, routingKey, mandatory, props, body, bodySize);
+    }
+
+    @Override
+    public void basicPublish(String exchange, String routingKey, boolean mandatory, AMQP.BasicProperties props, FileChannel body, long position, long bodySize) throws IOException {
+        delegate.basicPublish(exchange, routingKey, mandatory, props, body, position, bodySize);
+    }
+
+    @Override
+    public <T> void basicPublish(String exchange, String routingKey, boolean mandatory, AMQP.BasicProperties props, MessageCodec<T> codec, T message) throws IOException {
+        delegate.basicPublish(exchange, routingKey, mandatory, props, codec, message);
+    }
+
+    @Override
+    public CompletableFuture<Void> basicPublishAsync(String exchange, String routingKey, AMQP.BasicProperties props, byte[] body) throws IOException {
+        return delegate.basicPublishAsync(exchange, routingKey, props, body);
+    }
+
+    @Override
+    public CompletableFuture<Void> basicPublishAsync(String exchange, String routingKey, boolean mandatory, AMQP.BasicProperties props, byte[] body) throws IOException {
+        return delegate.basicPublishAsync(exchange, routingKey, mandatory, props, body);
+    }
+
+    @Override
+    public PreparedPublish preparePublish(final String exchange, final String routingKey, final boolean mandatory) throws IOException {
+        final Channel initial = delegate;
+        final PreparedPublish prepared = initial.preparePublish(exchange, routingKey, mandatory);
+        return new PreparedPublish() {
+            // the frames are encoded for a channel, prepare again on the recovered one
+            private Channel preparedOn = initial;
+            private PreparedPublish current = prepared;
+
+            @Override
+            public void publish(AMQP.BasicProperties props, byte[] body) throws IOException {
+                Channel channel = delegate;
+                if (channel != preparedOn) {
+                    current = channel.preparePublish(exchange, routingKey, mandatory);
+                    preparedOn = channel;
+                }
+                current.publish(props, body);
+            }
+
+            @Override
+            public String getExchange() {
+                return exchange;
+            }
+
+            @Override
+            public String getRoutingKey() {
+                return routingKey;
+            }
+
+            @Override
+            public boolean isMandatory() {
+                return mandatory;
+            }
+        };
+    }
+
     @Override
     public AMQP.Exchange.DeclareOk exchangeDeclare(String exchange, String type) throws IOException {
         return exchangeDeclare(exchange, type, false, false, null);
@@ -477,6 +569,11 @@ public class AutorecoveringChannel implements RecoverableChannel {
         return basicConsume(queue, autoAck, "", consumerFromDeliverCancelCallbacks(deliverCallback, cancelCallback));
     }
 
+    @Override
+    public <T> String basicConsume(String queue, boolean autoAck, MessageCodec<T> codec, TypedDeliverCallback<T> deliverCallback, CancelCallback cancelCallback) throws IOException {
+        return basicConsume(queue, autoAck, "", consumerFromTypedCallbacks(codec, deliverCallback, cancelCallback));
+    }
+
     @Override
     public String basicConsume(String queue, boolean autoAck, DeliverCallback deliverCallback, ConsumerShutdownSignalCallback shutdownSignalCallback)
         throws IOException {
@@ -587,6 +684,34 @@ public class AutorecoveringChannel implements RecoverableChannel {
         };
     }
 
+    private <T> Consumer consumerFromTypedCallbacks(final MessageCodec<T> codec, final TypedDeliverCallback<T> deliverCallback,
+                                                    final CancelCallback cancelCallback) {
+        return new Consumer() {
+
+            @Override
+            public void handleConsumeOk(String consumerTag) { }
+
+            @Override
+            public void handleCancelOk(String consumerTag) { }
+
+            @Override
+            public void handleCancel(String consumerTag) throws IOException {
+                cancelCallback.handle(consumerTag);
+            }
+
+            @Override
+            public void handleShutdownSignal(String consumerTag, ShutdownSignalException sig) { }
+
+            @Override
+            public void handleRecoverOk(String consumerTag) { }
+
+            @Override
+            public void handleDelivery(String consumerTag, Envelope envelope, AMQP.BasicProperties properties, byte[] body) throws IOException {
+                deliverCallback.handle(consumerTag, envelope, properties, codec.decode(properties, body));
+            }
+        };
+    }
+
     private Consumer consumerFromDeliverShutdownCallbacks(final DeliverCallback deliverCallback, final ConsumerShutdownSignalCallback shutdownSignalCallback) {
         return new Consumer() {
             @Override
@@ -687,6 +812,19 @@ public class AutorecoveringChannel implements RecoverableChannel {
         return delegate.getNextPublishSeqNo();
     }
 
+    @Override
+    public void setReturnCorrelation(boolean enabled) {
+        delegate.setReturnCorrelation(enabled);
+        this.returnCorrelation = enabled;
+    }
+
+    @Override
+    public void setConfirmWindow(int maxOutstandingConfirms, long timeoutInMs) {
+        delegate.setConfirmWindow(maxOutstandingConfirms, timeoutInMs);
+        this.confirmWindow = maxOutstandingConfirms;
+        this.confirmWindowTimeoutInMs = timeoutInMs;
+    }
+
     @Override
     public boolean waitForConfirms() throws InterruptedException {
         return delegate.waitForConfirms();
@@ -798,15 +936,33 @@ public class AutorecoveringChannel implements RecoverableChannel {
     }
 
     private void recoverState() throws IOException {
+        // basicQos resets the automatic prefetch settings
+        int automaticPrefetchMin = this.automaticPrefetchMin;
+        int automaticPrefetchMax = this.automaticPrefetchMax;
+        if (this.consumerDispatchWeight != 0) {
+            setConsumerDispatchWeight(this.consumerDispatchWeight);
+        }
+        if (this.ackCoalescingBatchSize > 1) {
+            setAckCoalescing(this.ackCoalescingBatchSize, this.ackCoalescingDelayInMs);
+        }
         if (this.prefetchCountConsumer != 0) {
             basicQos(this.prefetchCountConsumer, false);
         }
         if (this.prefetchCountGlobal != 0) {
             basicQos(this.prefetchCountGlobal, true);
         }
+        if (automaticPrefetchMin != 0) {
+            setAutomaticPrefetch(automaticPrefetchMin, automaticPrefetchMax);
+        }
         if(this.usesPublisherConfirms) {
             this.confirmSelect();
         }
+        if (this.returnCorrelation) {
+            setReturnCorrelation(true);
+        }
+        if (this.confirmWindow != 0) {
+            setConfirmWindow(this.confirmWindow, this.confirmWindowTimeoutInMs);
+        }
         if(this.usesTransactions) {
             this.txSelect();
         }
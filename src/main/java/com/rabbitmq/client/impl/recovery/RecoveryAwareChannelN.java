@@ -16,13 +16,13 @@
 package com.rabbitmq.client.impl.recovery;
 
 import com.rabbitmq.client.Command;
+import com.rabbitmq.client.GetResponse;
 import com.rabbitmq.client.NoOpMetricsCollector;
 import com.rabbitmq.client.MetricsCollector;
 import com.rabbitmq.client.impl.AMQConnection;
 import com.rabbitmq.client.impl.AMQImpl;
 import com.rabbitmq.client.impl.ChannelN;
 import com.rabbitmq.client.impl.ConsumerWorkService;
-import com.rabbitmq.client.impl.AMQImpl.Basic;
 
 import java.io.IOException;
 
@@ -90,51 +90,86 @@ public class RecoveryAwareChannelN extends ChannelN {
                                          method.getRoutingKey());
     }
 
+    @Override
+    public GetResponse basicGet(String queue, boolean autoAck) throws IOException {
+        GetResponse response = super.basicGet(queue, autoAck);
+        if (response != null) {
+            // get-ok and deliver share the same tag sequence
+            long tag = response.getEnvelope().getDeliveryTag() - activeDeliveryTagOffset;
+            if (tag > maxSeenDeliveryTag) {
+                maxSeenDeliveryTag = tag;
+            }
+        }
+        return response;
+    }
+
     @Override
     public void basicAck(long deliveryTag, boolean multiple) throws IOException {
-        long realTag = deliveryTag - activeDeliveryTagOffset;
-        // Last delivery is likely the same one a long running consumer is still processing,
-        // so realTag might end up being 0.
-        //  has a special meaning in the protocol ("acknowledge all unacknowledged tags),
-        // so if the user explicitly asks for that with multiple = true, do it.
-        if(multiple && deliveryTag == 0) {
-            // 0 tag means ack all when multiple is set
-            realTag = 0;
-        } else if(realTag <= 0) {
-            // delivery tags start at 1, so the real tag is stale
-            // therefore we should do nothing
+        if (isStale(deliveryTag, multiple)) {
             return;
         }
-        transmit(new Basic.Ack(realTag, multiple));
-        metricsCollector.basicAck(this, deliveryTag, multiple);
+        super.basicAck(deliveryTag, multiple);
     }
 
     @Override
     public void basicNack(long deliveryTag, boolean multiple, boolean requeue) throws IOException {
-        // See the comment in basicAck above.
-        long realTag = deliveryTag - activeDeliveryTagOffset;
-        if(multiple && deliveryTag == 0) {
-            // 0 tag means nack all when multiple is set
-            realTag = 0;
-        } else if(realTag <= 0) {
-            // delivery tags start at 1, so the real tag is stale
-            // therefore we should do nothing
+        // See the comment in isStale below.
+        if (isStale(deliveryTag, multiple)) {
             return;
         }
-        transmit(new Basic.Nack(realTag, multiple, requeue));
-        metricsCollector.basicNack(this, deliveryTag);
+        super.basicNack(deliveryTag, multiple, requeue);
     }
 
     @Override
     public void basicReject(long deliveryTag, boolean requeue) throws IOException {
-        // note that the basicAck comment above does not apply
+        // note that the multiple comment in isStale does not apply
         // here since basic.reject doesn't support rejecting
         // multiple deliveries at once
-        long realTag = deliveryTag - activeDeliveryTagOffset;
-        if (realTag > 0) {
-            transmit(new Basic.Reject(realTag, requeue));
-            metricsCollector.basicReject(this, deliveryTag);
+        if (isStale(deliveryTag, false)) {
+            return;
+        }
+        super.basicReject(deliveryTag, requeue);
+    }
+
+    // stale tags are filtered out by basicAck, basicNack and basicReject,
+    // the acknowledgements coalesced from them only cover tags of this channel
+
+    @Override
+    protected void transmitAck(long deliveryTag, boolean multiple) throws IOException {
+        super.transmitAck(realTag(deliveryTag, multiple), multiple);
+    }
+
+    @Override
+    protected void transmitNack(long deliveryTag, boolean multiple, boolean requeue) throws IOException {
+        super.transmitNack(realTag(deliveryTag, multiple), multiple, requeue);
+    }
+
+    @Override
+    protected void transmitReject(long deliveryTag, boolean requeue) throws IOException {
+        super.transmitReject(realTag(deliveryTag, false), requeue);
+    }
+
+    private boolean isStale(long deliveryTag, boolean multiple) {
+        // Last delivery is likely the same one a long running consumer is still processing,
+        // so realTag might end up being 0.
+        //  has a special meaning in the protocol ("acknowledge all unacknowledged tags),
+        // so if the user explicitly asks for that with multiple = true, do it.
+        if (multiple && deliveryTag == 0) {
+            return false;
         }
+        // delivery tags start at 1, so the real tag is stale
+        // therefore we should do nothing
+        return deliveryTag - activeDeliveryTagOffset <= 0;
+    }
+
+    private long realTag(long deliveryTag, boolean multiple) {
+        // 0 tag means ack all when multiple is set
+        return multiple && deliveryTag == 0 ? 0 : deliveryTag - activeDeliveryTagOffset;
+    }
+
+    @Override
+    protected long getDeliveryTagOffset() {
+        return activeDeliveryTagOffset;
     }
 
     void inheritOffsetFrom(RecoveryAwareChannelN other) {
@@ -0,0 +1,214 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import org.junit.Test;
+
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+
+import static java.util.Arrays.asList;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+
+public class AckCoalescerTest {
+
+    final List<String> sent = new ArrayList<>();
+    final AckCoalescer coalescer = new AckCoalescer(1, 3, 1000, (tag, multiple) -> sent.add(tag + (multiple ? "+" : "")));
+
+    @Test public void contiguousAcksAreSentAsMultiple() throws Exception {
+        deliver(1, 6);
+        assertTrue(coalescer.ack(1, false, 0));
+        assertTrue(coalescer.ack(2, false, 0));
+        assertEquals(0, sent.size());
+        assertFalse(coalescer.ack(3, false, 0));
+        assertEquals(asList("3+"), sent);
+    }
+
+    @Test public void outOfOrderAcksWaitForEarlierTags() throws Exception {
+        deliver(1, 6);
+        coalescer.ack(2, false, 0);
+        coalescer.ack(3, false, 0);
+        coalescer.ack(4, false, 0);
+        // 1 is not acknowledged yet, nothing can be covered
+        assertEquals(0, sent.size());
+        coalescer.ack(1, false, 0);
+        assertEquals(asList("4+"), sent);
+    }
+
+    @Test public void expiredAcksAreSentIndividuallyWhenNotContiguous() throws Exception {
+        deliver(1, 6);
+        coalescer.ack(1, false, 0);
+        coalescer.ack(3, false, 10);
+        assertEquals(-1, coalescer.flushIfDue(1000));
+        assertEquals(asList("1", "3"), sent);
+        assertFalse(coalescer.hasPendingAcks());
+    }
+
+    @Test public void autoAckDeliveriesDoNotBlockCoalescing() throws Exception {
+        coalescer.consumeOk("auto", true);
+        coalescer.delivered(1, "manual");
+        coalescer.delivered(2, "auto");
+        coalescer.delivered(3, "manual");
+        coalescer.delivered(4, "manual");
+        coalescer.ack(1, false, 0);
+        coalescer.ack(3, false, 0);
+        coalescer.ack(4, false, 0);
+        assertEquals(asList("4+"), sent);
+    }
+
+    @Test public void pendingAcksAreSentBeforeNegativeAcks() throws Exception {
+        deliver(1, 6);
+        coalescer.ack(1, false, 0);
+        coalescer.ack(2, false, 0);
+        coalescer.settle(3, false, (tag, multiple) -> sent.add("nack " + tag));
+        assertEquals(asList("2+", "nack 3"), sent);
+        coalescer.ack(4, false, 0);
+        coalescer.ack(5, false, 0);
+        coalescer.ack(6, false, 0);
+        assertEquals(asList("2+", "nack 3", "6+"), sent);
+    }
+
+    @Test public void multipleAckCoversOnlyDeliveredTags() throws Exception {
+        deliver(1, 4);
+        coalescer.ack(3, true, 0);
+        assertEquals(asList("3+"), sent);
+        coalescer.ack(4, false, 0);
+        coalescer.flush();
+        assertEquals(asList("3+", "4"), sent);
+    }
+
+    @Test public void ringGrowsBeyondInitialSize() throws Exception {
+        deliver(1, 200);
+        for (long tag = 200; tag >= 2; tag--) {
+            coalescer.ack(tag, false, 0);
+        }
+        assertEquals(0, sent.size());
+        coalescer.ack(1, false, 0);
+        assertEquals(asList("200+"), sent);
+    }
+
+    @Test public void skippedTagsAreNotCoveredByMultipleAcks() throws Exception {
+        deliver(1, 2);
+        // 3 is a get-ok not tracked yet
+        deliver(4, 6);
+        coalescer.ack(1, false, 0);
+        coalescer.ack(2, false, 0);
+        coalescer.ack(4, false, 0);
+        coalescer.ack(5, false, 0);
+        coalescer.ack(6, false, 0);
+        // 4 to 6 wait for 3
+        assertEquals(0, sent.size());
+        coalescer.flush();
+        assertEquals(asList("2+", "4", "5", "6"), sent);
+        // the application never acknowledged 3
+        coalescer.delivered(3, false);
+        deliver(7, 9);
+        coalescer.ack(7, false, 0);
+        coalescer.ack(8, false, 0);
+        coalescer.ack(9, false, 0);
+        coalescer.flush();
+        assertEquals(asList("2+", "4", "5", "6", "7", "8", "9"), sent);
+        coalescer.ack(3, false, 0);
+        coalescer.flush();
+        assertEquals(asList("2+", "4", "5", "6", "7", "8", "9", "3"), sent);
+    }
+
+    @Test public void skippedTagsCanBeSettledLate() throws Exception {
+        deliver(1, 1);
+        deliver(3, 4);
+        // get-ok with automatic acknowledgement, tracked after later deliveries
+        coalescer.delivered(2, false);
+        coalescer.autoAcked(2);
+        coalescer.ack(1, false, 0);
+        coalescer.ack(3, false, 0);
+        coalescer.ack(4, false, 0);
+        assertEquals(asList("4+"), sent);
+    }
+
+    @Test public void trackingStartsAtTheFirstTag() throws Exception {
+        AckCoalescer shifted = new AckCoalescer(1_000_000_001L, 3, 1000, (tag, multiple) -> sent.add(tag + (multiple ? "+" : "")));
+        for (long tag = 1_000_000_001L; tag <= 1_000_000_003L; tag++) {
+            shifted.delivered(tag, false);
+            shifted.ack(tag, false, 0);
+        }
+        assertEquals(asList("1000000003+"), sent);
+        // earlier tags are not tracked
+        shifted.ack(5, false, 0);
+        assertEquals(asList("1000000003+", "5"), sent);
+    }
+
+    @Test public void coalescingStopsWhenTooManyTagsAreOutstanding() throws Exception {
+        long max = AckCoalescer.MAX_TRACKED_TAGS;
+        // 1 is never acknowledged, the others wait behind it
+        deliver(1, max);
+        coalescer.ack(2, false, 0);
+        coalescer.ack(3, false, 0);
+        assertEquals(0, sent.size());
+        deliver(max + 1, max + 1);
+        // pending acknowledgements go first, then everything is sent right away
+        assertFalse(coalescer.ack(max + 1, false, 0));
+        assertEquals(asList("2", "3", String.valueOf(max + 1)), sent);
+        deliver(max + 2, max + 3);
+        coalescer.ack(max + 2, false, 0);
+        coalescer.ack(1, false, 0);
+        assertEquals(asList("2", "3", String.valueOf(max + 1), String.valueOf(max + 2), "1"), sent);
+        assertFalse(coalescer.hasPendingAcks());
+    }
+
+    @Test public void deliveriesAreTrackedWhileAcksAreSent() throws Exception {
+        CountDownLatch sending = new CountDownLatch(1);
+        CountDownLatch release = new CountDownLatch(1);
+        AckCoalescer blocking = new AckCoalescer(1, 2, 1000, (tag, multiple) -> {
+            sending.countDown();
+            try {
+                release.await();
+            } catch (InterruptedException e) {
+                Thread.currentThread().interrupt();
+            }
+        });
+        blocking.delivered(1, false);
+        blocking.delivered(2, false);
+        blocking.ack(1, false, 0);
+        Thread acker = new Thread(() -> {
+            try {
+                blocking.ack(2, false, 0);
+            } catch (IOException e) {
+                throw new RuntimeException(e);
+            }
+        });
+        acker.start();
+        assertTrue(sending.await(5, TimeUnit.SECONDS));
+        // the write is blocked, the connection thread must not be
+        Thread reader = new Thread(() -> blocking.delivered(3, false));
+        reader.start();
+        reader.join(5000);
+        assertFalse(reader.isAlive());
+        release.countDown();
+        acker.join(5000);
+        assertFalse(acker.isAlive());
+    }
+
+    private void deliver(long from, long to) {
+        for (long tag = from; tag <= to; tag++) {
+            coalescer.delivered(tag, false);
+        }
+    }
+}
@@ -0,0 +1,149 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import com.rabbitmq.client.AMQP;
+import org.junit.Test;
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.EOFException;
+import java.io.IOException;
+import java.math.BigDecimal;
+import java.nio.ByteBuffer;
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.Date;
+import java.util.HashMap;
+import java.util.Map;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.fail;
+
+/**
+ * Unit tests for {@link BufferValueReader}
+ */
+public class BufferValueReaderTest {
+
+    @Test public void methodsAreDecodedLikeWithStreams() throws IOException {
+        Method[] methods = {
+            new AMQImpl.Basic.Deliver("consumer-tag", 42L, true, "exchange", "routing.key"),
+            new AMQImpl.Queue.DeclareOk("queue", 10, 1),
+            new AMQImpl.Basic.Ack(1L << 40, true),
+            new AMQImpl.Connection.Start(0, 9, table(), LongStringHelper.asLongString("PLAIN"),
+                LongStringHelper.asLongString("en_US"))
+        };
+        for (Method method : methods) {
+            byte[] payload = method.toFrame(1).getPayload();
+            assertEquals(method, AMQImpl.readMethodFrom(ByteBuffer.wrap(payload)));
+            assertEquals(method, AMQImpl.readMethodFrom(direct(payload)));
+            assertEquals(AMQImpl.readMethodFrom(new DataInputStream(new ByteArrayInputStream(payload))),
+                AMQImpl.readMethodFrom(ByteBuffer.wrap(payload)));
+        }
+    }
+
+    @Test public void contentHeadersAreDecodedLikeWithStreams() throws IOException {
+        AMQP.BasicProperties props = new AMQP.BasicProperties.Builder()
+            .contentType("text/plain")
+            .deliveryMode(2)
+            .priority(5)
+            .timestamp(new Date(42000))
+            .headers(table())
+            .build();
+        byte[] payload = props.toFrame(1, 1000).getPayload();
+        for (ByteBuffer buffer : Arrays.asList(ByteBuffer.wrap(payload), direct(payload))) {
+            AMQContentHeader decoded = AMQImpl.readContentHeaderFrom(buffer);
+            assertEquals(1000, decoded.getBodySize());
+            assertEquals(props, decoded);
+        }
+    }
+
+    @Test public void tablesAreDecodedLikeWithStreams() throws IOException {
+        ByteArrayOutputStream bytes = new ByteArrayOutputStream();
+        ValueWriter writer = new ValueWriter(new DataOutputStream(bytes));
+        Map<String, Object> table = new HashMap<String, Object>(table());
+        table.put("bytes", new byte[] { 4, 2 });
+        writer.writeTable(table);
+        writer.writeShortstr("after");
+        byte[] encoded = bytes.toByteArray();
+
+        ValueReader streamReader = new ValueReader(new DataInputStream(new ByteArrayInputStream(encoded)));
+        ValueReader bufferReader = new BufferValueReader(ByteBuffer.wrap(encoded));
+        Map<String, Object> expected = streamReader.readTable();
+        Map<String, Object> actual = bufferReader.readTable();
+        assertArrayEquals((byte[]) expected.remove("bytes"), (byte[]) actual.remove("bytes"));
+        assertEquals(expected, actual);
+        assertEquals(streamReader.readShortstr(), bufferReader.readShortstr());
+    }
+
+    @Test public void truncatedValuesAreRejected() throws IOException {
+        byte[] payload = new AMQImpl.Basic.Deliver("consumer-tag", 42L, true, "exchange", "routing.key")
+            .toFrame(1).getPayload();
+        try {
+            AMQImpl.readMethodFrom(ByteBuffer.wrap(payload, 0, payload.length - 1));
+            fail("truncated method should be rejected");
+        } catch (EOFException e) {
+            // expected
+        }
+    }
+
+    @Test public void longStringsAreWrittenBackUnchanged() throws IOException {
+        Map<String, Object> headers = Collections.<String, Object>singletonMap("x-trace",
+            LongStringHelper.asLongString("trace-id-résumé"));
+        ByteArrayOutputStream bytes = new ByteArrayOutputStream();
+        new ValueWriter(new DataOutputStream(bytes)).writeTable(headers);
+        byte[] encoded = bytes.toByteArray();
+
+        Map<String, Object> read = new BufferValueReader(ByteBuffer.wrap(encoded)).readLazyTable();
+        assertEquals(headers.get("x-trace"), read.get("x-trace"));
+        assertEquals("trace-id-résumé", read.get("x-trace").toString());
+
+        bytes.reset();
+        new ValueWriter(new DataOutputStream(bytes)).writeTable(read);
+        assertArrayEquals(encoded, bytes.toByteArray());
+        byte[] rewritten = new byte[encoded.length];
+        new BufferValueWriter(rewritten, 0).writeTable(read);
+        assertArrayEquals(encoded, rewritten);
+    }
+
+    private static Map<String, Object> table() {
+        Map<String, Object> table = new HashMap<String, Object>();
+        table.put("string", LongStringHelper.asLongString("value"));
+        table.put("int", 42);
+        table.put("long", 42L);
+        table.put("short", (short) 42);
+        table.put("byte", (byte) 42);
+        table.put("double", 4.2d);
+        table.put("float", 4.2f);
+        table.put("boolean", true);
+        table.put("decimal", new BigDecimal("4.2"));
+        table.put("timestamp", new Date(42000));
+        table.put("void", null);
+        table.put("array", Arrays.<Object>asList(1, LongStringHelper.asLongString("two")));
+        table.put("nested", Collections.<String, Object>singletonMap("key", 42));
+        return table;
+    }
+
+    private static ByteBuffer direct(byte[] bytes) {
+        ByteBuffer buffer = ByteBuffer.allocateDirect(bytes.length);
+        buffer.put(bytes);
+        buffer.flip();
+        return buffer;
+    }
+}
@@ -0,0 +1,125 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client.impl;
+
+import org.junit.Test;
+
+import java.io.ByteArrayOutputStream;
+import java.io.DataOutputStream;
+import java.io.IOException;
+import java.math.BigDecimal;
+import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
+import java.util.Date;
+import java.util.LinkedHashMap;
+import java.util.Map;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.fail;
+
+/**
+ * Unit tests for {@link BufferValueWriter}
+ */
+public class BufferValueWriterTest {
+
+    private static final String[] STRINGS = {
+        "", "routing.key", "résumé", "日本語", "emoji 😀 pair",
+        "lone \uD800 high", "lone \uDC00 low", "trailing \uD83D"
+    };
+
+    @Test public void stringsAreEncodedLikeGetBytes() {
+        for (String str : STRINGS) {
+            byte[] expected = str.getBytes(StandardCharsets.UTF_8);
+            assertEquals(str, expected.length, BufferValueWriter.utf8Length(str));
+            byte[] encoded = new byte[expected.length + 2];
+            assertEquals(expected.length + 1, BufferValueWriter.encodeUtf8(str, encoded, 1));
+            assertArrayEquals(str, expected, Arrays.copyOfRange(encoded, 1, expected.length + 1));
+        }
+    }
+
+    @Test public void tablesAreEncodedLikeWithStreams() throws IOException {
+        Map<String, Object> nested = new LinkedHashMap<String, Object>();
+        nested.put("level", 2);
+        nested.put("name", "日本語");
+        nested.put("deeper", new LinkedHashMap<String, Object>(nested));
+        Map<String, Object> table = new LinkedHashMap<String, Object>();
+        for (int i = 0; i < STRINGS.length; i++) {
+            table.put("string" + i, STRINGS[i]);
+        }
+        table.put("longstr", LongStringHelper.asLongString("long string"));
+        table.put("int", 42);
+        table.put("decimal", new BigDecimal("12.345"));
+        table.put("timestamp", new Date(1500000000000L));
+        table.put("table", nested);
+        table.put("byte", (byte) -3);
+        table.put("double", 1.5d);
+        table.put("float", 2.5f);
+        table.put("long", Long.MIN_VALUE);
+        table.put("short", (short) -2);
+        table.put("boolean", true);
+        table.put("bytes", new byte[] { 1, 2, 3 });
+        table.put("void", null);
+        table.put("list", Arrays.<Object>asList(1, "two", nested));
+        table.put("array", new Object[] { "one", 2L });
+
+        ByteArrayOutputStream bytes = new ByteArrayOutputStream();
+        ValueWriter streamWriter = new ValueWriter(new DataOutputStream(bytes));
+        streamWriter.writeShortstr("résumé");
+        streamWriter.writeTable(table);
+        streamWriter.writeTable(null);
+        streamWriter.writeLongstr("日本語");
+        streamWriter.writeTimestamp(new Date(1500000000000L));
+        byte[] expected = bytes.toByteArray();
+
+        BufferValueWriter sizer = new BufferValueWriter();
+        sizer.writeShortstr("résumé");
+        sizer.writeTable(table);
+        sizer.writeTable(null);
+        sizer.writeLongstr("日本語");
+        sizer.writeTimestamp(new Date(1500000000000L));
+        assertEquals(expected.length, sizer.position());
+
+        byte[] encoded = new byte[expected.length + 3];
+        BufferValueWriter writer = new BufferValueWriter(encoded, 3);
+        writer.writeShortstr("résumé");
+        writer.writeTable(table);
+        writer.writeTable(null);
+        writer.writeLongstr("日本語");
+        writer.writeTimestamp(new Date(1500000000000L));
+        assertEquals(encoded.length, writer.position());
+        assertArrayEquals(expected, Arrays.copyOfRange(encoded, 3, encoded.length));
+        // the table length follows the short string
+        assertEquals(Frame.tableSize(table), tableLength(encoded, 3 + 1 + 8));
+    }
+
+    @Test public void tooLongShortStringsAreRejected() throws IOException {
+        char[] chars = new char[128];
+        Arrays.fill(chars, 'é');
+        try {
+            new BufferValueWriter().writeShortstr(new String(chars));
+            fail("short string of 256 bytes");
+        } catch (IllegalArgumentException e) {
+            // expected
+        }
+    }
+
+    private static int tableLength(byte[] bytes, int offset) {
+        return ((bytes[offset] & 0xff) << 24) | ((bytes[offset + 1] & 0xff) << 16) |
+            ((bytes[offset + 2] & 0xff) << 8) | (bytes[offset + 3] & 0xff);
+    }
+}
@@ -0,0 +1,117 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+
+/**
+ * Unit tests for {@link ConfirmTracker}
+ */
+public class ConfirmTrackerTest {
+
+    @Test public void multipleConfirmsRemoveRange() {
+        ConfirmTracker<String> tracker = new ConfirmTracker<>();
+        for (long seqNo = 1; seqNo <= 200; seqNo++) tracker.add(seqNo);
+        assertEquals(200, tracker.size());
+        assertEquals(1, tracker.remove(70, false));
+        assertEquals(0, tracker.remove(70, false));
+        // 1 to 100, without 70
+        assertEquals(99, tracker.remove(100, true));
+        assertFalse(tracker.contains(100));
+        assertTrue(tracker.contains(101));
+        assertEquals(0, tracker.remove(50, true));
+        assertEquals(100, tracker.remove(1000, true));
+        assertTrue(tracker.isEmpty());
+    }
+
+    @Test public void windowGrowsAcrossWrapAround() {
+        ConfirmTracker<String> tracker = new ConfirmTracker<>();
+        long seqNo = 1;
+        // move the window so that growing happens with a wrapped ring
+        for (; seqNo <= 1000; seqNo++) tracker.add(seqNo);
+        assertEquals(1000, tracker.remove(1000, true));
+        for (; seqNo <= 11000; seqNo++) tracker.add(seqNo);
+        assertEquals(10000, tracker.size());
+        for (long s = 1001; s < 11000; s += 2) {
+            assertEquals(1, tracker.remove(s, false));
+        }
+        for (long s = 1001; s <= 11000; s++) {
+            assertEquals(s % 2 == 0, tracker.contains(s));
+        }
+        assertEquals(5000, tracker.size());
+        assertEquals(2500, tracker.remove(6000, true));
+        assertEquals(2500, tracker.remove(11000, true));
+        assertTrue(tracker.isEmpty());
+    }
+
+    @Test public void gapsAreNotUnconfirmed() {
+        ConfirmTracker<String> tracker = new ConfirmTracker<>();
+        tracker.add(5);
+        tracker.add(3000);
+        assertEquals(2, tracker.size());
+        assertFalse(tracker.contains(6));
+        assertEquals(1, tracker.remove(5, false));
+        assertEquals(0, tracker.remove(2999, true));
+        assertEquals(1, tracker.remove(3000, true));
+        assertTrue(tracker.isEmpty());
+        tracker.add(10);
+        assertTrue(tracker.contains(10));
+        tracker.clear();
+        assertTrue(tracker.isEmpty());
+        assertFalse(tracker.contains(10));
+    }
+
+    @Test public void attachmentsAreHandedBackOnRemoval() {
+        ConfirmTracker<String> tracker = new ConfirmTracker<>();
+        tracker.add(1, "a");
+        tracker.add(2);
+        tracker.add(3, "c");
+        // grow the ring with attachments
+        for (long seqNo = 4; seqNo <= 2000; seqNo++) tracker.add(seqNo, seqNo == 1500 ? "d" : null);
+        tracker.add(2001, "e");
+        assertTrue(tracker.hasAttachments());
+        List<String> removed = new ArrayList<>();
+        assertEquals(3, tracker.remove(3, true, removed));
+        assertEquals(Arrays.asList("a", "c"), removed);
+        assertEquals("d", tracker.detach(1500));
+        assertNull(tracker.detach(1500));
+        assertTrue(tracker.contains(1500));
+        removed.clear();
+        assertEquals(1, tracker.remove(1500, false, removed));
+        assertTrue(removed.isEmpty());
+        tracker.clear(removed);
+        assertEquals(Arrays.asList("e"), removed);
+        assertFalse(tracker.hasAttachments());
+    }
+
+    @Test public void timestampsAreHandedBackOnRemoval() {
+        ConfirmTracker<String> tracker = new ConfirmTracker<>(true);
+        for (long seqNo = 1; seqNo <= 2000; seqNo++) tracker.add(seqNo, null, seqNo * 10);
+        List<Long> timestamps = new ArrayList<>();
+        assertEquals(1, tracker.remove(1500, false, null, timestamps::add));
+        assertEquals(3, tracker.remove(3, true, null, timestamps::add));
+        assertEquals(Arrays.asList(15000L, 10L, 20L, 30L), timestamps);
+    }
+}
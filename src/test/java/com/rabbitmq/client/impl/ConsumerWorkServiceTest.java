@@ -0,0 +1,109 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client.impl;
+
+import com.rabbitmq.client.Channel;
+import org.junit.After;
+import org.junit.Test;
+
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicReference;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeFalse;
+import static org.mockito.Mockito.mock;
+
+public class ConsumerWorkServiceTest {
+
+    ConsumerWorkService service;
+    ExecutorService userExecutor;
+
+    @After public void tearDown() {
+        if (service != null) {
+            service.shutdown();
+        }
+        if (userExecutor != null) {
+            userExecutor.shutdownNow();
+        }
+    }
+
+    @Test public void virtualThreadDispatchFallsBackToThreadPoolWithoutVirtualThreads() throws Exception {
+        assumeFalse(supportsVirtualThreads());
+        assertNull(ConsumerWorkService.newVirtualThreadPerTaskExecutor());
+
+        CountingThreadFactory threadFactory = new CountingThreadFactory("fallback");
+        service = new ConsumerWorkService(null, threadFactory, -1, 0, true);
+        assertTrue(service.usesPrivateExecutor());
+        assertEquals("fallback", runOnService());
+        assertEquals(1, threadFactory.created.get());
+    }
+
+    @Test public void userExecutorTakesPrecedenceOverVirtualThreadDispatch() throws Exception {
+        CountingThreadFactory threadFactory = new CountingThreadFactory("private");
+        userExecutor = Executors.newSingleThreadExecutor(new CountingThreadFactory("user"));
+        service = new ConsumerWorkService(userExecutor, threadFactory, -1, 0, true);
+        assertFalse(service.usesPrivateExecutor());
+        assertEquals("user", runOnService());
+        assertEquals(0, threadFactory.created.get());
+    }
+
+    private String runOnService() throws InterruptedException {
+        Channel channel = mock(Channel.class);
+        service.registerKey(channel);
+        AtomicReference<String> threadName = new AtomicReference<>();
+        CountDownLatch done = new CountDownLatch(1);
+        service.addWork(channel, () -> {
+            threadName.set(Thread.currentThread().getName());
+            done.countDown();
+        });
+        assertTrue(done.await(5, TimeUnit.SECONDS));
+        return threadName.get();
+    }
+
+    private static boolean supportsVirtualThreads() {
+        try {
+            Executors.class.getMethod("newVirtualThreadPerTaskExecutor");
+            return true;
+        } catch (NoSuchMethodException e) {
+            return false;
+        }
+    }
+
+    private static class CountingThreadFactory implements ThreadFactory {
+
+        private final String name;
+        private final AtomicInteger created = new AtomicInteger();
+
+        CountingThreadFactory(String name) {
+            this.name = name;
+        }
+
+        @Override
+        public Thread newThread(Runnable r) {
+            created.incrementAndGet();
+            return new Thread(r, name);
+        }
+    }
+}
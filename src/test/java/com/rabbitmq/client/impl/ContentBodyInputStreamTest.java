@@ -0,0 +1,127 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client.impl;
+
+import org.junit.Test;
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.util.Arrays;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertSame;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assert.fail;
+
+/**
+ * Unit tests for {@link ContentBodyInputStream}
+ */
+public class ContentBodyInputStreamTest {
+
+    @Test public void fragmentsAreReadInOrder() throws IOException {
+        ContentBodyInputStream stream = new ContentBodyInputStream(6);
+        stream.append("abc".getBytes());
+        stream.append(new byte[0]);
+        stream.append("def".getBytes());
+        assertEquals(6, stream.available());
+        assertEquals('a', stream.read());
+        assertEquals(1, stream.skip(1));
+        byte[] rest = new byte[10];
+        assertEquals(1, stream.read(rest, 0, rest.length));
+        assertEquals('c', rest[0]);
+        assertEquals(3, stream.read(rest, 1, rest.length - 1));
+        assertArrayEquals("cdef".getBytes(), Arrays.copyOf(rest, 4));
+        assertEquals(-1, stream.read());
+        assertEquals(-1, stream.read(rest, 0, rest.length));
+    }
+
+    @Test public void emptyBodyEndsRightAway() throws IOException {
+        ContentBodyInputStream stream = new ContentBodyInputStream(0);
+        assertEquals(-1, stream.read());
+        assertEquals(0, stream.available());
+    }
+
+    @Test public void appendWaitsForTheBodyToBeRead() throws Exception {
+        int fragmentCount = ContentBodyInputStream.CAPACITY * 4;
+        ContentBodyInputStream stream = new ContentBodyInputStream(fragmentCount);
+        AtomicInteger appended = new AtomicInteger();
+        CountDownLatch done = new CountDownLatch(1);
+        Thread reader = new Thread(() -> {
+            try {
+                for (int i = 0; i < fragmentCount; i++) {
+                    stream.append(new byte[] { (byte) i });
+                    appended.incrementAndGet();
+                }
+                done.countDown();
+            } catch (IOException e) {
+                // the test fails on the latch
+            }
+        });
+        reader.start();
+        assertFalse(done.await(200, TimeUnit.MILLISECONDS));
+        assertEquals(ContentBodyInputStream.CAPACITY, appended.get());
+
+        ByteArrayOutputStream read = new ByteArrayOutputStream();
+        int b;
+        while ((b = stream.read()) != -1) {
+            read.write(b);
+        }
+        assertTrue(done.await(5, TimeUnit.SECONDS));
+        byte[] body = read.toByteArray();
+        assertEquals(fragmentCount, body.length);
+        for (int i = 0; i < fragmentCount; i++) {
+            assertEquals((byte) i, body[i]);
+        }
+    }
+
+    @Test public void closedStreamDiscardsTheRestOfTheBody() throws IOException {
+        ContentBodyInputStream stream = new ContentBodyInputStream(ContentBodyInputStream.CAPACITY * 2);
+        for (int i = 0; i < ContentBodyInputStream.CAPACITY; i++) {
+            stream.append(new byte[] { 1 });
+        }
+        stream.close();
+        // does not wait
+        for (int i = 0; i < ContentBodyInputStream.CAPACITY; i++) {
+            stream.append(new byte[] { 1 });
+        }
+        try {
+            stream.read();
+            fail("stream is closed");
+        } catch (IOException e) {
+            // expected
+        }
+    }
+
+    @Test public void abortedStreamFailsAfterTheFragmentsReceived() throws IOException {
+        ContentBodyInputStream stream = new ContentBodyInputStream(10);
+        stream.append("abc".getBytes());
+        IOException cause = new IOException("channel closed");
+        stream.abort(cause);
+        assertEquals(3, stream.read(new byte[10], 0, 10));
+        try {
+            stream.read();
+            fail("body is incomplete");
+        } catch (IOException e) {
+            assertSame(cause, e.getCause());
+        }
+    }
+}
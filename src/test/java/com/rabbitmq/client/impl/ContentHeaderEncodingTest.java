@@ -0,0 +1,105 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import com.rabbitmq.client.AMQP;
+import org.junit.Test;
+
+import java.io.ByteArrayOutputStream;
+import java.io.DataOutputStream;
+import java.io.IOException;
+import java.math.BigDecimal;
+import java.nio.ByteBuffer;
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.Date;
+import java.util.HashMap;
+import java.util.Map;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+
+/**
+ * Tests for the cached encoding of {@link AMQContentHeader}
+ */
+public class ContentHeaderEncodingTest {
+
+    @Test public void cachedEncodingIsTheFullEncoding() throws IOException {
+        Map<String, Object> headers = new HashMap<String, Object>();
+        for (int i = 0; i < 20; i++) {
+            headers.put("header-" + i, i % 2 == 0 ? "value-" + i : (Object) i);
+        }
+        headers.put("decimal", new BigDecimal("1.5"));
+        headers.put("long-string", LongStringHelper.asLongString("long"));
+        AMQP.BasicProperties props = new AMQP.BasicProperties.Builder()
+            .contentType("application/json")
+            .deliveryMode(2)
+            .messageId("id")
+            .headers(headers)
+            .build();
+        long[] bodySizes = { 0, 1, 300, 70000, 1L << 40 };
+        for (long bodySize : bodySizes) {
+            // the first call caches the properties
+            assertArrayEquals(encode(props, bodySize), props.toFrame(1, bodySize).getPayload());
+        }
+    }
+
+    @Test public void mutableValuesAreEncodedForEachFrame() throws IOException {
+        Date timestamp = new Date(1000000);
+        AMQP.BasicProperties props = new AMQP.BasicProperties.Builder().timestamp(timestamp).build();
+        byte[] before = props.toFrame(1, 10).getPayload();
+        timestamp.setTime(2000000);
+        byte[] after = props.toFrame(1, 10).getPayload();
+        assertFalse(Arrays.equals(before, after));
+        assertArrayEquals(encode(props, 10), after);
+
+        byte[] value = { 1, 2, 3 };
+        props = new AMQP.BasicProperties.Builder()
+            .headers(Collections.<String, Object>singletonMap("bytes", value))
+            .build();
+        props.toFrame(1, 10);
+        value[0] = 42;
+        assertArrayEquals(encode(props, 10), props.toFrame(1, 10).getPayload());
+    }
+
+    @Test public void headersOfReceivedPropertiesAreEncodedForEachFrame() throws IOException {
+        Map<String, Object> headers = new HashMap<String, Object>();
+        headers.put("retries", 1);
+        AMQP.BasicProperties sent = new AMQP.BasicProperties.Builder().headers(headers).build();
+        AMQP.BasicProperties received = decode(sent.toFrame(1, 10).getPayload());
+        // republished, then republished again with an updated header
+        received.toFrame(1, 10);
+        received.getHeaders().put("retries", 2);
+        byte[] republished = received.toFrame(1, 10).getPayload();
+        assertArrayEquals(encode(received, 10), republished);
+        assertEquals(2, decode(republished).getHeaders().get("retries"));
+    }
+
+    private static AMQP.BasicProperties decode(byte[] payload) throws IOException {
+        return (AMQP.BasicProperties) AMQImpl.readContentHeaderFrom(ByteBuffer.wrap(payload));
+    }
+
+    private static byte[] encode(AMQContentHeader header, long bodySize) throws IOException {
+        ByteArrayOutputStream bytes = new ByteArrayOutputStream();
+        DataOutputStream out = new DataOutputStream(bytes);
+        out.writeShort(header.getClassId());
+        out.writeShort(0);
+        out.writeLong(bodySize);
+        header.writePropertiesTo(new ContentHeaderPropertyWriter(out));
+        return bytes.toByteArray();
+    }
+}
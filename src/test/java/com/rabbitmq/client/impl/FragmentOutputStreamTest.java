@@ -0,0 +1,62 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import org.junit.Test;
+
+import java.util.List;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+
+/**
+ * Unit tests for {@link FragmentOutputStream}
+ */
+public class FragmentOutputStreamTest {
+
+    @Test public void bodyIsSplitIntoFragments() {
+        FragmentOutputStream out = new FragmentOutputStream(1000);
+        byte[] body = new byte[2500];
+        for (int i = 0; i < body.length; i++) {
+            body[i] = (byte) i;
+        }
+        out.write(body[0]);
+        out.write(body, 1, 1499);
+        out.write(body, 1500, 1000);
+        assertEquals(2500, out.size());
+        List<byte[]> fragments = out.fragments();
+        assertEquals(3, fragments.size());
+        assertEquals(1000, fragments.get(0).length);
+        assertEquals(1000, fragments.get(1).length);
+        assertEquals(500, fragments.get(2).length);
+        assertArrayEquals(body, out.toByteArray());
+    }
+
+    @Test public void fullFragmentsAreNotTrimmed() {
+        FragmentOutputStream out = new FragmentOutputStream(1000);
+        out.write(new byte[2000], 0, 2000);
+        List<byte[]> fragments = out.fragments();
+        assertEquals(2, fragments.size());
+        assertEquals(1000, fragments.get(1).length);
+    }
+
+    @Test public void emptyBodyHasNoFragment() {
+        FragmentOutputStream out = new FragmentOutputStream(1000);
+        assertTrue(out.fragments().isEmpty());
+        assertEquals(0, out.toByteArray().length);
+    }
+}
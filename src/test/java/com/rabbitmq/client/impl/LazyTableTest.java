@@ -0,0 +1,126 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import com.rabbitmq.client.MalformedFrameException;
+import org.junit.Test;
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.IOException;
+import java.math.BigDecimal;
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.Date;
+import java.util.HashMap;
+import java.util.Map;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assert.fail;
+
+/**
+ * Unit tests for {@link LazyTable}
+ */
+public class LazyTableTest {
+
+    @Test public void lookupsDecodeTheRequestedValueOnly() throws IOException {
+        Map<String, Object> table = table();
+        Map<String, Object> lazy = readLazy(encode(table));
+        assertTrue(lazy instanceof LazyTable);
+        for (Map.Entry<String, Object> entry : table.entrySet()) {
+            if (entry.getValue() instanceof byte[]) {
+                assertArrayEquals((byte[]) entry.getValue(), (byte[]) lazy.get(entry.getKey()));
+            } else if (entry.getValue() instanceof String) {
+                assertEquals(entry.getValue(), lazy.get(entry.getKey()).toString());
+            } else {
+                assertEquals(entry.getKey(), entry.getValue(), lazy.get(entry.getKey()));
+            }
+            assertTrue(lazy.containsKey(entry.getKey()));
+        }
+        assertNull(lazy.get("missing"));
+        assertFalse(lazy.containsKey("missing"));
+        assertNull(lazy.get(42));
+        assertTrue(lazy.containsKey("void"));
+    }
+
+    @Test public void fullDecodingIsTheEagerDecoding() throws IOException {
+        byte[] encoded = encode(table());
+        Map<String, Object> lazy = readLazy(encoded);
+        Map<String, Object> eager = new ValueReader(new DataInputStream(new ByteArrayInputStream(encoded))).readTable();
+        assertEquals(eager.size(), lazy.size());
+        assertEquals(eager.keySet(), lazy.keySet());
+        assertEquals(eager.get("nested"), lazy.get("nested"));
+        // the decoded table backs the lazy one
+        lazy.put("added", 1);
+        assertEquals(1, lazy.get("added"));
+        lazy.remove("int");
+        assertFalse(lazy.containsKey("int"));
+        assertEquals(eager.size(), lazy.size());
+    }
+
+    @Test public void malformedTablesAreRejectedWhenRead() throws IOException {
+        byte[] encoded = encode(Collections.<String, Object>singletonMap("key", "value"));
+        // unknown type
+        byte[] unknownType = encoded.clone();
+        unknownType[4 + 1 + 3] = '?';
+        // long string longer than the table
+        byte[] truncated = encoded.clone();
+        truncated[4 + 1 + 3 + 4] = 100;
+        for (byte[] malformed : Arrays.asList(unknownType, truncated)) {
+            try {
+                readLazy(malformed);
+                fail("table should be rejected");
+            } catch (MalformedFrameException e) {
+                // expected
+            }
+        }
+    }
+
+    private static Map<String, Object> table() {
+        Map<String, Object> table = new HashMap<String, Object>();
+        table.put("string", "value");
+        table.put("int", 42);
+        table.put("long", 42L);
+        table.put("short", (short) 42);
+        table.put("byte", (byte) 42);
+        table.put("double", 4.2d);
+        table.put("float", 4.2f);
+        table.put("boolean", true);
+        table.put("decimal", new BigDecimal("4.2"));
+        table.put("timestamp", new Date(42000));
+        table.put("bytes", new byte[] { 4, 2 });
+        table.put("void", null);
+        table.put("array", Arrays.asList(1, 2));
+        table.put("nested", Collections.singletonMap("key", 42));
+        return table;
+    }
+
+    private static byte[] encode(Map<String, Object> table) throws IOException {
+        ByteArrayOutputStream bytes = new ByteArrayOutputStream();
+        new ValueWriter(new DataOutputStream(bytes)).writeTable(table);
+        return bytes.toByteArray();
+    }
+
+    private static Map<String, Object> readLazy(byte[] encoded) throws IOException {
+        return new ValueReader(new DataInputStream(new ByteArrayInputStream(encoded))).readLazyTable();
+    }
+}
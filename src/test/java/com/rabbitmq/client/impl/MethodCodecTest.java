@@ -0,0 +1,124 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client.impl;
+
+import com.rabbitmq.client.AMQP;
+import org.junit.Test;
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.Date;
+import java.util.List;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.fail;
+
+/**
+ * Unit tests for the generated fast paths of the most used methods,
+ * checked against the generic {@link MethodArgumentWriter} and
+ * {@link MethodArgumentReader}.
+ */
+public class MethodCodecTest {
+
+    @Test public void fastPathsMatchTheGenericCodec() throws IOException {
+        for (Method method : methods()) {
+            byte[] payload = method.toFrame(1).getPayload();
+            assertArrayEquals(method.toString(), genericEncoding(method), payload);
+            assertEquals(method, AMQImpl.readMethodFrom(ByteBuffer.wrap(payload)));
+            assertEquals(method, genericDecoding(payload));
+        }
+    }
+
+    @Test public void tooLongShortStringsAreRejected() throws IOException {
+        StringBuilder routingKey = new StringBuilder();
+        for (int i = 0; i < 128; i++) routingKey.append('é');
+        try {
+            new AMQImpl.Basic.Publish(0, "", routingKey.toString(), false, false).toFrame(1);
+            fail("short string of 256 bytes");
+        } catch (IllegalArgumentException e) {
+            // expected
+        }
+    }
+
+    @Test public void basicPropertiesAreDecodedDirectly() throws IOException {
+        AMQP.BasicProperties[] properties = {
+            new AMQP.BasicProperties(),
+            new AMQP.BasicProperties.Builder().contentType("text/plain").deliveryMode(2).priority(5).build(),
+            new AMQP.BasicProperties.Builder()
+                .headers(Collections.<String, Object>singletonMap("key", "value"))
+                .timestamp(new Date(1500000000000L))
+                .appId("app").clusterId("cluster").build()
+        };
+        for (AMQP.BasicProperties props : properties) {
+            byte[] payload = ((AMQContentHeader) props).toFrame(1, 10).getPayload();
+            AMQContentHeader decoded = AMQImpl.readContentHeaderFrom(ByteBuffer.wrap(payload));
+            assertEquals(props, decoded);
+            assertEquals(10, decoded.getBodySize());
+        }
+        byte[] payload = ((AMQContentHeader) properties[1]).toFrame(1, 10).getPayload();
+        payload[13] |= 1;
+        try {
+            AMQImpl.readContentHeaderFrom(ByteBuffer.wrap(payload));
+            fail("continuation flag word");
+        } catch (IOException e) {
+            // expected
+        }
+    }
+
+    private static List<Method> methods() {
+        List<Method> methods = new ArrayList<Method>();
+        for (int bits = 0; bits < 4; bits++) {
+            boolean first = (bits & 1) != 0, second = (bits & 2) != 0;
+            methods.add(new AMQImpl.Basic.Publish(0, "exchange", "routing.key", first, second));
+            methods.add(new AMQImpl.Basic.Publish(0, "", "résumé", first, second));
+            methods.add(new AMQImpl.Basic.Deliver("ctag", 1L << 40, first, "exchange", "routing.key"));
+            methods.add(new AMQImpl.Basic.Ack(bits, first));
+            methods.add(new AMQImpl.Basic.Nack(Long.MAX_VALUE - bits, first, second));
+        }
+        return methods;
+    }
+
+    private static byte[] genericEncoding(Method method) throws IOException {
+        ByteArrayOutputStream bytes = new ByteArrayOutputStream();
+        DataOutputStream out = new DataOutputStream(bytes);
+        out.writeShort(method.protocolClassId());
+        out.writeShort(method.protocolMethodId());
+        MethodArgumentWriter writer = new MethodArgumentWriter(new ValueWriter(out));
+        method.writeArgumentsTo(writer);
+        writer.flush();
+        return bytes.toByteArray();
+    }
+
+    private static Method genericDecoding(byte[] payload) throws IOException {
+        DataInputStream in = new DataInputStream(new ByteArrayInputStream(payload, 4, payload.length - 4));
+        MethodArgumentReader reader = new MethodArgumentReader(new ValueReader(in));
+        switch (payload[3]) {
+            case AMQImpl.Basic.Publish.INDEX: return new AMQImpl.Basic.Publish(reader);
+            case AMQImpl.Basic.Deliver.INDEX: return new AMQImpl.Basic.Deliver(reader);
+            case AMQImpl.Basic.Ack.INDEX: return new AMQImpl.Basic.Ack(reader);
+            case AMQImpl.Basic.Nack.INDEX: return new AMQImpl.Basic.Nack(reader);
+            default: throw new IllegalArgumentException("Unexpected method " + payload[3]);
+        }
+    }
+}
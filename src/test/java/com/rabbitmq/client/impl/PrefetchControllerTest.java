@@ -0,0 +1,84 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import org.junit.Test;
+
+import static java.util.concurrent.TimeUnit.MILLISECONDS;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.fail;
+
+public class PrefetchControllerTest {
+
+    long now = 0;
+
+    @Test public void prefetchCountCoversRoundTrip() {
+        PrefetchController controller = new PrefetchController(1, 1000, now);
+        controller.adjusted(MILLISECONDS.toNanos(10));
+        // 1 ms of processing, acknowledged 2 ms after dispatch
+        deliverAndAck(controller, 100, 1, 2);
+        now += PrefetchController.ADJUSTMENT_INTERVAL_NANOS;
+        // (10 + 2) / 1 * 1.25
+        assertEquals(15, controller.nextPrefetchCount(now));
+        // no new adjustment until the current one is applied
+        now += PrefetchController.ADJUSTMENT_INTERVAL_NANOS;
+        assertEquals(0, controller.nextPrefetchCount(now));
+        controller.adjusted(MILLISECONDS.toNanos(10));
+        assertEquals(15, controller.getPrefetchCount());
+    }
+
+    @Test public void slowConsumerGetsMinimumPrefetchCount() {
+        PrefetchController controller = new PrefetchController(2, 1000, now);
+        controller.adjusted(MILLISECONDS.toNanos(1));
+        deliverAndAck(controller, 20, 100, 100);
+        now += PrefetchController.ADJUSTMENT_INTERVAL_NANOS;
+        assertEquals(0, controller.nextPrefetchCount(now));
+        assertEquals(2, controller.getPrefetchCount());
+    }
+
+    @Test public void prefetchCountIsCappedAndNeedsSamples() {
+        PrefetchController controller = new PrefetchController(1, 50, now);
+        controller.adjusted(MILLISECONDS.toNanos(100));
+        deliverAndAck(controller, PrefetchController.MIN_SAMPLES - 1, 1, 1);
+        now += PrefetchController.ADJUSTMENT_INTERVAL_NANOS;
+        assertEquals(0, controller.nextPrefetchCount(now));
+        deliverAndAck(controller, 1, 1, 1);
+        assertEquals(50, controller.nextPrefetchCount(now));
+    }
+
+    @Test public void invalidRangesAreRejected() {
+        int[][] ranges = { { 0, 10 }, { -1, 10 }, { 10, 9 }, { 1, 65536 } };
+        for (int[] range : ranges) {
+            try {
+                new PrefetchController(range[0], range[1], now);
+                fail("invalid range [" + range[0] + ", " + range[1] + "]");
+            } catch (IllegalArgumentException e) {
+                // expected
+            }
+        }
+        assertEquals(10, new PrefetchController(10, 10, now).getPrefetchCount());
+    }
+
+    private void deliverAndAck(PrefetchController controller, int count, long processingMs, long holdMs) {
+        for (int i = 0; i < count; i++) {
+            long tag = i + 1;
+            long start = now;
+            controller.delivered(tag, start, start + MILLISECONDS.toNanos(processingMs));
+            controller.acknowledged(tag, start + MILLISECONDS.toNanos(holdMs));
+            now += MILLISECONDS.toNanos(holdMs);
+        }
+    }
+}
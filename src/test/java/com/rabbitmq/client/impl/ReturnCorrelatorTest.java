@@ -0,0 +1,103 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import com.rabbitmq.client.Return;
+import org.junit.Test;
+
+import java.util.List;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertSame;
+import static org.junit.Assert.assertTrue;
+
+/**
+ * Unit tests for {@link ReturnCorrelator}
+ */
+public class ReturnCorrelatorTest {
+
+    final ReturnCorrelator correlator = new ReturnCorrelator();
+
+    @Test public void returnsAreCorrelatedWithTheFollowingConfirm() {
+        // same exchange, routing key and body size, only the second one is unroutable
+        correlator.published(1);
+        correlator.published(2);
+        Return returned = returned();
+        correlator.returned(returned, true);
+        List<ReturnCorrelator.Correlated> correlated = correlator.confirmed(2, false, 0);
+        assertEquals(1, correlated.size());
+        assertEquals(2, correlated.get(0).returned.getPublishSeqNo());
+        assertSame(returned.getBody(), correlated.get(0).returned.getBody());
+        assertTrue(correlated.get(0).callListeners);
+        assertTrue(correlator.confirmed(1, false, 0).isEmpty());
+        assertEquals(0, correlator.size());
+    }
+
+    @Test public void multipleConfirmsCorrelateWhenUnambiguous() {
+        correlator.published(2);
+        correlator.published(3);
+        correlator.returned(returned(), false);
+        correlator.returned(returned(), false);
+        List<ReturnCorrelator.Correlated> correlated = correlator.confirmed(3, true, 0);
+        assertEquals(2, correlated.get(0).returned.getPublishSeqNo());
+        assertEquals(3, correlated.get(1).returned.getPublishSeqNo());
+        assertFalse(correlated.get(0).callListeners);
+    }
+
+    @Test public void ambiguousReturnsAreNotCorrelated() {
+        correlator.published(1);
+        correlator.published(2);
+        correlator.returned(returned(), true);
+        assertEquals(0, correlator.confirmed(2, true, 0).get(0).returned.getPublishSeqNo());
+        assertEquals(0, correlator.size());
+    }
+
+    @Test public void untrackedMessagesMakeMultipleConfirmsAmbiguous() {
+        correlator.published(2);
+        correlator.returned(returned(), false);
+        // 1 is mandatory but not tracked, it may be the returned message
+        assertEquals(0, correlator.confirmed(2, true, 1).get(0).returned.getPublishSeqNo());
+        correlator.published(3);
+        correlator.returned(returned(), false);
+        // 1 was confirmed by the previous confirm
+        assertEquals(3, correlator.confirmed(3, true, 1).get(0).returned.getPublishSeqNo());
+    }
+
+    @Test public void returnsOfUntrackedMessagesAreNotCorrelated() {
+        correlator.published(1);
+        correlator.returned(returned(), true);
+        assertEquals(0, correlator.confirmed(2, false, 0).get(0).returned.getPublishSeqNo());
+        assertEquals(1, correlator.size());
+    }
+
+    @Test public void confirmedMessagesAreForgotten() {
+        for (long seqNo = 1; seqNo <= 10; seqNo++) {
+            correlator.published(seqNo);
+        }
+        correlator.confirmed(5, false, 0);
+        correlator.confirmed(3, true, 0);
+        assertEquals(6, correlator.size());
+        correlator.returned(returned(), true);
+        assertEquals(1, correlator.clear().size());
+        assertEquals(0, correlator.size());
+        assertTrue(correlator.confirmed(10, true, 0).isEmpty());
+    }
+
+    private static Return returned() {
+        return new Return(312, "NO_ROUTE", "", "q", null, new byte[10]);
+    }
+}
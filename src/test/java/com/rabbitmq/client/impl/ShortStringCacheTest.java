@@ -0,0 +1,81 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client.impl;
+
+import org.junit.Test;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertSame;
+
+/**
+ * Unit tests for {@link ShortStringCache}
+ */
+public class ShortStringCacheTest {
+
+    @Test public void equalBytesGiveTheSameInstance() {
+        ShortStringCache cache = new ShortStringCache();
+        byte[] first = "amq.ctag-1".getBytes(StandardCharsets.UTF_8);
+        byte[] second = "xxamq.ctag-1yy".getBytes(StandardCharsets.UTF_8);
+        String decoded = cache.get(first, 0, first.length);
+        assertEquals("amq.ctag-1", decoded);
+        assertSame(decoded, cache.get(second, 2, first.length));
+        // the cache keeps its own copy of the bytes
+        first[0] = 'b';
+        assertEquals("bmq.ctag-1", cache.get(first, 0, first.length));
+        assertEquals("amq.ctag-1", cache.get(second, 2, first.length));
+    }
+
+    @Test public void nonAsciiStringsAreDecodedAsUtf8() {
+        ShortStringCache cache = new ShortStringCache();
+        String value = "résumé.日本";
+        byte[] bytes = value.getBytes(StandardCharsets.UTF_8);
+        assertEquals(value, cache.get(bytes, 0, bytes.length));
+        assertEquals(value, cache.get(bytes, 0, bytes.length));
+        assertEquals("", cache.get(bytes, 0, 0));
+    }
+
+    @Test public void replacedEntriesAreDecodedAgain() {
+        ShortStringCache cache = new ShortStringCache();
+        String[] values = new String[1000];
+        for (int i = 0; i < values.length; i++) {
+            byte[] bytes = ("key." + i).getBytes(StandardCharsets.UTF_8);
+            values[i] = cache.get(bytes, 0, bytes.length);
+        }
+        for (int i = 0; i < values.length; i++) {
+            byte[] bytes = ("key." + i).getBytes(StandardCharsets.UTF_8);
+            assertEquals(values[i], cache.get(bytes, 0, bytes.length));
+        }
+    }
+
+    @Test public void deliveriesShareDecodedStrings() throws IOException {
+        ShortStringCache cache = new ShortStringCache();
+        byte[] first = new AMQImpl.Basic.Deliver("ctag", 1L, false, "exchange", "routing.key").toFrame(1).getPayload();
+        byte[] second = new AMQImpl.Basic.Deliver("ctag", 2L, false, "exchange", "routing.key").toFrame(1).getPayload();
+        AMQImpl.Basic.Deliver d1 = (AMQImpl.Basic.Deliver) AMQImpl.readMethodFrom(
+            new BufferValueReader(ByteBuffer.wrap(first), cache));
+        AMQImpl.Basic.Deliver d2 = (AMQImpl.Basic.Deliver) AMQImpl.readMethodFrom(
+            new BufferValueReader(ByteBuffer.wrap(second), cache));
+        assertEquals(2L, d2.getDeliveryTag());
+        assertSame(d1.getConsumerTag(), d2.getConsumerTag());
+        assertSame(d1.getExchange(), d2.getExchange());
+        assertSame(d1.getRoutingKey(), d2.getRoutingKey());
+    }
+}
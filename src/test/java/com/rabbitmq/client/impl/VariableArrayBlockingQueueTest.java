@@ -0,0 +1,94 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.impl;
+
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+
+/**
+ * Unit tests for {@link VariableArrayBlockingQueue}
+ */
+public class VariableArrayBlockingQueueTest {
+
+    @Test public void fifoOrderAcrossGrowthAndWrapAround() throws Exception {
+        VariableArrayBlockingQueue<Integer> queue = new VariableArrayBlockingQueue<>(Integer.MAX_VALUE);
+        int next = 0;
+        // move the head so that growing happens with a wrapped ring
+        for (int i = 0; i < 10; i++) queue.put(i);
+        for (int i = 0; i < 10; i++) assertEquals(Integer.valueOf(next++), queue.poll());
+        for (int i = 10; i < 100; i++) queue.put(i);
+        assertEquals(90, queue.size());
+        List<Integer> drained = new ArrayList<>();
+        assertEquals(16, queue.drainTo(drained, 16));
+        for (Integer i : drained) assertEquals(Integer.valueOf(next++), i);
+        Integer i;
+        while ((i = queue.poll()) != null) {
+            assertEquals(Integer.valueOf(next++), i);
+        }
+        assertEquals(100, next);
+        assertTrue(queue.isEmpty());
+        assertNull(queue.poll());
+    }
+
+    @Test public void offerTimesOutWhenFull() throws Exception {
+        VariableArrayBlockingQueue<String> queue = new VariableArrayBlockingQueue<>(2);
+        assertTrue(queue.offer("a", 10, TimeUnit.MILLISECONDS));
+        assertTrue(queue.offer("b", 10, TimeUnit.MILLISECONDS));
+        assertFalse(queue.offer("c", 10, TimeUnit.MILLISECONDS));
+        assertEquals("a", queue.poll());
+        assertTrue(queue.offer("c", 10, TimeUnit.MILLISECONDS));
+    }
+
+    @Test public void raisingCapacityReleasesBlockedProducer() throws Exception {
+        final VariableArrayBlockingQueue<String> queue = new VariableArrayBlockingQueue<>(1);
+        queue.put("a");
+        final CountDownLatch done = new CountDownLatch(1);
+        Thread producer = new Thread(() -> {
+            try {
+                queue.put("b");
+                done.countDown();
+            } catch (InterruptedException e) {
+                Thread.currentThread().interrupt();
+            }
+        });
+        producer.start();
+        assertFalse(done.await(100, TimeUnit.MILLISECONDS));
+        queue.setCapacity(Integer.MAX_VALUE);
+        assertTrue(done.await(5, TimeUnit.SECONDS));
+        assertEquals(2, queue.size());
+    }
+
+    @Test public void loweringCapacityKeepsElements() throws Exception {
+        VariableArrayBlockingQueue<String> queue = new VariableArrayBlockingQueue<>(10);
+        for (int i = 0; i < 5; i++) queue.put("" + i);
+        queue.setCapacity(2);
+        assertEquals(5, queue.size());
+        assertFalse(queue.offer("x", 10, TimeUnit.MILLISECONDS));
+        List<String> drained = new ArrayList<>();
+        queue.drainTo(drained, 4);
+        assertEquals(4, drained.size());
+        assertTrue(queue.offer("x", 10, TimeUnit.MILLISECONDS));
+    }
+}
@@ -175,4 +175,31 @@ public class WorkPoolTests {
         List<Object> workList = new ArrayList<Object>(16);
         assertNull(this.pool.nextWorkBlock(workList, 1));
     }
+
+    /**
+     * Test clients get work in proportion to their weight.
+     * @throws Exception untested
+     */
+    @Test public void weightedShares() throws Exception {
+        this.pool.registerKey("low");
+        this.pool.registerKey("high");
+        this.pool.setWeight("high", 3);
+
+        for (int i = 0; i < 400; i++) {
+            this.pool.addWorkItem("low", new Object());
+            this.pool.addWorkItem("high", new Object());
+        }
+
+        int high = 0;
+        List<Object> workList = new ArrayList<Object>(16);
+        for (int i = 0; i < 400; i++) {
+            workList.clear();
+            String key = this.pool.nextWorkBlock(workList, 1);
+            if ("high".equals(key)) {
+                high++;
+            }
+            this.pool.finishWorkBlock(key);
+        }
+        assertTrue("High weight client should get 3/4 of the work, got " + high, high >= 290 && high <= 310);
+    }
 }
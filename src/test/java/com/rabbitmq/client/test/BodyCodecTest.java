@@ -0,0 +1,165 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client.test;
+
+import com.rabbitmq.client.AMQP;
+import com.rabbitmq.client.Channel;
+import com.rabbitmq.client.Connection;
+import com.rabbitmq.client.ConnectionFactory;
+import com.rabbitmq.client.DeflateBodyCodec;
+import com.rabbitmq.client.Delivery;
+import org.junit.Test;
+
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
+import java.util.List;
+import java.util.Random;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assert.fail;
+
+public class BodyCodecTest extends FakeBrokerTestCase {
+
+    @Test public void deflateCodecRoundTrip() throws IOException {
+        DeflateBodyCodec codec = new DeflateBodyCodec();
+        for (byte[] body : new byte[][] { new byte[0], json(100), json(100000) }) {
+            assertArrayEquals(body, codec.decode(codec.encode(body)));
+        }
+        assertTrue(codec.encode(json(100000)).length < 20000);
+        try {
+            codec.decode("not deflate".getBytes(StandardCharsets.US_ASCII));
+            fail("body is not deflate");
+        } catch (IOException e) {
+            // expected
+        }
+        byte[] encoded = codec.encode(json(10000));
+        try {
+            codec.decode(Arrays.copyOf(encoded, encoded.length / 2));
+            fail("body is truncated");
+        } catch (IOException e) {
+            // expected
+        }
+    }
+
+    @Test public void deflateCodecLimitsDecodedSize() throws IOException {
+        DeflateBodyCodec codec = new DeflateBodyCodec();
+        // a few KB that inflate to 10 MB
+        byte[] bomb = codec.encode(new byte[10 * 1024 * 1024]);
+        assertTrue(bomb.length < 100000);
+        try {
+            codec.decode(bomb, 1024 * 1024);
+            fail("decoded body is too big");
+        } catch (IOException e) {
+            // expected
+        }
+        assertArrayEquals(json(10000), codec.decode(codec.encode(json(10000)), 10000));
+    }
+
+    @Test public void bodiesTooBigOnceDecodedAreDeliveredAsIs() throws Exception {
+        ConnectionFactory connectionFactory = broker.connectionFactory();
+        connectionFactory.setBodyCodec(new DeflateBodyCodec());
+        connectionFactory.setBodyCodecMaxDecodedSize(5000);
+        try (Connection encoding = connectionFactory.newConnection()) {
+            Channel encodingChannel = encoding.createChannel();
+            encodingChannel.confirmSelect();
+            encodingChannel.basicPublish("", queue, null, json(10000));
+            encodingChannel.basicPublish("", queue, null, json(5000));
+            encodingChannel.waitForConfirmsOrDie(5000);
+
+            List<Delivery> deliveries = TestUtils.consume(encodingChannel, queue, 2);
+            assertEquals(DeflateBodyCodec.CONTENT_ENCODING, deliveries.get(0).getProperties().getContentEncoding());
+            assertArrayEquals(json(10000), new DeflateBodyCodec().decode(deliveries.get(0).getBody()));
+            assertArrayEquals(json(5000), deliveries.get(1).getBody());
+            assertNull(deliveries.get(1).getProperties().getContentEncoding());
+        }
+    }
+
+    @Test public void bodiesAreDecodedOnConnectionThread() throws Exception {
+        bodiesAreEncodedAndDecoded(false);
+    }
+
+    @Test public void bodiesAreDecodedOnDispatchThread() throws Exception {
+        bodiesAreEncodedAndDecoded(true);
+    }
+
+    @Test public void bodiesAreEncodedOnTheWire() throws Exception {
+        ConnectionFactory connectionFactory = broker.connectionFactory();
+        connectionFactory.setBodyCodec(new DeflateBodyCodec());
+        try (Connection encoding = connectionFactory.newConnection()) {
+            Channel encodingChannel = encoding.createChannel();
+            encodingChannel.confirmSelect();
+            encodingChannel.basicPublish("", queue, null, json(10000));
+            encodingChannel.waitForConfirmsOrDie(5000);
+        }
+        // the connection of the test has no codec
+        Delivery delivery = consume(1).get(0);
+        assertEquals(DeflateBodyCodec.CONTENT_ENCODING, delivery.getProperties().getContentEncoding());
+        assertTrue(delivery.getBody().length < 10000);
+        assertArrayEquals(json(10000), new DeflateBodyCodec().decode(delivery.getBody()));
+    }
+
+    private void bodiesAreEncodedAndDecoded(boolean onDispatchThread) throws Exception {
+        ConnectionFactory connectionFactory = broker.connectionFactory();
+        connectionFactory.setBodyCodec(new DeflateBodyCodec());
+        connectionFactory.setBodyDecodingOnDispatchThread(onDispatchThread);
+        try (Connection encoding = connectionFactory.newConnection()) {
+            Channel encodingChannel = encoding.createChannel();
+            AMQP.BasicProperties gzip = new AMQP.BasicProperties.Builder().contentEncoding("gzip").build();
+            encodingChannel.confirmSelect();
+            // big enough, too small, already encoded, does not compress
+            encodingChannel.basicPublish("", queue, null, json(10000));
+            encodingChannel.basicPublish("", queue, null, json(100));
+            encodingChannel.basicPublish("", queue, gzip, json(10000));
+            encodingChannel.basicPublish("", queue, null, random(10000));
+            // correlating returns does not change messages
+            encodingChannel.setReturnCorrelation(true);
+            encodingChannel.basicPublish("", queue, true, null, json(10000));
+            encodingChannel.waitForConfirmsOrDie(5000);
+
+            List<Delivery> deliveries = TestUtils.consume(encodingChannel, queue, 5);
+            assertArrayEquals(json(10000), deliveries.get(0).getBody());
+            assertNull(deliveries.get(0).getProperties().getContentEncoding());
+            assertArrayEquals(json(100), deliveries.get(1).getBody());
+            assertArrayEquals(json(10000), deliveries.get(2).getBody());
+            assertEquals("gzip", deliveries.get(2).getProperties().getContentEncoding());
+            assertArrayEquals(random(10000), deliveries.get(3).getBody());
+            assertNull(deliveries.get(3).getProperties().getContentEncoding());
+            assertArrayEquals(json(10000), deliveries.get(4).getBody());
+            assertNull(deliveries.get(4).getProperties().getContentEncoding());
+            assertNull(deliveries.get(4).getProperties().getHeaders());
+        }
+    }
+
+    private static byte[] json(int size) {
+        StringBuilder json = new StringBuilder("[");
+        for (int i = 0; json.length() < size - 1; i++) {
+            json.append(i == 0 ? "" : ",").append("{\"id\":").append(i).append(",\"status\":\"created\"}");
+        }
+        json.setLength(size - 1);
+        return json.append(']').toString().getBytes(StandardCharsets.US_ASCII);
+    }
+
+    private static byte[] random(int size) {
+        byte[] body = new byte[size];
+        new Random(42).nextBytes(body);
+        return body;
+    }
+}
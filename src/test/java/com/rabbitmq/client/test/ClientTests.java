@@ -17,6 +17,20 @@
 package com.rabbitmq.client.test;
 
 import com.rabbitmq.client.JacksonJsonRpcTest;
+import com.rabbitmq.client.impl.AckCoalescerTest;
+import com.rabbitmq.client.impl.BufferValueReaderTest;
+import com.rabbitmq.client.impl.BufferValueWriterTest;
+import com.rabbitmq.client.impl.ConfirmTrackerTest;
+import com.rabbitmq.client.impl.ContentBodyInputStreamTest;
+import com.rabbitmq.client.impl.ConsumerWorkServiceTest;
+import com.rabbitmq.client.impl.ContentHeaderEncodingTest;
+import com.rabbitmq.client.impl.FragmentOutputStreamTest;
+import com.rabbitmq.client.impl.LazyTableTest;
+import com.rabbitmq.client.impl.MethodCodecTest;
+import com.rabbitmq.client.impl.PrefetchControllerTest;
+import com.rabbitmq.client.impl.ReturnCorrelatorTest;
+import com.rabbitmq.client.impl.ShortStringCacheTest;
+import com.rabbitmq.client.impl.VariableArrayBlockingQueueTest;
 import com.rabbitmq.utility.IntAllocatorTests;
 import org.junit.runner.RunWith;
 import org.junit.runners.Suite;
@@ -64,7 +78,30 @@ import org.junit.runners.Suite;
     AddressTest.class,
     DefaultRetryHandlerTest.class,
     NioDeadlockOnConnectionClosing.class,
-    GeneratedClassesTest.class
+    GeneratedClassesTest.class,
+    VariableArrayBlockingQueueTest.class,
+    PrefetchControllerTest.class,
+    AckCoalescerTest.class,
+    ConfirmTrackerTest.class,
+    ReliablePublisherTest.class,
+    ReliablePublisherRecoveryTest.class,
+    FakeBrokerTest.class,
+    PreparedPublishTest.class,
+    ContentHeaderEncodingTest.class,
+    LazyTableTest.class,
+    BufferValueReaderTest.class,
+    ShortStringCacheTest.class,
+    MethodCodecTest.class,
+    BufferValueWriterTest.class,
+    ContentBodyInputStreamTest.class,
+    StreamingConsumerTest.class,
+    StreamingPublishTest.class,
+    BodyCodecTest.class,
+    FragmentOutputStreamTest.class,
+    MessageCodecTest.class,
+    ReturnCorrelatorTest.class,
+    ReturnCorrelationTest.class,
+    ConsumerWorkServiceTest.class
 })
 public class ClientTests {
 
@@ -90,4 +90,11 @@ public class ConnectionFactoryTest {
         assertTrue(createCalled.get());
     }
 
+    @Test public void virtualThreadDispatchIsPassedToConnectionParams() {
+        ConnectionFactory connectionFactory = new ConnectionFactory();
+        assertFalse(connectionFactory.params(null).isVirtualThreadDispatch());
+        connectionFactory.setVirtualThreadDispatch(true);
+        assertTrue(connectionFactory.params(null).isVirtualThreadDispatch());
+    }
+
 }
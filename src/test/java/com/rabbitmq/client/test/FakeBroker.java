@@ -0,0 +1,679 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.test;
+
+import com.rabbitmq.client.AMQP;
+import com.rabbitmq.client.ConnectionFactory;
+import com.rabbitmq.client.impl.AMQCommand;
+import com.rabbitmq.client.impl.AMQContentHeader;
+import com.rabbitmq.client.impl.AMQImpl;
+import com.rabbitmq.client.impl.Frame;
+import com.rabbitmq.client.impl.LongStringHelper;
+import com.rabbitmq.client.impl.Method;
+
+import java.io.BufferedInputStream;
+import java.io.BufferedOutputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.EOFException;
+import java.io.IOException;
+import java.net.InetAddress;
+import java.net.ServerSocket;
+import java.net.Socket;
+import java.net.SocketException;
+import java.util.ArrayDeque;
+import java.util.ArrayList;
+import java.util.Deque;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+import java.util.TreeMap;
+import java.util.UUID;
+import java.util.concurrent.BlockingQueue;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.LinkedBlockingQueue;
+
+/**
+ * Minimal in-process AMQP 0-9-1 broker, for tests and benchmarks
+ * that must not depend on a RabbitMQ node.
+ * <p>
+ * It uses the client's own frame and method codecs and supports:
+ * connection negotiation (any credentials are accepted), channels,
+ * queue declare, delete and purge, publishing to the default exchange,
+ * consuming with or without acknowledgments, <code>basic.qos</code>
+ * (per consumer), acks, nacks and rejects, mandatory returns and publisher confirms.
+ * Queues and messages are kept in memory. Any other method closes the connection
+ * with a <code>NOT_IMPLEMENTED</code> error.
+ * <p>
+ * {@link #killConnections()} closes the sockets of all the connections
+ * without the closing handshake, to simulate network failures.
+ * <p>
+ * Each connection is served by its own reader thread. Frames are written by
+ * another thread per connection, from a queue, so that a client that does not
+ * read its socket does not block other connections.
+ */
+public class FakeBroker implements AutoCloseable {
+
+    private static final int CHANNEL_MAX = 2047;
+    private static final int FRAME_MAX = 131072;
+
+    private final ServerSocket serverSocket;
+    private final Map<String, Queue> queues = new ConcurrentHashMap<String, Queue>();
+    private final Set<Connection> connections = ConcurrentHashMap.newKeySet();
+    private volatile boolean closed = false;
+    private volatile boolean confirmsHeld = false;
+
+    /**
+     * Start a broker on an ephemeral port of the loopback interface.
+     * @throws IOException if the port cannot be bound
+     */
+    public FakeBroker() throws IOException {
+        this(0);
+    }
+
+    /**
+     * Start a broker on the loopback interface.
+     * @param port the port to listen on, 0 for an ephemeral port
+     * @throws IOException if the port cannot be bound
+     */
+    public FakeBroker(int port) throws IOException {
+        this.serverSocket = new ServerSocket(port, 50, InetAddress.getLoopbackAddress());
+        Thread acceptor = new Thread(this::accept, "fake-broker-acceptor-" + getPort());
+        acceptor.setDaemon(true);
+        acceptor.start();
+    }
+
+    public int getPort() {
+        return serverSocket.getLocalPort();
+    }
+
+    public String getHost() {
+        return serverSocket.getInetAddress().getHostAddress();
+    }
+
+    /**
+     * @return a factory for connections to this broker, without automatic recovery
+     */
+    public ConnectionFactory connectionFactory() {
+        ConnectionFactory connectionFactory = new ConnectionFactory();
+        connectionFactory.setHost(getHost());
+        connectionFactory.setPort(getPort());
+        connectionFactory.setAutomaticRecoveryEnabled(false);
+        return connectionFactory;
+    }
+
+    /**
+     * @param queue the name of the queue
+     * @return the number of ready messages of the queue, or -1 if it does not exist
+     */
+    public int messageCount(String queue) {
+        Queue q = queues.get(queue);
+        return q == null ? -1 : q.messageCount();
+    }
+
+    /**
+     * Stop or resume sending publisher confirms, e.g. to kill connections
+     * with unconfirmed messages. Held confirms are never sent.
+     * @param held whether to hold confirms
+     */
+    public void holdConfirms(boolean held) {
+        this.confirmsHeld = held;
+    }
+
+    /**
+     * Close the sockets of all the connections, without notifying clients.
+     */
+    public void killConnections() {
+        for (Connection connection : connections) {
+            connection.closeSocket();
+        }
+    }
+
+    @Override
+    public void close() throws IOException {
+        closed = true;
+        serverSocket.close();
+        killConnections();
+    }
+
+    private void accept() {
+        while (!closed) {
+            try {
+                Socket socket = serverSocket.accept();
+                socket.setTcpNoDelay(true);
+                Connection connection = new Connection(socket);
+                connections.add(connection);
+                Thread thread = new Thread(connection::run, "fake-broker-connection-" + socket.getPort());
+                thread.setDaemon(true);
+                thread.start();
+                Thread writer = new Thread(connection::write, "fake-broker-writer-" + socket.getPort());
+                writer.setDaemon(true);
+                writer.start();
+            } catch (IOException e) {
+                // the server socket is closed
+            }
+        }
+    }
+
+    private static Map<String, Object> serverProperties() {
+        Map<String, Object> capabilities = new HashMap<String, Object>();
+        capabilities.put("publisher_confirms", true);
+        capabilities.put("basic.nack", true);
+        Map<String, Object> properties = new HashMap<String, Object>();
+        properties.put("product", "FakeBroker");
+        properties.put("capabilities", capabilities);
+        return properties;
+    }
+
+    private static class Message {
+        final String exchange;
+        final String routingKey;
+        final AMQContentHeader header;
+        final byte[] body;
+        boolean redelivered = false;
+
+        Message(String exchange, String routingKey, AMQContentHeader header, byte[] body) {
+            this.exchange = exchange;
+            this.routingKey = routingKey;
+            this.header = header;
+            this.body = body;
+        }
+    }
+
+    private static class Consumer {
+        final String tag;
+        final ChannelState channel;
+        final Queue queue;
+        final boolean noAck;
+        final int prefetch;
+        /** Guarded by the queue */
+        int unacked = 0;
+
+        Consumer(String tag, ChannelState channel, Queue queue, boolean noAck, int prefetch) {
+            this.tag = tag;
+            this.channel = channel;
+            this.queue = queue;
+            this.noAck = noAck;
+            this.prefetch = prefetch;
+        }
+
+        boolean available() {
+            return noAck || prefetch == 0 || unacked < prefetch;
+        }
+    }
+
+    private static class Unacked {
+        final Consumer consumer;
+        final Message message;
+
+        Unacked(Consumer consumer, Message message) {
+            this.consumer = consumer;
+            this.message = message;
+        }
+    }
+
+    private class Queue {
+        final String name;
+        final Connection owner;
+        final boolean autoDelete;
+        private final Deque<Message> messages = new ArrayDeque<Message>();
+        private final List<Consumer> consumers = new ArrayList<Consumer>();
+        private int nextConsumer = 0;
+
+        Queue(String name, Connection owner, boolean autoDelete) {
+            this.name = name;
+            this.owner = owner;
+            this.autoDelete = autoDelete;
+        }
+
+        synchronized int messageCount() {
+            return messages.size();
+        }
+
+        synchronized int consumerCount() {
+            return consumers.size();
+        }
+
+        synchronized void enqueue(Message message) {
+            messages.addLast(message);
+            dispatch();
+        }
+
+        synchronized void requeue(Consumer consumer, Message message) {
+            consumer.unacked--;
+            message.redelivered = true;
+            messages.addFirst(message);
+            dispatch();
+        }
+
+        synchronized void acked(Consumer consumer) {
+            consumer.unacked--;
+            dispatch();
+        }
+
+        synchronized void addConsumer(Consumer consumer) {
+            consumers.add(consumer);
+            dispatch();
+        }
+
+        synchronized void removeConsumer(Consumer consumer) {
+            consumers.remove(consumer);
+            if (autoDelete && consumers.isEmpty()) {
+                queues.remove(name, this);
+            }
+        }
+
+        synchronized int purge() {
+            int count = messages.size();
+            messages.clear();
+            return count;
+        }
+
+        /** Deliver ready messages to available consumers, round-robin. */
+        private void dispatch() {
+            while (!messages.isEmpty() && !consumers.isEmpty()) {
+                Consumer consumer = null;
+                for (int i = 0; i < consumers.size() && consumer == null; i++) {
+                    Consumer candidate = consumers.get((nextConsumer + i) % consumers.size());
+                    if (candidate.available()) {
+                        consumer = candidate;
+                        nextConsumer = (nextConsumer + i + 1) % consumers.size();
+                    }
+                }
+                if (consumer == null) {
+                    return;
+                }
+                Message message = messages.removeFirst();
+                if (!consumer.noAck) {
+                    consumer.unacked++;
+                }
+                consumer.channel.deliver(consumer, message);
+            }
+        }
+    }
+
+    private class ChannelState {
+        final int number;
+        final Connection connection;
+        boolean confirm = false;
+        long publishSeqNo = 0;
+        int prefetch = 0;
+        private long deliveryTag = 0;
+        private final TreeMap<Long, Unacked> unacked = new TreeMap<Long, Unacked>();
+        final Map<String, Consumer> consumers = new HashMap<String, Consumer>();
+
+        ChannelState(int number, Connection connection) {
+            this.number = number;
+            this.connection = connection;
+        }
+
+        /** Called with the lock of the queue of the consumer, sending does not block. */
+        void deliver(Consumer consumer, Message message) {
+            long tag;
+            synchronized (this) {
+                tag = ++deliveryTag;
+                if (!consumer.noAck) {
+                    unacked.put(tag, new Unacked(consumer, message));
+                }
+            }
+            connection.send(number, new AMQImpl.Basic.Deliver(consumer.tag, tag, message.redelivered,
+                message.exchange, message.routingKey), message.header, message.body);
+        }
+
+        void settle(long tag, boolean multiple, boolean requeue) {
+            List<Unacked> settled = new ArrayList<Unacked>();
+            synchronized (this) {
+                if (multiple) {
+                    Map<Long, Unacked> head = unacked.headMap(tag, true);
+                    settled.addAll(head.values());
+                    head.clear();
+                } else {
+                    Unacked u = unacked.remove(tag);
+                    if (u != null) {
+                        settled.add(u);
+                    }
+                }
+            }
+            for (Unacked u : settled) {
+                if (requeue) {
+                    u.consumer.queue.requeue(u.consumer, u.message);
+                } else {
+                    u.consumer.queue.acked(u.consumer);
+                }
+            }
+        }
+
+        /** Cancel the consumers and requeue the unacknowledged messages. */
+        void cleanUp() {
+            List<Consumer> cancelled;
+            synchronized (this) {
+                cancelled = new ArrayList<Consumer>(consumers.values());
+                consumers.clear();
+            }
+            for (Consumer consumer : cancelled) {
+                consumer.queue.removeConsumer(consumer);
+            }
+            settle(Long.MAX_VALUE, true, true);
+        }
+    }
+
+    private static class ChannelException extends Exception {
+        private static final long serialVersionUID = 1L;
+        final int code;
+
+        ChannelException(int code, String text) {
+            super(text);
+            this.code = code;
+        }
+    }
+
+    private class Connection {
+        /** Tells the writer to close the socket once the frames before it are written */
+        private final byte[] closeMarker = new byte[0];
+        private final Socket socket;
+        /** Written by the writer thread only */
+        private final DataOutputStream out;
+        /** Encoded frames waiting for the writer thread, in sending order */
+        private final BlockingQueue<byte[]> outbound = new LinkedBlockingQueue<byte[]>();
+        private final Map<Integer, AMQCommand> commands = new HashMap<Integer, AMQCommand>();
+        private final Map<Integer, ChannelState> channels = new ConcurrentHashMap<Integer, ChannelState>();
+        private volatile int frameMax = FRAME_MAX;
+        private boolean closing = false;
+
+        Connection(Socket socket) throws IOException {
+            this.socket = socket;
+            this.out = new DataOutputStream(new BufferedOutputStream(socket.getOutputStream()));
+        }
+
+        void run() {
+            try {
+                DataInputStream in = new DataInputStream(new BufferedInputStream(socket.getInputStream()));
+                byte[] protocolHeader = new byte[8];
+                in.readFully(protocolHeader);
+                send(0, new AMQImpl.Connection.Start(AMQP.PROTOCOL.MAJOR, AMQP.PROTOCOL.MINOR, serverProperties(),
+                    LongStringHelper.asLongString("PLAIN AMQPLAIN"), LongStringHelper.asLongString("en_US")));
+                while (!socket.isClosed()) {
+                    Frame frame = Frame.readFrom(in);
+                    if (frame == null) {
+                        continue;
+                    }
+                    if (frame.type == AMQP.FRAME_HEARTBEAT) {
+                        // the client sends heartbeats when idle, answer to keep it from timing out
+                        sendHeartbeat();
+                        continue;
+                    }
+                    AMQCommand command = commands.get(frame.channel);
+                    if (command == null) {
+                        command = new AMQCommand();
+                        commands.put(frame.channel, command);
+                    }
+                    if (command.handleFrame(frame)) {
+                        commands.remove(frame.channel);
+                        handle(frame.channel, command);
+                    }
+                }
+            } catch (EOFException | SocketException e) {
+                // connection closed
+            } catch (IOException e) {
+                closeSocket();
+            } finally {
+                connections.remove(this);
+                for (ChannelState channel : channels.values()) {
+                    channel.cleanUp();
+                }
+                channels.clear();
+                for (Queue queue : queues.values()) {
+                    if (queue.owner == this) {
+                        queues.remove(queue.name, queue);
+                    }
+                }
+                // stops the writer
+                outbound.add(closeMarker);
+            }
+        }
+
+        /** Write the queued frames, until the socket is closed. */
+        void write() {
+            try {
+                while (true) {
+                    byte[] frames = outbound.take();
+                    if (frames == closeMarker) {
+                        out.flush();
+                        closeSocket();
+                        return;
+                    }
+                    out.write(frames);
+                    if (outbound.isEmpty()) {
+                        out.flush();
+                    }
+                }
+            } catch (IOException | InterruptedException e) {
+                closeSocket();
+            }
+        }
+
+        private void handle(int channelNumber, AMQCommand command) throws IOException {
+            Method method = (Method) command.getMethod();
+            if (closing) {
+                if (method instanceof AMQP.Connection.CloseOk) {
+                    closeSocket();
+                }
+                return;
+            }
+            if (channelNumber == 0) {
+                handleConnectionMethod(method);
+                return;
+            }
+            ChannelState channel = channels.get(channelNumber);
+            if (channel == null) {
+                if (method instanceof AMQP.Channel.Open) {
+                    channels.put(channelNumber, new ChannelState(channelNumber, this));
+                    send(channelNumber, new AMQImpl.Channel.OpenOk(LongStringHelper.asLongString("")));
+                }
+                // otherwise the channel is closing, discard everything until close-ok
+                return;
+            }
+            try {
+                handleChannelMethod(channel, method, command);
+            } catch (ChannelException e) {
+                channels.remove(channelNumber);
+                channel.cleanUp();
+                send(channelNumber, new AMQImpl.Channel.Close(e.code, e.getMessage(),
+                    method.protocolClassId(), method.protocolMethodId()));
+            }
+        }
+
+        private void handleConnectionMethod(Method method) throws IOException {
+            if (method instanceof AMQP.Connection.StartOk) {
+                send(0, new AMQImpl.Connection.Tune(CHANNEL_MAX, FRAME_MAX, 0));
+            } else if (method instanceof AMQP.Connection.TuneOk) {
+                int negotiated = ((AMQP.Connection.TuneOk) method).getFrameMax();
+                frameMax = negotiated == 0 ? FRAME_MAX : negotiated;
+            } else if (method instanceof AMQP.Connection.Open) {
+                send(0, new AMQImpl.Connection.OpenOk(""));
+            } else if (method instanceof AMQP.Connection.Close) {
+                send(0, new AMQImpl.Connection.CloseOk());
+                outbound.add(closeMarker);
+            } else {
+                notImplemented(method);
+            }
+        }
+
+        private void handleChannelMethod(ChannelState channel, Method method, AMQCommand command)
+            throws IOException, ChannelException {
+            int n = channel.number;
+            if (method instanceof AMQP.Basic.Publish) {
+                publish(channel, (AMQP.Basic.Publish) method, command);
+            } else if (method instanceof AMQP.Basic.Ack) {
+                AMQP.Basic.Ack ack = (AMQP.Basic.Ack) method;
+                channel.settle(ack.getDeliveryTag(), ack.getMultiple(), false);
+            } else if (method instanceof AMQP.Basic.Nack) {
+                AMQP.Basic.Nack nack = (AMQP.Basic.Nack) method;
+                channel.settle(nack.getDeliveryTag(), nack.getMultiple(), nack.getRequeue());
+            } else if (method instanceof AMQP.Basic.Reject) {
+                AMQP.Basic.Reject reject = (AMQP.Basic.Reject) method;
+                channel.settle(reject.getDeliveryTag(), false, reject.getRequeue());
+            } else if (method instanceof AMQP.Basic.Consume) {
+                AMQP.Basic.Consume consume = (AMQP.Basic.Consume) method;
+                Queue queue = queue(consume.getQueue());
+                String tag = consume.getConsumerTag().isEmpty() ?
+                    "amq.ctag-" + UUID.randomUUID() : consume.getConsumerTag();
+                Consumer consumer = new Consumer(tag, channel, queue, consume.getNoAck(), channel.prefetch);
+                synchronized (channel) {
+                    channel.consumers.put(tag, consumer);
+                }
+                if (!consume.getNowait()) {
+                    send(n, new AMQImpl.Basic.ConsumeOk(tag));
+                }
+                queue.addConsumer(consumer);
+            } else if (method instanceof AMQP.Basic.Cancel) {
+                AMQP.Basic.Cancel cancel = (AMQP.Basic.Cancel) method;
+                Consumer consumer;
+                synchronized (channel) {
+                    consumer = channel.consumers.remove(cancel.getConsumerTag());
+                }
+                if (consumer != null) {
+                    consumer.queue.removeConsumer(consumer);
+                }
+                if (!cancel.getNowait()) {
+                    send(n, new AMQImpl.Basic.CancelOk(cancel.getConsumerTag()));
+                }
+            } else if (method instanceof AMQP.Basic.Qos) {
+                channel.prefetch = ((AMQP.Basic.Qos) method).getPrefetchCount();
+                send(n, new AMQImpl.Basic.QosOk());
+            } else if (method instanceof AMQP.Queue.Declare) {
+                declare(channel, (AMQP.Queue.Declare) method);
+            } else if (method instanceof AMQP.Queue.Delete) {
+                AMQP.Queue.Delete delete = (AMQP.Queue.Delete) method;
+                Queue queue = queues.remove(delete.getQueue());
+                int count = queue == null ? 0 : queue.purge();
+                if (!delete.getNowait()) {
+                    send(n, new AMQImpl.Queue.DeleteOk(count));
+                }
+            } else if (method instanceof AMQP.Queue.Purge) {
+                AMQP.Queue.Purge purge = (AMQP.Queue.Purge) method;
+                int count = queue(purge.getQueue()).purge();
+                if (!purge.getNowait()) {
+                    send(n, new AMQImpl.Queue.PurgeOk(count));
+                }
+            } else if (method instanceof AMQP.Confirm.Select) {
+                channel.confirm = true;
+                if (!((AMQP.Confirm.Select) method).getNowait()) {
+                    send(n, new AMQImpl.Confirm.SelectOk());
+                }
+            } else if (method instanceof AMQP.Channel.Close) {
+                channels.remove(n);
+                channel.cleanUp();
+                send(n, new AMQImpl.Channel.CloseOk());
+            } else if (method instanceof AMQP.Channel.CloseOk) {
+                channels.remove(n);
+                channel.cleanUp();
+            } else {
+                notImplemented(method);
+            }
+        }
+
+        private void publish(ChannelState channel, AMQP.Basic.Publish publish, AMQCommand command) {
+            Queue queue = publish.getExchange().isEmpty() ? queues.get(publish.getRoutingKey()) : null;
+            Message message = new Message(publish.getExchange(), publish.getRoutingKey(),
+                command.getContentHeader(), command.getContentBody());
+            if (queue != null) {
+                queue.enqueue(message);
+            } else if (publish.getMandatory()) {
+                send(channel.number, new AMQImpl.Basic.Return(AMQP.NO_ROUTE, "NO_ROUTE",
+                    message.exchange, message.routingKey), message.header, message.body);
+            }
+            if (channel.confirm) {
+                long seqNo = ++channel.publishSeqNo;
+                if (!confirmsHeld) {
+                    send(channel.number, new AMQImpl.Basic.Ack(seqNo, false));
+                }
+            }
+        }
+
+        private void declare(ChannelState channel, AMQP.Queue.Declare declare) throws ChannelException {
+            String name = declare.getQueue().isEmpty() ? "amq.gen-" + UUID.randomUUID() : declare.getQueue();
+            Queue queue;
+            if (declare.getPassive()) {
+                queue = queue(name);
+            } else {
+                queue = queues.computeIfAbsent(name,
+                    k -> new Queue(k, declare.getExclusive() ? this : null, declare.getAutoDelete()));
+            }
+            if (!declare.getNowait()) {
+                send(channel.number, new AMQImpl.Queue.DeclareOk(name, queue.messageCount(), queue.consumerCount()));
+            }
+        }
+
+        private Queue queue(String name) throws ChannelException {
+            Queue queue = queues.get(name);
+            if (queue == null) {
+                throw new ChannelException(AMQP.NOT_FOUND, "NOT_FOUND - no queue '" + name + "'");
+            }
+            return queue;
+        }
+
+        private void notImplemented(Method method) {
+            closing = true;
+            send(0, new AMQImpl.Connection.Close(AMQP.NOT_IMPLEMENTED,
+                "NOT_IMPLEMENTED - " + method.protocolMethodName() + " is not supported",
+                method.protocolClassId(), method.protocolMethodId()));
+        }
+
+        void sendHeartbeat() {
+            // type, channel 0, empty payload, end marker
+            outbound.add(new byte[] { AMQP.FRAME_HEARTBEAT, 0, 0, 0, 0, 0, 0, (byte) AMQP.FRAME_END });
+        }
+
+        void send(int channelNumber, Method method) {
+            send(channelNumber, method, null, null);
+        }
+
+        /**
+         * Queue a command for the writer thread, splitting the body according
+         * to the negotiated frame size. Does not block.
+         */
+        void send(int channelNumber, Method method, AMQContentHeader header, byte[] body) {
+            ByteArrayOutputStream encoded = new ByteArrayOutputStream();
+            DataOutputStream frames = new DataOutputStream(encoded);
+            try {
+                method.toFrame(channelNumber).writeTo(frames);
+                if (header != null) {
+                    header.toFrame(channelNumber, body.length).writeTo(frames);
+                    int fragmentMax = frameMax - AMQCommand.EMPTY_FRAME_SIZE;
+                    for (int offset = 0; offset < body.length; offset += fragmentMax) {
+                        int length = Math.min(fragmentMax, body.length - offset);
+                        Frame.fromBodyFragment(channelNumber, body, offset, length).writeTo(frames);
+                    }
+                }
+            } catch (IOException e) {
+                // not thrown when writing to memory
+                throw new IllegalStateException(e);
+            }
+            outbound.add(encoded.toByteArray());
+        }
+
+        void closeSocket() {
+            try {
+                socket.close();
+            } catch (IOException e) {
+                // ignored
+            }
+        }
+    }
+}
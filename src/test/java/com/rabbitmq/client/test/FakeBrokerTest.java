@@ -0,0 +1,164 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.test;
+
+import com.rabbitmq.client.AMQP;
+import com.rabbitmq.client.Channel;
+import com.rabbitmq.client.Connection;
+import com.rabbitmq.client.ConnectionFactory;
+import com.rabbitmq.client.DefaultConsumer;
+import com.rabbitmq.client.Envelope;
+import com.rabbitmq.client.Recoverable;
+import com.rabbitmq.client.RecoveryListener;
+import com.rabbitmq.client.ShutdownSignalException;
+import org.junit.After;
+import org.junit.Before;
+import org.junit.Test;
+
+import java.io.IOException;
+import java.util.Arrays;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assert.fail;
+
+public class FakeBrokerTest {
+
+    FakeBroker broker;
+
+    @Before public void init() throws IOException {
+        broker = new FakeBroker();
+    }
+
+    @After public void tearDown() throws IOException {
+        broker.close();
+    }
+
+    @Test public void publishConsumeAckBlockingIo() throws Exception {
+        publishConsumeAck(false);
+    }
+
+    @Test public void publishConsumeAckNio() throws Exception {
+        publishConsumeAck(true);
+    }
+
+    @Test public void passiveDeclareOfMissingQueueClosesChannel() throws Exception {
+        try (Connection connection = connectionFactory(false).newConnection()) {
+            Channel channel = connection.createChannel();
+            try {
+                channel.queueDeclarePassive("does-not-exist");
+                fail("queue should not exist");
+            } catch (IOException e) {
+                ShutdownSignalException sse = (ShutdownSignalException) e.getCause();
+                assertEquals(AMQP.NOT_FOUND, ((AMQP.Channel.Close) sse.getReason()).getReplyCode());
+            }
+            assertFalse(channel.isOpen());
+            assertTrue(connection.createChannel().isOpen());
+        }
+    }
+
+    @Test public void unroutableMandatoryMessagesAreReturned() throws Exception {
+        try (Connection connection = connectionFactory(false).newConnection()) {
+            Channel channel = connection.createChannel();
+            CountDownLatch returned = new CountDownLatch(1);
+            channel.addReturnListener(r -> {
+                if (r.getReplyCode() == AMQP.NO_ROUTE) {
+                    returned.countDown();
+                }
+            });
+            channel.confirmSelect();
+            channel.basicPublish("", "does-not-exist", true, null, "hello".getBytes());
+            channel.waitForConfirmsOrDie(5000);
+            assertTrue(returned.await(5, TimeUnit.SECONDS));
+        }
+    }
+
+    @Test public void killedConnectionsRecover() throws Exception {
+        ConnectionFactory connectionFactory = connectionFactory(false);
+        connectionFactory.setAutomaticRecoveryEnabled(true);
+        connectionFactory.setNetworkRecoveryInterval(100);
+        try (Connection connection = connectionFactory.newConnection()) {
+            Channel channel = connection.createChannel();
+            CountDownLatch recovered = new CountDownLatch(1);
+            ((Recoverable) connection).addRecoveryListener(new RecoveryListener() {
+
+                @Override
+                public void handleRecovery(Recoverable recoverable) {
+                    recovered.countDown();
+                }
+
+                @Override
+                public void handleRecoveryStarted(Recoverable recoverable) {
+                }
+            });
+            broker.killConnections();
+            assertTrue(recovered.await(10, TimeUnit.SECONDS));
+            String queue = channel.queueDeclare().getQueue();
+            assertEquals(0, broker.messageCount(queue));
+        }
+    }
+
+    private void publishConsumeAck(boolean nio) throws Exception {
+        try (Connection connection = connectionFactory(nio).newConnection()) {
+            Channel channel = connection.createChannel();
+            String queue = channel.queueDeclare().getQueue();
+            channel.confirmSelect();
+            int messageCount = 100;
+            // bigger than the frame size
+            byte[] large = new byte[300 * 1024];
+            Arrays.fill(large, (byte) 'x');
+            for (int i = 0; i < messageCount; i++) {
+                byte[] body = i == 0 ? large : String.valueOf(i).getBytes();
+                channel.basicPublish("", queue, new AMQP.BasicProperties.Builder().messageId(String.valueOf(i)).build(), body);
+            }
+            channel.waitForConfirmsOrDie(5000);
+            assertEquals(messageCount, broker.messageCount(queue));
+
+            channel.basicQos(10);
+            CountDownLatch delivered = new CountDownLatch(messageCount);
+            channel.basicConsume(queue, false, new DefaultConsumer(channel) {
+                @Override
+                public void handleDelivery(String consumerTag, Envelope envelope, AMQP.BasicProperties properties, byte[] body) throws IOException {
+                    int i = Integer.parseInt(properties.getMessageId());
+                    if (i == 0) {
+                        assertArrayEquals(large, body);
+                    } else {
+                        assertEquals(String.valueOf(i), new String(body));
+                    }
+                    assertEquals(messageCount - delivered.getCount() + 1, envelope.getDeliveryTag());
+                    getChannel().basicAck(envelope.getDeliveryTag(), false);
+                    delivered.countDown();
+                }
+            });
+            assertTrue(delivered.await(5, TimeUnit.SECONDS));
+            assertEquals(0, broker.messageCount(queue));
+        }
+    }
+
+    private ConnectionFactory connectionFactory(boolean nio) {
+        ConnectionFactory connectionFactory = broker.connectionFactory();
+        if (nio) {
+            connectionFactory.useNio();
+        } else {
+            connectionFactory.useBlockingIo();
+        }
+        return connectionFactory;
+    }
+}
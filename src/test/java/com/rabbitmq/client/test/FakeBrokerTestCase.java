@@ -0,0 +1,61 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client.test;
+
+import com.rabbitmq.client.Channel;
+import com.rabbitmq.client.Connection;
+import com.rabbitmq.client.Delivery;
+import org.junit.After;
+import org.junit.Before;
+
+import java.util.List;
+
+/**
+ * Base class for tests against a {@link FakeBroker}.
+ * Each test gets its own broker, a connection, a channel
+ * and a server-named queue.
+ */
+public abstract class FakeBrokerTestCase {
+
+    protected FakeBroker broker;
+    protected Connection connection;
+    protected Channel channel;
+    protected String queue;
+
+    @Before public void setUp() throws Exception {
+        broker = new FakeBroker();
+        connection = broker.connectionFactory().newConnection();
+        channel = connection.createChannel();
+        queue = channel.queueDeclare().getQueue();
+    }
+
+    @After public void tearDown() throws Exception {
+        if (connection != null && connection.isOpen()) {
+            connection.close();
+        }
+        broker.close();
+    }
+
+    /**
+     * Consume messages from the queue of the test with automatic acknowledgement.
+     * @param count the number of messages to wait for
+     * @return the deliveries, in order
+     */
+    protected List<Delivery> consume(int count) throws Exception {
+        return TestUtils.consume(channel, queue, count);
+    }
+}
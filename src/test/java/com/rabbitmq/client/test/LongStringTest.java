@@ -19,9 +19,17 @@ import com.rabbitmq.client.LongString;
 import com.rabbitmq.client.impl.LongStringHelper;
 import org.junit.Test;
 
+import java.io.DataInputStream;
+import java.io.IOException;
 import java.io.UnsupportedEncodingException;
+import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
 
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertSame;
 import static org.junit.Assert.assertTrue;
+import static org.junit.Assert.fail;
 
 public class LongStringTest {
 
@@ -32,4 +40,32 @@ public class LongStringTest {
         assertTrue(ls.toString().equals(s));
         assertTrue(ls.toString().equals(new String(ls.getBytes(), "UTF-8")));
     }
+
+    @Test public void slices() throws IOException {
+        byte[] bytes = "--résumé--".getBytes(StandardCharsets.UTF_8);
+        LongString slice = LongStringHelper.asLongString(bytes, 2, bytes.length - 4);
+        LongString whole = LongStringHelper.asLongString("résumé");
+
+        assertEquals(8, slice.length());
+        assertEquals("résumé", slice.toString());
+        assertSame(slice.toString(), slice.toString());
+        assertArrayEquals(whole.getBytes(), slice.getBytes());
+        assertEquals(whole, slice);
+        assertEquals(slice, whole);
+        assertEquals(whole.hashCode(), slice.hashCode());
+        assertEquals(Arrays.hashCode(whole.getBytes()), slice.hashCode());
+
+        DataInputStream in = slice.getStream();
+        byte[] read = new byte[8];
+        in.readFully(read);
+        assertEquals(-1, in.read());
+        assertArrayEquals(whole.getBytes(), read);
+
+        try {
+            LongStringHelper.asLongString(bytes, 4, bytes.length);
+            fail("range out of bounds");
+        } catch (IndexOutOfBoundsException e) {
+            // expected
+        }
+    }
 }
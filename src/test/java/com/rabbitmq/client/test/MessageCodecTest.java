@@ -0,0 +1,138 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.test;
+
+import com.rabbitmq.client.AMQP;
+import com.rabbitmq.client.Channel;
+import com.rabbitmq.client.Connection;
+import com.rabbitmq.client.ConnectionFactory;
+import com.rabbitmq.client.DeflateBodyCodec;
+import com.rabbitmq.client.JacksonMessageCodec;
+import com.rabbitmq.client.MessageCodec;
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+
+public class MessageCodecTest extends FakeBrokerTestCase {
+
+    @Test public void messagesAreEncodedAndDecoded() throws Exception {
+        MessageCodec<Order> codec = new JacksonMessageCodec<>(Order.class);
+        // single frame and multi-frame bodies
+        List<Order> orders = new ArrayList<>();
+        orders.add(new Order("small", 1));
+        orders.add(new Order(text(500 * 1024), 2));
+        for (Order order : orders) {
+            channel.basicPublish("", queue, false, null, codec, order);
+        }
+        // the content type of the codec does not override the one of the properties
+        channel.basicPublish("", queue, false,
+            new AMQP.BasicProperties.Builder().contentType("application/vnd.order+json").build(),
+            codec, new Order("typed", 3));
+
+        List<String> contentTypes = Collections.synchronizedList(new ArrayList<String>());
+        List<Order> received = consume(channel, codec, 3, contentTypes);
+        orders.add(new Order("typed", 3));
+        assertEquals(orders, received);
+        assertEquals(JacksonMessageCodec.CONTENT_TYPE, contentTypes.get(0));
+        assertEquals(JacksonMessageCodec.CONTENT_TYPE, contentTypes.get(1));
+        assertEquals("application/vnd.order+json", contentTypes.get(2));
+    }
+
+    @Test public void messagesAreCompressedWithTheBodyCodec() throws Exception {
+        ConnectionFactory connectionFactory = broker.connectionFactory();
+        connectionFactory.setBodyCodec(new DeflateBodyCodec());
+        try (Connection compressing = connectionFactory.newConnection()) {
+            Channel channel = compressing.createChannel();
+            MessageCodec<Order> codec = new JacksonMessageCodec<>(Order.class);
+            Order order = new Order(text(300 * 1024), 4);
+            channel.basicPublish("", queue, false, null, codec, order);
+            List<String> contentTypes = Collections.synchronizedList(new ArrayList<String>());
+            assertEquals(Collections.singletonList(order), consume(channel, codec, 1, contentTypes));
+            assertEquals(JacksonMessageCodec.CONTENT_TYPE, contentTypes.get(0));
+        }
+    }
+
+    private List<Order> consume(Channel channel, MessageCodec<Order> codec, int count, List<String> contentTypes) throws Exception {
+        List<Order> received = Collections.synchronizedList(new ArrayList<Order>());
+        CountDownLatch delivered = new CountDownLatch(count);
+        channel.basicConsume(queue, true, codec, (consumerTag, envelope, properties, order) -> {
+            contentTypes.add(properties.getContentType());
+            received.add(order);
+            delivered.countDown();
+        }, consumerTag -> { });
+        assertTrue(delivered.await(5, TimeUnit.SECONDS));
+        return received;
+    }
+
+    private static String text(int length) {
+        StringBuilder text = new StringBuilder(length);
+        for (int i = 0; i < length; i++) {
+            text.append((char) ('a' + i % 26));
+        }
+        return text.toString();
+    }
+
+    public static class Order {
+
+        private String description;
+        private int quantity;
+
+        public Order() {
+        }
+
+        Order(String description, int quantity) {
+            this.description = description;
+            this.quantity = quantity;
+        }
+
+        public String getDescription() {
+            return description;
+        }
+
+        public void setDescription(String description) {
+            this.description = description;
+        }
+
+        public int getQuantity() {
+            return quantity;
+        }
+
+        public void setQuantity(int quantity) {
+            this.quantity = quantity;
+        }
+
+        @Override
+        public boolean equals(Object o) {
+            if (!(o instanceof Order)) {
+                return false;
+            }
+            Order other = (Order) o;
+            return quantity == other.quantity && description.equals(other.description);
+        }
+
+        @Override
+        public int hashCode() {
+            return 31 * description.hashCode() + quantity;
+        }
+    }
+}
@@ -27,6 +27,7 @@ import org.junit.runner.RunWith;
 import org.junit.runners.Parameterized;
 
 import java.io.IOException;
+import java.util.concurrent.TimeUnit;
 
 import static org.hamcrest.Matchers.is;
 import static org.junit.Assert.assertThat;
@@ -205,6 +206,18 @@ public class MetricsCollectorTest {
         assertThat(publishUnrouted(metrics), is(2L));
     }
 
+    @Test public void publishConfirmLatency() {
+        AbstractMetricsCollector metrics = factory.create();
+        Channel channel = mock(Channel.class);
+        assertThat(publishConfirmLatencyCount(metrics), is(0L));
+        metrics.basicPublishConfirmLatency(channel, 10, TimeUnit.MILLISECONDS);
+        metrics.basicPublishConfirmLatency(channel, 20, TimeUnit.MILLISECONDS);
+        assertThat(publishConfirmLatencyCount(metrics), is(2L));
+        // cleaning stale state doesn't affect the metric
+        metrics.cleanStaleState();
+        assertThat(publishConfirmLatencyCount(metrics), is(2L));
+    }
+
     @Test public void cleanStaleState() {
         AbstractMetricsCollector metrics = factory.create();
         Connection openConnection = mock(Connection.class);
@@ -270,6 +283,14 @@ public class MetricsCollectorTest {
         }
     }
 
+    long publishConfirmLatencyCount(MetricsCollector metrics) {
+        if (metrics instanceof StandardMetricsCollector) {
+            return ((StandardMetricsCollector) metrics).getPublishConfirmLatency().getCount();
+        } else {
+            return ((MicrometerMetricsCollector) metrics).getPublishConfirmLatency().count();
+        }
+    }
+
     long publishedMessages(MetricsCollector metrics) {
         if (metrics instanceof StandardMetricsCollector) {
             return ((StandardMetricsCollector) metrics).getPublishedMessages().getCount();
@@ -0,0 +1,73 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.test;
+
+import com.rabbitmq.client.AMQP;
+import com.rabbitmq.client.Delivery;
+import com.rabbitmq.client.PreparedPublish;
+import org.junit.Test;
+
+import java.util.Collections;
+import java.util.List;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+
+import static com.rabbitmq.client.test.TestUtils.body;
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+
+public class PreparedPublishTest extends FakeBrokerTestCase {
+
+    @Test public void messagesAreTheSameAsWithBasicPublish() throws Exception {
+        channel.confirmSelect();
+        PreparedPublish publish = channel.preparePublish("", queue, false);
+        assertEquals(queue, publish.getRoutingKey());
+        // the body size is written in the pre-encoded header
+        int[] sizes = { 0, 1, 255, 256, 70000, 200000 };
+        for (int size : sizes) {
+            publish.publish(null, body(size));
+        }
+        AMQP.BasicProperties props = new AMQP.BasicProperties.Builder()
+            .contentType("text/plain")
+            .headers(Collections.<String, Object>singletonMap("h", "v"))
+            .build();
+        publish.publish(props, body(10));
+        channel.waitForConfirmsOrDie(5000);
+
+        List<Delivery> deliveries = consume(sizes.length + 1);
+        for (int i = 0; i < sizes.length; i++) {
+            Delivery delivery = deliveries.get(i);
+            assertArrayEquals(body(sizes[i]), delivery.getBody());
+            assertNull(delivery.getProperties().getContentType());
+            assertEquals("", delivery.getEnvelope().getExchange());
+            assertEquals(queue, delivery.getEnvelope().getRoutingKey());
+        }
+        Delivery delivery = deliveries.get(sizes.length);
+        assertArrayEquals(body(10), delivery.getBody());
+        assertEquals("text/plain", delivery.getProperties().getContentType());
+        assertEquals("v", delivery.getProperties().getHeaders().get("h").toString());
+    }
+
+    @Test public void mandatoryFlagIsEncoded() throws Exception {
+        CountDownLatch returned = new CountDownLatch(1);
+        channel.addReturnListener(r -> returned.countDown());
+        PreparedPublish publish = channel.preparePublish("", "does-not-exist", true);
+        publish.publish(null, body(10));
+        assertTrue(returned.await(5, TimeUnit.SECONDS));
+    }
+}
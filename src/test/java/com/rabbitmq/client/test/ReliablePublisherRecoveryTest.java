@@ -0,0 +1,107 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.test;
+
+import com.rabbitmq.client.Channel;
+import com.rabbitmq.client.Connection;
+import com.rabbitmq.client.ConnectionFactory;
+import com.rabbitmq.client.Delivery;
+import com.rabbitmq.client.Recoverable;
+import com.rabbitmq.client.RecoveryListener;
+import com.rabbitmq.client.ReliablePublisher;
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+
+/**
+ * Tests {@link ReliablePublisher} against connection failures of a {@link FakeBroker}.
+ */
+public class ReliablePublisherRecoveryTest extends FakeBrokerTestCase {
+
+    @Test public void unconfirmedMessagesArePublishedAgainInOrder() throws Exception {
+        ConnectionFactory connectionFactory = broker.connectionFactory();
+        connectionFactory.setAutomaticRecoveryEnabled(true);
+        connectionFactory.setNetworkRecoveryInterval(100);
+        try (Connection recovering = connectionFactory.newConnection()) {
+            Channel publishing = recovering.createChannel();
+            publishing.queueDeclare("reliable", false, false, false, null);
+            ReliablePublisher publisher = new ReliablePublisher(publishing, 1024 * 1024);
+            // registered after the publisher, called once the messages are published again
+            CountDownLatch recovered = new CountDownLatch(1);
+            ((Recoverable) publishing).addRecoveryListener(new RecoveryListener() {
+
+                @Override
+                public void handleRecovery(Recoverable recoverable) {
+                    recovered.countDown();
+                }
+
+                @Override
+                public void handleRecoveryStarted(Recoverable recoverable) {
+                }
+            });
+
+            broker.holdConfirms(true);
+            List<CompletableFuture<Void>> confirms = new ArrayList<CompletableFuture<Void>>();
+            for (int i = 0; i < 10; i++) {
+                confirms.add(publisher.publish("", "reliable", false, null, new byte[10]));
+            }
+            // the broker got them all, none is confirmed
+            assertEquals(10, publishing.queueDeclarePassive("reliable").getMessageCount());
+            assertEquals(10, publisher.getBufferedMessageCount());
+
+            broker.holdConfirms(false);
+            broker.killConnections();
+            // published during the outage or the recovery
+            for (int i = 0; i < 10; i++) {
+                confirms.add(publisher.publish("", "reliable", false, null, new byte[10]));
+            }
+            assertTrue(recovered.await(10, TimeUnit.SECONDS));
+            CompletableFuture.allOf(confirms.toArray(new CompletableFuture[0])).get(10, TimeUnit.SECONDS);
+            assertEquals(0, publisher.getBufferedMessageCount());
+            // the first attempts, then all of them again, without duplicates
+            assertEquals(30, publishing.queueDeclarePassive("reliable").getMessageCount());
+
+            List<Delivery> deliveries = TestUtils.consume(publishing, "reliable", 30);
+            for (int i = 0; i < 10; i++) {
+                assertEquals(i + 1, messageId(deliveries.get(i)));
+                assertEquals(1, attempt(deliveries.get(i)));
+            }
+            // then all of them, in publishing order
+            for (int i = 10; i < 30; i++) {
+                assertEquals(i - 9, messageId(deliveries.get(i)));
+            }
+            for (int i = 10; i < 20; i++) {
+                assertTrue(attempt(deliveries.get(i)) > 1);
+            }
+        }
+    }
+
+    private static long messageId(Delivery delivery) {
+        String id = delivery.getProperties().getHeaders().get(ReliablePublisher.PUBLISH_ID_HEADER).toString();
+        return Long.parseLong(id.substring(id.lastIndexOf('-') + 1));
+    }
+
+    private static int attempt(Delivery delivery) {
+        return ((Number) delivery.getProperties().getHeaders().get(ReliablePublisher.PUBLISH_ATTEMPT_HEADER)).intValue();
+    }
+}
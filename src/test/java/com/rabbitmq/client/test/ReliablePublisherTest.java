@@ -0,0 +1,144 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.test;
+
+import com.rabbitmq.client.AMQP;
+import com.rabbitmq.client.AlreadyClosedException;
+import com.rabbitmq.client.RecoverableChannel;
+import com.rabbitmq.client.RecoveryListener;
+import com.rabbitmq.client.ReliablePublisher;
+import com.rabbitmq.client.ShutdownSignalException;
+import org.junit.Before;
+import org.junit.Test;
+import org.mockito.ArgumentCaptor;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.CompletableFuture;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+import static org.mockito.ArgumentMatchers.any;
+import static org.mockito.ArgumentMatchers.anyBoolean;
+import static org.mockito.ArgumentMatchers.anyString;
+import static org.mockito.Mockito.doAnswer;
+import static org.mockito.Mockito.doThrow;
+import static org.mockito.Mockito.mock;
+import static org.mockito.Mockito.verify;
+import static org.mockito.Mockito.when;
+
+public class ReliablePublisherTest {
+
+    RecoverableChannel channel;
+    List<CompletableFuture<Void>> confirms = new ArrayList<>();
+    List<AMQP.BasicProperties> published = new ArrayList<>();
+    RecoveryListener recoveryListener;
+    ReliablePublisher publisher;
+
+    @Before public void init() throws Exception {
+        channel = mock(RecoverableChannel.class);
+        when(channel.getNextPublishSeqNo()).thenReturn(0L);
+        publishSucceeds();
+        publisher = new ReliablePublisher(channel, 1024);
+        verify(channel).confirmSelect();
+        ArgumentCaptor<RecoveryListener> listener = ArgumentCaptor.forClass(RecoveryListener.class);
+        verify(channel).addRecoveryListener(listener.capture());
+        recoveryListener = listener.getValue();
+    }
+
+    @Test public void confirmedMessagesLeaveTheBuffer() throws Exception {
+        CompletableFuture<Void> confirm = publisher.publish("", "q", false, null, new byte[100]);
+        assertEquals(1, publisher.getBufferedMessageCount());
+        assertEquals(100, publisher.getBufferedBytes());
+        confirms.get(0).complete(null);
+        assertTrue(confirm.isDone());
+        assertFalse(confirm.isCompletedExceptionally());
+        assertEquals(0, publisher.getBufferedMessageCount());
+        assertEquals(0, publisher.getBufferedBytes());
+    }
+
+    @Test public void unconfirmedMessagesArePublishedAgainAfterRecovery() throws Exception {
+        CompletableFuture<Void> first = publisher.publish("", "q", false, null, new byte[10]);
+        CompletableFuture<Void> second = publisher.publish("", "q", false, null, new byte[10]);
+        confirms.get(0).complete(null);
+        ShutdownSignalException connectionFailure = new ShutdownSignalException(true, false, null, null);
+        confirms.get(1).completeExceptionally(connectionFailure);
+        // published during the outage
+        doThrow(new AlreadyClosedException(connectionFailure)).when(channel)
+            .basicPublishAsync(anyString(), anyString(), anyBoolean(), any(AMQP.BasicProperties.class), any(byte[].class));
+        CompletableFuture<Void> third = publisher.publish("", "q", false, null, new byte[10]);
+        assertEquals(2, publisher.getBufferedMessageCount());
+
+        publishSucceeds();
+        recoveryListener.handleRecovery(channel);
+        assertEquals(4, published.size());
+        // same identifier, next attempt, same order
+        assertEquals(published.get(1).getHeaders().get(ReliablePublisher.PUBLISH_ID_HEADER),
+            published.get(2).getHeaders().get(ReliablePublisher.PUBLISH_ID_HEADER));
+        assertEquals(2, published.get(2).getHeaders().get(ReliablePublisher.PUBLISH_ATTEMPT_HEADER));
+        // the failed attempt during the outage counts
+        assertEquals(2, published.get(3).getHeaders().get(ReliablePublisher.PUBLISH_ATTEMPT_HEADER));
+
+        confirms.get(2).complete(null);
+        confirms.get(3).complete(null);
+        assertTrue(first.isDone() && second.isDone() && third.isDone());
+        assertEquals(0, publisher.getBufferedMessageCount());
+    }
+
+    @Test public void messagesAreHeldBackUntilTheBufferIsPublishedAgain() throws Exception {
+        publisher.publish("", "q", false, null, new byte[10]);
+        ShutdownSignalException connectionFailure = new ShutdownSignalException(true, false, null, null);
+        doThrow(new AlreadyClosedException(connectionFailure)).when(channel)
+            .basicPublishAsync(anyString(), anyString(), anyBoolean(), any(AMQP.BasicProperties.class), any(byte[].class));
+        publisher.publish("", "q", false, null, new byte[10]);
+        // the channel may already be recovered, this one must not overtake the others
+        publishSucceeds();
+        publisher.publish("", "q", false, null, new byte[10]);
+        assertEquals(1, published.size());
+
+        confirms.get(0).completeExceptionally(connectionFailure);
+        recoveryListener.handleRecovery(channel);
+        assertEquals(4, published.size());
+        for (int i = 1; i < 4; i++) {
+            assertEquals(i, messageId(published.get(i)));
+        }
+        // no longer held back
+        publisher.publish("", "q", false, null, new byte[10]);
+        assertEquals(4, messageId(published.get(4)));
+    }
+
+    @Test public void channelErrorsAreNotRetried() throws Exception {
+        CompletableFuture<Void> confirm = publisher.publish("", "q", false, null, new byte[10]);
+        confirms.get(0).completeExceptionally(new ShutdownSignalException(false, false, null, null));
+        assertTrue(confirm.isCompletedExceptionally());
+        assertEquals(0, publisher.getBufferedMessageCount());
+    }
+
+    private static long messageId(AMQP.BasicProperties props) {
+        String id = props.getHeaders().get(ReliablePublisher.PUBLISH_ID_HEADER).toString();
+        return Long.parseLong(id.substring(id.lastIndexOf('-') + 1));
+    }
+
+    private void publishSucceeds() throws Exception {
+        doAnswer(invocation -> {
+            CompletableFuture<Void> confirm = new CompletableFuture<>();
+            confirms.add(confirm);
+            published.add(invocation.getArgument(3));
+            return confirm;
+        }).when(channel).basicPublishAsync(anyString(), anyString(), anyBoolean(), any(AMQP.BasicProperties.class), any(byte[].class));
+    }
+}
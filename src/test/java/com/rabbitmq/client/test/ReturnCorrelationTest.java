@@ -0,0 +1,94 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.test;
+
+import com.rabbitmq.client.AMQP;
+import com.rabbitmq.client.PublishRejectedException;
+import com.rabbitmq.client.Return;
+import org.junit.Before;
+import org.junit.Test;
+
+import java.util.Collections;
+import java.util.concurrent.BlockingQueue;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.LinkedBlockingQueue;
+import java.util.concurrent.TimeUnit;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assert.fail;
+
+public class ReturnCorrelationTest extends FakeBrokerTestCase {
+
+    @Before public void confirmSelect() throws Exception {
+        channel.confirmSelect();
+    }
+
+    @Test public void returnsAreCorrelatedWithoutHeaders() throws Exception {
+        channel.setReturnCorrelation(true);
+        BlockingQueue<Return> returns = new LinkedBlockingQueue<Return>();
+        channel.addReturnListener(r -> returns.add(r));
+        channel.basicPublish("", queue, true, null, new byte[10]);
+        channel.basicPublish("", "unroutable", true, null, new byte[10]);
+        channel.basicPublish("", queue, true, null, new byte[10]);
+        channel.basicPublish("", "unroutable", true, null, new byte[20]);
+        channel.waitForConfirmsOrDie(5000);
+        Return returned = returns.poll(5, TimeUnit.SECONDS);
+        assertEquals(2, returned.getPublishSeqNo());
+        assertNull(returned.getProperties().getHeaders());
+        assertEquals(4, returns.poll(5, TimeUnit.SECONDS).getPublishSeqNo());
+        assertNull(channel.basicGet(queue, true).getProps().getHeaders());
+    }
+
+    @Test public void messagesOfTheSameShapeAreToldApart() throws Exception {
+        channel.setReturnCorrelation(true);
+        BlockingQueue<Return> returns = new LinkedBlockingQueue<Return>();
+        channel.addReturnListener(r -> returns.add(r));
+        String deleted = channel.queueDeclare().getQueue();
+        channel.basicPublish("", deleted, true, null, new byte[10]);
+        channel.queueDelete(deleted);
+        channel.basicPublish("", deleted, true, null, new byte[10]);
+        channel.waitForConfirmsOrDie(5000);
+        assertEquals(2, returns.poll(5, TimeUnit.SECONDS).getPublishSeqNo());
+        assertNull(returns.poll(100, TimeUnit.MILLISECONDS));
+    }
+
+    @Test public void returnsFailTheirFutureOnly() throws Exception {
+        // a forwarded message with a header from the former correlation scheme
+        AMQP.BasicProperties forwarded = new AMQP.BasicProperties.Builder()
+            .headers(Collections.<String, Object>singletonMap("x-publish-seq-no", 1L)).build();
+        CompletableFuture<Void> routed = channel.basicPublishAsync("", queue, true, null, new byte[10]);
+        CompletableFuture<Void> returned = channel.basicPublishAsync("", "unroutable", true, forwarded, new byte[10]);
+        routed.get(5, TimeUnit.SECONDS);
+        try {
+            returned.get(5, TimeUnit.SECONDS);
+            fail("message is returned");
+        } catch (ExecutionException e) {
+            assertTrue(e.getCause() instanceof PublishRejectedException);
+            assertTrue(((PublishRejectedException) e.getCause()).isReturned());
+        }
+    }
+
+    @Test public void sequenceNumberIsOnlyExposedWhenEnabled() throws Exception {
+        BlockingQueue<Return> returns = new LinkedBlockingQueue<Return>();
+        channel.addReturnListener(r -> returns.add(r));
+        channel.basicPublish("", "unroutable", true, null, new byte[10]);
+        channel.waitForConfirmsOrDie(5000);
+        assertEquals(0, returns.poll(5, TimeUnit.SECONDS).getPublishSeqNo());
+    }
+}
@@ -0,0 +1,162 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client.test;
+
+import com.rabbitmq.client.AMQP;
+import com.rabbitmq.client.Channel;
+import com.rabbitmq.client.Connection;
+import com.rabbitmq.client.ConnectionFactory;
+import com.rabbitmq.client.DefaultConsumer;
+import com.rabbitmq.client.Envelope;
+import com.rabbitmq.client.StreamingConsumer;
+import org.junit.After;
+import org.junit.Before;
+import org.junit.Test;
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.TimeoutException;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+
+public class StreamingConsumerTest {
+
+    FakeBroker broker;
+
+    @Before public void init() throws IOException {
+        broker = new FakeBroker();
+    }
+
+    @After public void tearDown() throws IOException {
+        broker.close();
+    }
+
+    @Test public void bodiesAreStreamedBlockingIo() throws Exception {
+        bodiesAreStreamed(false);
+    }
+
+    @Test public void bodiesAreStreamedNio() throws Exception {
+        bodiesAreStreamed(true);
+    }
+
+    private void bodiesAreStreamed(boolean nio) throws Exception {
+        ConnectionFactory connectionFactory = broker.connectionFactory();
+        if (nio) {
+            connectionFactory.useNio();
+        } else {
+            connectionFactory.useBlockingIo();
+        }
+        try (Connection connection = connectionFactory.newConnection()) {
+            Channel channel = connection.createChannel();
+            String queue = channel.queueDeclare().getQueue();
+            // many more frames than the stream buffers
+            byte[] large = new byte[4 * 1024 * 1024];
+            for (int i = 0; i < large.length; i++) {
+                large[i] = (byte) i;
+            }
+            byte[][] bodies = { large, new byte[0], "small".getBytes(), large };
+            channel.confirmSelect();
+            for (int i = 0; i < bodies.length; i++) {
+                channel.basicPublish("", queue, new AMQP.BasicProperties.Builder().messageId(String.valueOf(i)).build(), bodies[i]);
+            }
+            channel.waitForConfirmsOrDie(5000);
+
+            Map<String, byte[]> received = new ConcurrentHashMap<>();
+            CountDownLatch delivered = new CountDownLatch(bodies.length);
+            channel.basicConsume(queue, false, new StreamingTestConsumer(channel, received, delivered));
+            assertTrue(delivered.await(10, TimeUnit.SECONDS));
+            for (int i = 0; i < bodies.length; i++) {
+                assertArrayEquals(bodies[i], received.get(String.valueOf(i)));
+            }
+            assertEquals(0, broker.messageCount(queue));
+        }
+    }
+
+    @Test public void consumerCanCloseChannelInTheMiddleOfTheBodyBlockingIo() throws Exception {
+        consumerCanCloseChannelInTheMiddleOfTheBody(false);
+    }
+
+    @Test public void consumerCanCloseChannelInTheMiddleOfTheBodyNio() throws Exception {
+        consumerCanCloseChannelInTheMiddleOfTheBody(true);
+    }
+
+    private void consumerCanCloseChannelInTheMiddleOfTheBody(boolean nio) throws Exception {
+        ConnectionFactory connectionFactory = broker.connectionFactory();
+        if (nio) {
+            connectionFactory.useNio();
+        } else {
+            connectionFactory.useBlockingIo();
+        }
+        try (Connection connection = connectionFactory.newConnection()) {
+            Channel channel = connection.createChannel();
+            String queue = channel.queueDeclare().getQueue();
+            // the reader thread waits for the consumer long before the end of the body
+            channel.basicPublish("", queue, null, new byte[4 * 1024 * 1024]);
+
+            CountDownLatch closed = new CountDownLatch(1);
+            channel.basicConsume(queue, false, new StreamingTestConsumer(channel, null, null) {
+                @Override
+                public void handleDelivery(String consumerTag, Envelope envelope, AMQP.BasicProperties properties, InputStream body) throws IOException {
+                    body.read(new byte[1000]);
+                    try {
+                        getChannel().close();
+                    } catch (TimeoutException e) {
+                        throw new IOException(e);
+                    }
+                    closed.countDown();
+                }
+            });
+            assertTrue(closed.await(10, TimeUnit.SECONDS));
+            assertFalse(channel.isOpen());
+            assertTrue(connection.isOpen());
+            connection.createChannel().queueDeclare();
+        }
+    }
+
+    private static class StreamingTestConsumer extends DefaultConsumer implements StreamingConsumer {
+
+        private final Map<String, byte[]> received;
+        private final CountDownLatch delivered;
+
+        StreamingTestConsumer(Channel channel, Map<String, byte[]> received, CountDownLatch delivered) {
+            super(channel);
+            this.received = received;
+            this.delivered = delivered;
+        }
+
+        @Override
+        public void handleDelivery(String consumerTag, Envelope envelope, AMQP.BasicProperties properties, InputStream body) throws IOException {
+            ByteArrayOutputStream out = new ByteArrayOutputStream();
+            byte[] buffer = new byte[1000];
+            int read;
+            while ((read = body.read(buffer)) != -1) {
+                out.write(buffer, 0, read);
+            }
+            received.put(properties.getMessageId(), out.toByteArray());
+            getChannel().basicAck(envelope.getDeliveryTag(), false);
+            delivered.countDown();
+        }
+    }
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client.test;
+
+import com.rabbitmq.client.Delivery;
+import org.junit.Test;
+
+import java.io.ByteArrayInputStream;
+import java.io.EOFException;
+import java.io.File;
+import java.io.IOException;
+import java.io.InputStream;
+import java.nio.ByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.file.StandardOpenOption;
+import java.util.Arrays;
+import java.util.List;
+
+import static com.rabbitmq.client.test.TestUtils.body;
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assert.fail;
+
+public class StreamingPublishTest extends FakeBrokerTestCase {
+
+    @Test public void bodiesAreReadFromStreams() throws Exception {
+        channel.confirmSelect();
+        // sizes around the frame size
+        int[] sizes = { 0, 1, 131064, 131065, 1024 * 1024 };
+        for (int size : sizes) {
+            channel.basicPublish("", queue, false, null, new ByteArrayInputStream(body(size + 10)), size);
+        }
+        channel.waitForConfirmsOrDie(5000);
+        List<Delivery> deliveries = consume(sizes.length);
+        for (int i = 0; i < sizes.length; i++) {
+            assertArrayEquals(body(sizes[i]), deliveries.get(i).getBody());
+        }
+    }
+
+    @Test public void bodiesAreReadFromFiles() throws Exception {
+        File file = File.createTempFile("streaming-publish", ".bin");
+        file.deleteOnExit();
+        byte[] content = body(500 * 1024);
+        try (FileChannel fileChannel = FileChannel.open(file.toPath(), StandardOpenOption.READ, StandardOpenOption.WRITE)) {
+            fileChannel.write(ByteBuffer.wrap(content));
+            fileChannel.position(0);
+            channel.confirmSelect();
+            channel.basicPublish("", queue, false, null, fileChannel, 0, content.length);
+            channel.basicPublish("", queue, false, null, fileChannel, 1000, 300000);
+            channel.waitForConfirmsOrDie(5000);
+            assertEquals(0, fileChannel.position());
+        }
+        List<Delivery> deliveries = consume(2);
+        assertArrayEquals(content, deliveries.get(0).getBody());
+        assertArrayEquals(Arrays.copyOfRange(content, 1000, 301000), deliveries.get(1).getBody());
+    }
+
+    @Test public void streamFailingRightAwayOnlyFailsThePublish() throws Exception {
+        channel.confirmSelect();
+        try {
+            channel.basicPublish("", queue, false, null, new ByteArrayInputStream(body(10)), 100);
+            fail("stream is shorter than the body size");
+        } catch (EOFException e) {
+            // expected
+        }
+        assertTrue(channel.isOpen());
+        channel.basicPublish("", queue, null, body(10));
+        // no sequence number is allocated for the failed publish
+        channel.waitForConfirmsOrDie(5000);
+        assertArrayEquals(body(10), consume(1).get(0).getBody());
+    }
+
+    @Test public void streamFailingAfterTheFirstFrameClosesTheConnection() throws Exception {
+        InputStream failing = new InputStream() {
+            int read = 0;
+
+            @Override
+            public int read() throws IOException {
+                if (read++ == 200000) {
+                    throw new IOException("disk failure");
+                }
+                return 0;
+            }
+        };
+        try {
+            channel.basicPublish("", queue, false, null, failing, 1024 * 1024);
+            fail("stream fails");
+        } catch (IOException e) {
+            assertEquals("disk failure", e.getMessage());
+        }
+        assertFalse(connection.isOpen());
+    }
+}
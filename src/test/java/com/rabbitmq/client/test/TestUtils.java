@@ -20,6 +20,7 @@ import com.rabbitmq.client.Channel;
 import com.rabbitmq.client.Connection;
 import com.rabbitmq.client.ConnectionFactory;
 import com.rabbitmq.client.DefaultConsumer;
+import com.rabbitmq.client.Delivery;
 import com.rabbitmq.client.Envelope;
 import com.rabbitmq.client.Recoverable;
 import com.rabbitmq.client.RecoverableConnection;
@@ -31,8 +32,10 @@ import com.rabbitmq.tools.Host;
 import org.slf4j.LoggerFactory;
 
 import java.io.IOException;
+import java.util.ArrayList;
 import java.util.Collection;
 import java.util.Collections;
+import java.util.List;
 import java.util.concurrent.Callable;
 import java.util.concurrent.CountDownLatch;
 import java.util.concurrent.TimeUnit;
@@ -191,6 +194,36 @@ public class TestUtils {
         return latch;
     }
 
+    /**
+     * Consume messages with automatic acknowledgement and wait for them.
+     * @param channel the channel to consume on
+     * @param queue the queue to consume from
+     * @param count the number of messages to wait for
+     * @return the deliveries, in order
+     */
+    public static List<Delivery> consume(Channel channel, String queue, int count) throws Exception {
+        List<Delivery> deliveries = Collections.synchronizedList(new ArrayList<Delivery>());
+        CountDownLatch delivered = new CountDownLatch(count);
+        channel.basicConsume(queue, true, (consumerTag, delivery) -> {
+            deliveries.add(delivery);
+            delivered.countDown();
+        }, consumerTag -> { });
+        assertTrue(delivered.await(5, TimeUnit.SECONDS));
+        return deliveries;
+    }
+
+    /**
+     * @param size the size of the body
+     * @return a message body whose bytes depend on their position
+     */
+    public static byte[] body(int size) {
+        byte[] body = new byte[size];
+        for (int i = 0; i < size; i++) {
+            body[i] = (byte) i;
+        }
+        return body;
+    }
+
     private static void wait(CountDownLatch latch) throws InterruptedException {
         assertTrue(latch.await(90, TimeUnit.SECONDS));
     }
@@ -23,17 +23,27 @@ import org.junit.Test;
 import com.rabbitmq.client.AMQP;
 import com.rabbitmq.client.Channel;
 import com.rabbitmq.client.ConfirmListener;
+import com.rabbitmq.client.ConfirmWindowFullException;
 import com.rabbitmq.client.DefaultConsumer;
 import com.rabbitmq.client.GetResponse;
 import com.rabbitmq.client.MessageProperties;
+import com.rabbitmq.client.PublishRejectedException;
 import com.rabbitmq.client.ShutdownSignalException;
 import com.rabbitmq.client.test.BrokerTestCase;
 
 import java.io.IOException;
+import java.util.ArrayList;
 import java.util.Collections;
+import java.util.List;
 import java.util.Map;
 import java.util.SortedSet;
 import java.util.TreeSet;
+import java.util.concurrent.BlockingQueue;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.LinkedBlockingQueue;
+import java.util.concurrent.TimeUnit;
 import java.util.concurrent.TimeoutException;
 
 public class Confirm extends BrokerTestCase
@@ -237,6 +247,120 @@ public class Confirm extends BrokerTestCase
         }
     }
 
+    @Test public void basicPublishAsync()
+        throws IOException, InterruptedException, ExecutionException, TimeoutException {
+        List<CompletableFuture<Void>> confirms = new ArrayList<CompletableFuture<Void>>();
+        for (long i = 0; i < NUM_MESSAGES; i++) {
+            confirms.add(channel.basicPublishAsync("", "confirm-test", true,
+                MessageProperties.PERSISTENT_BASIC, "nop".getBytes()));
+        }
+        CompletableFuture.allOf(confirms.toArray(new CompletableFuture[0])).get(60, TimeUnit.SECONDS);
+
+        CompletableFuture<Void> returned = channel.basicPublishAsync("", "confirm-test-doesnotexist", true,
+            MessageProperties.PERSISTENT_BASIC, "nop".getBytes());
+        try {
+            returned.get(60, TimeUnit.SECONDS);
+            fail("unroutable mandatory message confirmed");
+        } catch (ExecutionException e) {
+            assertTrue(e.getCause() instanceof PublishRejectedException);
+            assertTrue(((PublishRejectedException) e.getCause()).isReturned());
+        }
+        channel.waitForConfirmsOrDie(60000);
+    }
+
+    @Test public void basicPublishAsyncReturnsOfTheSameShape()
+        throws IOException, InterruptedException, ExecutionException, TimeoutException {
+        // same exchange, routing key and body size, only headers tell routable messages apart
+        channel.queueBind("confirm-test-noconsumer", "amq.match", "",
+            Collections.<String, Object>singletonMap("routed", "yes"));
+        List<CompletableFuture<Void>> routed = new ArrayList<CompletableFuture<Void>>();
+        List<CompletableFuture<Void>> returned = new ArrayList<CompletableFuture<Void>>();
+        // all outstanding at the same time, in both orders
+        for (int i = 0; i < NUM_MESSAGES; i++) {
+            boolean routable = (i / 2) % 2 == i % 2;
+            AMQP.BasicProperties props = MessageProperties.PERSISTENT_BASIC.builder()
+                .headers(Collections.<String, Object>singletonMap("routed", routable ? "yes" : "no"))
+                .build();
+            CompletableFuture<Void> confirm = channel.basicPublishAsync("amq.match", "", true, props, "nop".getBytes());
+            (routable ? routed : returned).add(confirm);
+        }
+        CompletableFuture.allOf(routed.toArray(new CompletableFuture[0])).get(60, TimeUnit.SECONDS);
+        for (CompletableFuture<Void> confirm : returned) {
+            try {
+                confirm.get(60, TimeUnit.SECONDS);
+                fail("unroutable mandatory message confirmed");
+            } catch (ExecutionException e) {
+                assertTrue(e.getCause() instanceof PublishRejectedException);
+                assertTrue(((PublishRejectedException) e.getCause()).isReturned());
+            }
+        }
+        channel.waitForConfirmsOrDie(60000);
+    }
+
+    @Test public void returnCorrelation()
+        throws IOException, InterruptedException, TimeoutException {
+        channel.setReturnCorrelation(true);
+        final BlockingQueue<Long> returned = new LinkedBlockingQueue<Long>();
+        channel.addReturnListener(r -> returned.add(r.getPublishSeqNo()));
+        publish("", "confirm-test", true, true);
+        long unroutable = channel.getNextPublishSeqNo();
+        publish("", "confirm-test-doesnotexist", true, true);
+        channel.waitForConfirmsOrDie(60000);
+        assertEquals(Long.valueOf(unroutable), returned.poll(10, TimeUnit.SECONDS));
+        assertTrue(returned.isEmpty());
+    }
+
+    @Test public void confirmWindow()
+        throws IOException, InterruptedException, TimeoutException {
+        channel.setConfirmWindow(10, 60000);
+        publishN("", "confirm-test", true, false);
+        channel.waitForConfirmsOrDie(60000);
+
+        CountDownLatch held = new CountDownLatch(1);
+        CountDownLatch release = new CountDownLatch(1);
+        holdConfirms(held, release);
+        channel.setConfirmWindow(1, 0);
+        try {
+            publish("", "confirm-test-noconsumer", true, false);
+            // the message stays unconfirmed until its confirm is released
+            assertTrue(held.await(60, TimeUnit.SECONDS));
+            try {
+                publish("", "confirm-test-noconsumer", true, false);
+                fail("confirm window not enforced");
+            } catch (ConfirmWindowFullException e) {
+                assertEquals(1, e.getMaxOutstandingConfirms());
+            }
+        } finally {
+            release.countDown();
+        }
+        channel.waitForConfirmsOrDie(60000);
+    }
+
+    @Test public void confirmWindowWithoutTimeout()
+        throws IOException, InterruptedException, TimeoutException {
+        CountDownLatch held = new CountDownLatch(1);
+        CountDownLatch release = new CountDownLatch(1);
+        holdConfirms(held, release);
+        channel.setConfirmWindow(1, -1);
+        publish("", "confirm-test-noconsumer", true, false);
+        assertTrue(held.await(60, TimeUnit.SECONDS));
+        final CountDownLatch published = new CountDownLatch(1);
+        Thread publisher = new Thread(() -> {
+            try {
+                publish("", "confirm-test-noconsumer", true, false);
+                published.countDown();
+            } catch (IOException e) {
+                e.printStackTrace();
+            }
+        });
+        publisher.start();
+        // waits as long as the first message is unconfirmed
+        assertFalse(published.await(100, TimeUnit.MILLISECONDS));
+        release.countDown();
+        assertTrue(published.await(60, TimeUnit.SECONDS));
+        channel.waitForConfirmsOrDie(60000);
+    }
+
     @Test public void waitForConfirmsWithoutConfirmSelected()
         throws IOException, InterruptedException
     {
@@ -298,6 +422,21 @@ public class Confirm extends BrokerTestCase
         }
     }
 
+    /**
+     * Hold the first confirm on the connection thread, before the channel
+     * processes it, until released.
+     */
+    private void holdConfirms(final CountDownLatch held, final CountDownLatch release) {
+        channel.addConfirmListener((deliveryTag, multiple) -> {
+            held.countDown();
+            try {
+                release.await(60, TimeUnit.SECONDS);
+            } catch (InterruptedException e) {
+                Thread.currentThread().interrupt();
+            }
+        }, (deliveryTag, multiple) -> { });
+    }
+
     protected void publish(String exchangeName, String queueName,
                            boolean persistent, boolean mandatory)
         throws IOException {
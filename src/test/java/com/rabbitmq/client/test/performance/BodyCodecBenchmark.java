@@ -0,0 +1,115 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client.test.performance;
+
+import com.rabbitmq.client.BodyCodec;
+import com.rabbitmq.client.DeflateBodyCodec;
+import org.apache.commons.cli.CommandLine;
+import org.apache.commons.cli.Option;
+
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.util.Random;
+
+/**
+ * Measures the throughput and the compression ratio of {@link DeflateBodyCodec}
+ * on JSON bodies of increasing sizes, to choose a compression level and a
+ * {@link com.rabbitmq.client.ConnectionFactory#setBodyCodecThreshold(int) threshold}.
+ * <p>
+ * For each size, the last column is the bandwidth below which compressing
+ * pays off: sending the bytes saved takes longer than encoding and decoding.
+ */
+public class BodyCodecBenchmark {
+
+    private static final int[] SIZES = { 256, 1024, 4096, 16384, 65536, 262144, 1048576 };
+
+    /** Keeps the results alive, so that operations are not optimised away */
+    private static int sink;
+
+    public static void main(String[] args) throws Exception {
+        CLIHelper helper = CLIHelper.defaultHelper();
+        helper.addOption(new Option("m", "megabytes", true, "megabytes of bodies per measurement"));
+        helper.addOption(new Option("l", "level", true, "deflate compression level"));
+        CommandLine cmd = helper.parseCommandLine(args);
+        if (cmd == null) return;
+        long bytesPerMeasurement = CLIHelper.getOptionValue(cmd, "m", 256) * 1024L * 1024L;
+        int level = CLIHelper.getOptionValue(cmd, "l", 1);
+
+        BodyCodec codec = new DeflateBodyCodec(level);
+        System.out.println(String.format("%10s %8s %14s %14s %18s",
+            "size", "ratio", "encode MB/s", "decode MB/s", "break-even MB/s"));
+        for (int size : SIZES) {
+            byte[] body = json(size);
+            byte[] encoded = codec.encode(body);
+            int iterations = (int) Math.max(10, bytesPerMeasurement / size);
+            double encodeNanos = measure(iterations, () -> codec.encode(body));
+            double decodeNanos = measure(iterations, () -> codec.decode(encoded));
+            double saved = body.length - encoded.length;
+            System.out.println(String.format("%10d %8.2f %14.1f %14.1f %18.1f",
+                size,
+                (double) body.length / encoded.length,
+                megabytesPerSecond(size, encodeNanos),
+                megabytesPerSecond(size, decodeNanos),
+                saved <= 0 ? 0.0 : megabytesPerSecond(saved, encodeNanos + decodeNanos)));
+        }
+    }
+
+    interface Operation {
+        byte[] run() throws IOException;
+    }
+
+    /** @return the average time of an operation, in nanoseconds */
+    private static double measure(int iterations, Operation operation) throws IOException {
+        // warm-up
+        run(iterations, operation);
+        long start = System.nanoTime();
+        run(iterations, operation);
+        return (double) (System.nanoTime() - start) / iterations;
+    }
+
+    private static void run(int iterations, Operation operation) throws IOException {
+        int length = 0;
+        for (int i = 0; i < iterations; i++) {
+            length += operation.run().length;
+        }
+        sink += length;
+    }
+
+    private static double megabytesPerSecond(double bytes, double nanos) {
+        return bytes / nanos * 1000000000.0 / (1024 * 1024);
+    }
+
+    /** @return a JSON array of orders, of the given size */
+    private static byte[] json(int size) {
+        Random random = new Random(42);
+        String[] statuses = { "created", "paid", "shipped", "delivered", "cancelled" };
+        StringBuilder json = new StringBuilder(size + 256).append('[');
+        while (json.length() < size) {
+            if (json.length() > 1) {
+                json.append(',');
+            }
+            json.append("{\"id\":").append(random.nextInt(1000000))
+                .append(",\"customer\":\"customer-").append(random.nextInt(5000))
+                .append("\",\"status\":\"").append(statuses[random.nextInt(statuses.length)])
+                .append("\",\"amount\":").append(random.nextInt(100000) / 100.0)
+                .append(",\"currency\":\"EUR\",\"items\":").append(1 + random.nextInt(9))
+                .append('}');
+        }
+        json.setLength(size - 1);
+        return json.append(']').toString().getBytes(StandardCharsets.US_ASCII);
+    }
+}
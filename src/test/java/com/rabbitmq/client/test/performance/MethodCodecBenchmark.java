@@ -0,0 +1,130 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+
+package com.rabbitmq.client.test.performance;
+
+import com.rabbitmq.client.AMQP;
+import com.rabbitmq.client.impl.AMQContentHeader;
+import com.rabbitmq.client.impl.AMQImpl;
+import com.rabbitmq.client.impl.Method;
+import com.rabbitmq.client.impl.MethodArgumentReader;
+import com.rabbitmq.client.impl.MethodArgumentWriter;
+import com.rabbitmq.client.impl.ValueReader;
+import com.rabbitmq.client.impl.ValueWriter;
+import org.apache.commons.cli.CommandLine;
+import org.apache.commons.cli.Option;
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.util.Date;
+import java.util.HashMap;
+import java.util.Map;
+
+/**
+ * Measures the encoding and decoding of <code>basic.publish</code>,
+ * <code>basic.deliver</code>, <code>basic.ack</code>, <code>basic.nack</code>
+ * and basic properties, with the generated fast paths and with the generic
+ * {@link MethodArgumentWriter} and {@link MethodArgumentReader}.
+ * <p>
+ * Each operation is run once to warm up, then measured. The result is the
+ * average time per operation.
+ */
+public class MethodCodecBenchmark {
+
+    interface Operation {
+        Object run() throws IOException;
+    }
+
+    /** Keeps the results alive, so that operations are not optimised away */
+    private static int sink;
+
+    public static void main(String[] args) throws Exception {
+        CLIHelper helper = CLIHelper.defaultHelper();
+        helper.addOption(new Option("n", "iterations", true, "number of operations per measurement"));
+        CommandLine cmd = helper.parseCommandLine(args);
+        if (cmd == null) return;
+        int iterations = CLIHelper.getOptionValue(cmd, "n", 5000000);
+
+        Method[] methods = {
+            new AMQImpl.Basic.Publish(0, "amq.direct", "orders.created.eu-west", true, false),
+            new AMQImpl.Basic.Deliver("amq.ctag-Ab3dXc9_Qw", 123456789L, false, "amq.direct", "orders.created.eu-west"),
+            new AMQImpl.Basic.Ack(123456789L, true),
+            new AMQImpl.Basic.Nack(123456789L, false, true)
+        };
+        for (Method method : methods) {
+            byte[] payload = method.toFrame(1).getPayload();
+            measure(method.protocolMethodName() + " encode fast", iterations, () -> method.toFrame(1));
+            measure(method.protocolMethodName() + " encode generic", iterations, () -> genericEncoding(method));
+            measure(method.protocolMethodName() + " decode fast", iterations,
+                () -> AMQImpl.readMethodFrom(ByteBuffer.wrap(payload)));
+            measure(method.protocolMethodName() + " decode generic", iterations,
+                () -> genericDecoding(method, payload));
+        }
+
+        Map<String, Object> headers = new HashMap<String, Object>();
+        headers.put("tenant", "acme");
+        headers.put("attempt", 1);
+        AMQP.BasicProperties properties = new AMQP.BasicProperties.Builder()
+            .contentType("application/json").deliveryMode(2).priority(0)
+            .messageId("5f0c2b64-8a1e-4c41-9a3e-1b2f3c4d5e6f").timestamp(new Date())
+            .headers(headers).build();
+        byte[] header = ((AMQContentHeader) properties).toFrame(1, 1024).getPayload();
+        measure("basic.properties decode", iterations, () -> AMQImpl.readContentHeaderFrom(ByteBuffer.wrap(header)));
+        measure("basic.properties decode stream", iterations,
+            () -> AMQImpl.readContentHeaderFrom(new DataInputStream(new ByteArrayInputStream(header))));
+    }
+
+    private static void measure(String name, int iterations, Operation operation) throws IOException {
+        // warm-up
+        run(iterations, operation);
+        long start = System.nanoTime();
+        run(iterations, operation);
+        double nanos = (double) (System.nanoTime() - start) / iterations;
+        System.out.println(String.format("%-40s %8.1f ns/op", name, nanos));
+    }
+
+    private static void run(int iterations, Operation operation) throws IOException {
+        int hash = 0;
+        for (int i = 0; i < iterations; i++) {
+            hash += System.identityHashCode(operation.run());
+        }
+        sink += hash;
+    }
+
+    private static byte[] genericEncoding(Method method) throws IOException {
+        ByteArrayOutputStream bytes = new ByteArrayOutputStream();
+        DataOutputStream out = new DataOutputStream(bytes);
+        out.writeShort(method.protocolClassId());
+        out.writeShort(method.protocolMethodId());
+        MethodArgumentWriter writer = new MethodArgumentWriter(new ValueWriter(out));
+        method.writeArgumentsTo(writer);
+        writer.flush();
+        return bytes.toByteArray();
+    }
+
+    private static Method genericDecoding(Method method, byte[] payload) throws IOException {
+        DataInputStream in = new DataInputStream(new ByteArrayInputStream(payload, 4, payload.length - 4));
+        MethodArgumentReader reader = new MethodArgumentReader(new ValueReader(in));
+        if (method instanceof AMQImpl.Basic.Publish) return new AMQImpl.Basic.Publish(reader);
+        if (method instanceof AMQImpl.Basic.Deliver) return new AMQImpl.Basic.Deliver(reader);
+        if (method instanceof AMQImpl.Basic.Ack) return new AMQImpl.Basic.Ack(reader);
+        return new AMQImpl.Basic.Nack(reader);
+    }
+}
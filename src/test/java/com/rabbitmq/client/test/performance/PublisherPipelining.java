@@ -0,0 +1,217 @@
+// Copyright (c) 2007-Present Pivotal Software, Inc.  All rights reserved.
+//
+// This software, the RabbitMQ Java client library, is triple-licensed under the
+// Mozilla Public License 1.1 ("MPL"), the GNU General Public License version 2
+// ("GPL") and the Apache License version 2 ("ASL"). For the MPL, please see
+// LICENSE-MPL-RabbitMQ. For the GPL, please see LICENSE-GPL2.  For the ASL,
+// please see LICENSE-APACHE2.
+//
+// This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND,
+// either express or implied. See the LICENSE file for specific language governing
+// rights and limitations of this software.
+//
+// If you have any questions regarding licensing, please contact us at
+// info@rabbitmq.com.
+
+package com.rabbitmq.client.test.performance;
+
+import com.rabbitmq.client.AMQP;
+import com.rabbitmq.client.Channel;
+import com.rabbitmq.client.ConfirmListener;
+import com.rabbitmq.client.Connection;
+import com.rabbitmq.client.ConnectionFactory;
+import com.rabbitmq.client.test.FakeBroker;
+import org.apache.commons.cli.CommandLine;
+import org.apache.commons.cli.Option;
+
+import java.io.IOException;
+import java.util.Arrays;
+import java.util.concurrent.TimeoutException;
+
+/**
+ * Measures publishing throughput and latency for the different ways
+ * of using publisher confirms, across message sizes and both transports
+ * (blocking IO and NIO).
+ * <p>
+ * Confirm modes:
+ * <ul>
+ *     <li><code>none</code>: no confirms, the latency is the duration of <code>basicPublish</code></li>
+ *     <li><code>single</code>: wait for the confirm of each message before publishing the next one</li>
+ *     <li><code>window</code>: at most <code>window</code> unconfirmed messages, with {@link Channel#setConfirmWindow(int, long)}</li>
+ *     <li><code>batch</code>: publish <code>window</code> messages, then wait for their confirms</li>
+ * </ul>
+ * With confirms, the latency is the time between publishing and receiving the confirm.
+ * Each combination is run once to warm up, then measured.
+ * <p>
+ * Without a host, the benchmark runs against an in-process {@link FakeBroker},
+ * which measures the client without the network and broker overhead.
+ */
+public class PublisherPipelining {
+
+    protected static class Parameters {
+        final String host;
+        final int port;
+        final int messageCount;
+        final int window;
+        final String[] transports;
+        final String[] modes;
+        final int[] sizes;
+
+        public static CommandLine parseCommandLine(String[] args) {
+            CLIHelper helper = CLIHelper.defaultHelper();
+            helper.addOption(new Option("n", "messages", true, "number of messages to publish per run"));
+            helper.addOption(new Option("w", "window", true, "confirm window and batch size"));
+            helper.addOption(new Option("t", "transports", true, "comma-separated transports (blocking,nio)"));
+            helper.addOption(new Option("m", "modes", true, "comma-separated confirm modes (none,single,window,batch)"));
+            helper.addOption(new Option("s", "sizes", true, "comma-separated message sizes in bytes"));
+            return helper.parseCommandLine(args);
+        }
+
+        public Parameters(CommandLine cmd) {
+            host         = cmd.getOptionValue("h");
+            port         = CLIHelper.getOptionValue(cmd, "p", AMQP.PROTOCOL.PORT);
+            messageCount = CLIHelper.getOptionValue(cmd, "n", 100000);
+            window       = CLIHelper.getOptionValue(cmd, "w", 100);
+            transports   = cmd.getOptionValue("t", "blocking,nio").split(",");
+            modes        = cmd.getOptionValue("m", "none,single,window,batch").split(",");
+            String[] s   = cmd.getOptionValue("s", "16,1024,65536").split(",");
+            sizes = new int[s.length];
+            for (int i = 0; i < s.length; i++) {
+                sizes[i] = Integer.parseInt(s[i]);
+            }
+        }
+
+        public String toString() {
+            StringBuilder b = new StringBuilder();
+            b.append("host="        + (host == null ? "in-process" : host));
+            b.append(",port="       + port);
+            b.append(",messages="   + messageCount);
+            b.append(",window="     + window);
+            b.append(",transports=" + String.join(",", transports));
+            b.append(",modes="      + String.join(",", modes));
+            b.append(",sizes="      + Arrays.toString(sizes));
+            return b.toString();
+        }
+    }
+
+    protected static class Result {
+        final double rate;
+        final long[] latencies;
+
+        Result(double rate, long[] latencies) {
+            this.rate = rate;
+            this.latencies = latencies;
+            Arrays.sort(latencies);
+        }
+
+        long percentile(double p) {
+            return latencies[(int) Math.min(latencies.length - 1, Math.round(p * latencies.length))];
+        }
+
+        public String toString() {
+            return String.format("%10.0f msg/s  p50 %8d us  p99 %8d us  max %8d us",
+                rate, percentile(0.5) / 1000, percentile(0.99) / 1000, latencies[latencies.length - 1] / 1000);
+        }
+    }
+
+    protected final Parameters params;
+    protected final String host;
+    protected final int port;
+
+    public PublisherPipelining(Parameters p, String host, int port) {
+        params = p;
+        this.host = host;
+        this.port = port;
+    }
+
+    public Result run(String transport, String mode, int size) throws IOException, TimeoutException, InterruptedException {
+        ConnectionFactory connectionFactory = new ConnectionFactory();
+        connectionFactory.setHost(host);
+        connectionFactory.setPort(port);
+        if ("nio".equals(transport)) {
+            connectionFactory.useNio();
+        } else {
+            connectionFactory.useBlockingIo();
+        }
+        Connection connection = connectionFactory.newConnection();
+        try {
+            Channel channel = connection.createChannel();
+            String queue = channel.queueDeclare().getQueue();
+            byte[] body = new byte[size];
+            final long[] published = new long[params.messageCount];
+            final long[] latencies = new long[params.messageCount];
+            if (!"none".equals(mode)) {
+                channel.confirmSelect();
+                channel.addConfirmListener(new ConfirmListener() {
+                    long lastConfirmed = 0;
+
+                    @Override
+                    public void handleAck(long deliveryTag, boolean multiple) {
+                        long now = System.nanoTime();
+                        long first = multiple ? lastConfirmed + 1 : deliveryTag;
+                        for (long seqNo = first; seqNo <= deliveryTag; seqNo++) {
+                            latencies[(int) seqNo - 1] = now - published[(int) seqNo - 1];
+                        }
+                        lastConfirmed = Math.max(lastConfirmed, deliveryTag);
+                    }
+
+                    @Override
+                    public void handleNack(long deliveryTag, boolean multiple) {
+                        throw new IllegalStateException("Message nack-ed: " + deliveryTag);
+                    }
+                });
+            }
+            if ("window".equals(mode)) {
+                channel.setConfirmWindow(params.window, -1);
+            }
+            long start = System.nanoTime();
+            for (int i = 0; i < params.messageCount; i++) {
+                published[i] = System.nanoTime();
+                channel.basicPublish("", queue, null, body);
+                if ("none".equals(mode)) {
+                    latencies[i] = System.nanoTime() - published[i];
+                } else if ("single".equals(mode)
+                    || ("batch".equals(mode) && (i + 1) % params.window == 0)) {
+                    channel.waitForConfirmsOrDie();
+                }
+            }
+            if ("none".equals(mode)) {
+                // make sure the messages have reached the broker
+                channel.queueDeclarePassive(queue);
+            } else {
+                channel.waitForConfirmsOrDie();
+            }
+            long duration = System.nanoTime() - start;
+            return new Result(params.messageCount * 1000000000.0 / duration, latencies);
+        } finally {
+            connection.abort();
+        }
+    }
+
+    public static void main(String[] args) throws Exception {
+        CommandLine cmd = Parameters.parseCommandLine(args);
+        if (cmd == null) return;
+        Parameters params = new Parameters(cmd);
+        System.out.println(params.toString());
+        FakeBroker broker = params.host == null ? new FakeBroker() : null;
+        try {
+            PublisherPipelining test = broker == null ?
+                new PublisherPipelining(params, params.host, params.port) :
+                new PublisherPipelining(params, broker.getHost(), broker.getPort());
+            for (String transport : params.transports) {
+                for (String mode : params.modes) {
+                    for (int size : params.sizes) {
+                        // warm-up
+                        test.run(transport, mode, size);
+                        Result result = test.run(transport, mode, size);
+                        System.out.println(String.format("%-8s %-6s %7d B  %s", transport, mode, size, result));
+                    }
+                }
+            }
+        } finally {
+            if (broker != null) {
+                broker.close();
+            }
+        }
+    }
+}
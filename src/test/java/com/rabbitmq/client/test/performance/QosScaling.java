@@ -39,12 +39,14 @@ public class QosScaling {
         final int messageCount;
         final int queueCount;
         final int emptyCount;
+        final int autoPrefetchMax;
 
         public static CommandLine parseCommandLine(String[] args) {
             CLIHelper helper = CLIHelper.defaultHelper();
             helper.addOption(new Option("n", "messages", true, "number of messages to send"));
             helper.addOption(new Option("q", "queues",   true, "number of queues to route messages to"));
             helper.addOption(new Option("e", "empty",    true, "number of queues to leave empty"));
+            helper.addOption(new Option("a", "autoprefetch", true, "maximum prefetch count for automatic prefetch (0 for fixed prefetch of 1)"));
             return helper.parseCommandLine(args);
         }
 
@@ -54,6 +56,7 @@ public class QosScaling {
             messageCount = CLIHelper.getOptionValue(cmd, "n", 2000);
             queueCount   = CLIHelper.getOptionValue(cmd, "q", 100);
             emptyCount   = CLIHelper.getOptionValue(cmd, "e", 0);
+            autoPrefetchMax = CLIHelper.getOptionValue(cmd, "a", 0);
         }
 
         public String toString() {
@@ -63,6 +66,7 @@ public class QosScaling {
             b.append(",messages=" + messageCount);
             b.append(",queues="   + queueCount);
             b.append(",empty="    + emptyCount);
+            b.append(",autoprefetch=" + autoPrefetchMax);
             return b.toString();
         }
 
@@ -126,7 +130,11 @@ public class QosScaling {
         connectionFactory.setPort(params.port);
         connection = connectionFactory.newConnection();
         channel = connection.createChannel();
-        channel.basicQos(1);
+        if (params.autoPrefetchMax > 0) {
+            channel.setAutomaticPrefetch(1, params.autoPrefetchMax);
+        } else {
+            channel.basicQos(1);
+        }
         QueueingConsumer consumer = new QueueingConsumer(channel);
         try {
             publish(consume(consumer));